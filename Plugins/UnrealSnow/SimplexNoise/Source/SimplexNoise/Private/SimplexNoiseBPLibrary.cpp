@@ -158,6 +158,11 @@ float USimplexNoiseBPLibrary::SimplexNoise1D(float x)
 // 2D Simplex Noise
 
 float USimplexNoiseBPLibrary::SimplexNoise2D(float x, float y)
+{
+	return SimplexNoise2D(x, y, perm);
+}
+
+float USimplexNoiseBPLibrary::SimplexNoise2D(float x, float y, const unsigned char* permutation)
 {
 
 	#define F2 0.366025403f // F2 = 0.5*(sqrt(3.0)-1.0)
@@ -202,21 +207,21 @@ float USimplexNoiseBPLibrary::SimplexNoise2D(float x, float y)
 	if (t0 < 0.0f) n0 = 0.0f;
 	else {
 		t0 *= t0;
-		n0 = t0 * t0 * grad(perm[ii + perm[jj]], x0, y0);
+		n0 = t0 * t0 * grad(permutation[ii + permutation[jj]], x0, y0);
 	}
 
 	float t1 = 0.5f - x1*x1 - y1*y1;
 	if (t1 < 0.0f) n1 = 0.0f;
 	else {
 		t1 *= t1;
-		n1 = t1 * t1 * grad(perm[ii + i1 + perm[jj + j1]], x1, y1);
+		n1 = t1 * t1 * grad(permutation[ii + i1 + permutation[jj + j1]], x1, y1);
 	}
 
 	float t2 = 0.5f - x2*x2 - y2*y2;
 	if (t2 < 0.0f) n2 = 0.0f;
 	else {
 		t2 *= t2;
-		n2 = t2 * t2 * grad(perm[ii + 1 + perm[jj + 1]], x2, y2);
+		n2 = t2 * t2 * grad(permutation[ii + 1 + permutation[jj + 1]], x2, y2);
 	}
 
 	// Add contributions from each corner to get the final noise value.
@@ -224,6 +229,19 @@ float USimplexNoiseBPLibrary::SimplexNoise2D(float x, float y)
 	return 40.0f * (n0 + n1 + n2); // TODO: The scale factor is preliminary!
 }
 
+void USimplexNoiseBPLibrary::SimplexNoiseGrid2D(int32 sizeX, int32 sizeY, float step, const unsigned char* permutation, float* out)
+{
+	for (int32 y = 0; y < sizeY; ++y)
+	{
+		const float fy = y * step;
+		float* row = out + y * sizeX;
+		for (int32 x = 0; x < sizeX; ++x)
+		{
+			row[x] = SimplexNoise2D(x * step, fy, permutation);
+		}
+	}
+}
+
 
 
 
@@ -47,6 +47,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "SimplexNoise")
 	static float SimplexNoise2D(float x, float y);
 
+	// Same as SimplexNoise2D but reads the caller's permutation (512 entries, a permutation of 0-255 repeated twice)
+	// instead of the shared one, so differently seeded fields can be evaluated on any thread at the same time
+	static float SimplexNoise2D(float x, float y, const unsigned char* permutation);
+
+	// Evaluates a sizeX x sizeY field of 2D noise over the caller's permutation into out (row-major), sample (x, y)
+	// is SimplexNoise2D(x * step, y * step, permutation)
+	static void SimplexNoiseGrid2D(int32 sizeX, int32 sizeY, float step, const unsigned char* permutation, float* out);
+
 	UFUNCTION(BlueprintCallable, Category = "SimplexNoise")
 	static float SimplexNoise3D(float x, float y, float z);
 
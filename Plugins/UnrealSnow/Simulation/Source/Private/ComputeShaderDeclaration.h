@@ -28,6 +28,13 @@ public:
 		SHADER_PARAMETER(int32, Timesteps)
 		SHADER_PARAMETER(int32, DayOfYear)
 		SHADER_PARAMETER(int32, HourOfDay)
+		// Day-of-year radiation terms, see FSolarDayTerms
+		SHADER_PARAMETER(float, SolarSinD)
+		SHADER_PARAMETER(float, SolarCosD)
+		SHADER_PARAMETER(float, SolarTanD)
+		SHADER_PARAMETER(float, SolarR1)
+		SHADER_PARAMETER(float, SolarFlatSunset)
+		SHADER_PARAMETER(float, SolarFlatRadiation)
 		// UAVs
 		SHADER_PARAMETER_UAV(RWTexture2D<uint>, OutputSurface)
 		SHADER_PARAMETER_UAV(RWStructuredBuffer<float>, SimulationCellsBuffer)
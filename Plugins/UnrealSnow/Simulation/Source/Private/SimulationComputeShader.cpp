@@ -79,7 +79,7 @@ void FSimulationComputeShader::Initialize(
 	this->HourOfDay = 0;
 }
 
-void FSimulationComputeShader::ExecuteComputeShader(int CurrentTimeStep, int32 InTimesteps, int InHourOfDay, bool CaptureDebugInformation, TArray<FDebugCell>& CellDebugInformation)
+void FSimulationComputeShader::ExecuteComputeShader(int CurrentTimeStep, int32 InTimesteps, int InHourOfDay, int32 InDayOfYear, const FSolarDayTerms& InSolarDay, bool CaptureDebugInformation, TArray<FDebugCell>& CellDebugInformation)
 {
 	// Skip this execution round if we are already executing
 	if (IsUnloading || IsComputeShaderExecuting) return;
@@ -88,6 +88,8 @@ void FSimulationComputeShader::ExecuteComputeShader(int CurrentTimeStep, int32 I
 
 	// Set the variable parameters
 	this->HourOfDay = InHourOfDay;
+	this->DayOfYear = InDayOfYear;
+	this->SolarDay = InSolarDay;
 	this->CurrentSimulationStep = CurrentTimeStep;
 	this->Timesteps = InTimesteps;
 
@@ -148,6 +150,12 @@ void FSimulationComputeShader::ExecuteComputeShaderInternal(bool CaptureDebugInf
 	Parameters.Timesteps = Timesteps;
 	Parameters.DayOfYear = DayOfYear;
 	Parameters.HourOfDay = HourOfDay;
+	Parameters.SolarSinD = SolarDay.SinD;
+	Parameters.SolarCosD = SolarDay.CosD;
+	Parameters.SolarTanD = SolarDay.TanD;
+	Parameters.SolarR1 = SolarDay.R1;
+	Parameters.SolarFlatSunset = SolarDay.T1;
+	Parameters.SolarFlatRadiation = SolarDay.R3;
 	// UAVs
 	Parameters.OutputSurface = TextureUAV;
 	Parameters.SimulationCellsBuffer = SimulationCellsBuffer->UAV;
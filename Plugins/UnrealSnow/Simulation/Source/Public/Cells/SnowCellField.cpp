@@ -0,0 +1,161 @@
+#include "SnowCellField.h"
+#include "Simulation.h"
+#include "Util/MathUtil.h"
+
+void FSnowCellField::Allocate(int32 InDimX, int32 InDimY)
+{
+	DimX = FMath::Max(0, InDimX);
+	DimY = FMath::Max(0, InDimY);
+	const int32 Count = DimX * DimY;
+
+	for (FSnowCellColumn* Column : { &Altitude, &Slope, &Aspect, &Area, &AreaXY, &Curvature, &SWE, &Albedo, &Age })
+	{
+		Column->SetNumZeroed(Count, EAllowShrinking::Yes);
+	}
+}
+
+void FSnowCellField::Reset()
+{
+	for (FSnowCellColumn* Column : { &Altitude, &Slope, &Aspect, &Area, &AreaXY, &Curvature, &SWE, &Albedo, &Age })
+	{
+		Column->Empty();
+	}
+	Corners.Empty();
+	Holes.Empty();
+	DimX = DimY = 0;
+}
+
+float FSnowCellField::Build(int32 InDimX, int32 InDimY, TArray<FVector3f>&& InCorners, float InLatitude, float CellSpacingMeters, TBitArray<>&& InHoles)
+{
+	check(InCorners.Num() == (InDimX + 1) * (InDimY + 1));
+
+	Allocate(InDimX, InDimY);
+	Corners = MoveTemp(InCorners);
+	Latitude = InLatitude;
+
+	// A mask without any hole is dropped so IsHole stays a size check on hole free landscapes
+	Holes.Empty();
+	if (InHoles.Num() == Num() && InHoles.Contains(true))
+	{
+		Holes = MoveTemp(InHoles);
+	}
+
+	float MaxSnow = 0.0f;
+
+	for (int32 Index = 0; Index < Num(); ++Index)
+	{
+		FVector P0, P1, P2, P3;
+		GetCorners(Index, P0, P1, P2, P3);
+
+		const FVector Normal = FVector::CrossProduct(P1 - P0, P2 - P0);
+		const float CellAltitude = (P0.Z + P1.Z + P2.Z + P3.Z) / 4;
+
+		const float CellArea = FMath::Abs(FVector::CrossProduct(P0 - P3, P1 - P3).Size() / 2 + FVector::CrossProduct(P2 - P3, P0 - P3).Size() / 2);
+
+		const float CellAreaXY = FMath::Abs(FVector2D::CrossProduct(FVector2D(P0 - P3), FVector2D(P1 - P3)) / 2
+			+ FVector2D::CrossProduct(FVector2D(P2 - P3), FVector2D(P0 - P3)) / 2);
+
+		FVector P0toP3 = P3 - P0;
+		FVector P0toP3ProjXY = FVector(P0toP3.X, P0toP3.Y, 0);
+		const float Inclination = IsAlmostZero(P0toP3.Size()) ? 0 : FMath::Abs(FMath::Acos(FVector::DotProduct(P0toP3, P0toP3ProjXY) / (P0toP3.Size() * P0toP3ProjXY.Size())));
+
+		// @TODO what is the aspect of the XY plane?
+		FVector2D NormalProjXY = FVector2D(Normal.X, Normal.Y);
+		FVector2D North2D = FVector2D(1, 0);
+		float Dot = FVector2D::DotProduct(NormalProjXY, North2D);
+		float Det = NormalProjXY.X * North2D.Y - NormalProjXY.Y * North2D.X;
+		float CellAspect = FMath::Atan2(Det, Dot);
+		CellAspect = NormalizeAngle360(CellAspect);
+
+		// Initial conditions
+		float SnowWaterEquivalent = 0.0f;
+		if (CellAltitude / 100.0f > 3300.0f && !IsHole(Index))
+		{
+			auto AreaSquareMeters = CellArea / (100 * 100);
+			float we = (2.5 + CellAltitude / 100 * 0.001) * AreaSquareMeters;
+
+			SnowWaterEquivalent = we;
+
+			MaxSnow = FMath::Max(SnowWaterEquivalent / AreaSquareMeters, MaxSnow);
+		}
+
+		Altitude[Index] = CellAltitude;
+		Slope[Index] = Inclination;
+		Aspect[Index] = CellAspect;
+		Area[Index] = CellArea;
+		AreaXY[Index] = CellAreaXY;
+		SWE[Index] = SnowWaterEquivalent;
+	}
+
+	// Calculate curvature, border cells without a full eight neighbourhood keep a curvature of zero
+	const float L = CellSpacingMeters;
+	for (int32 Y = 1; Y < DimY - 1; ++Y)
+	{
+		for (int32 X = 1; X < DimX - 1; ++X)
+		{
+			const float ZN = Altitude[GetIndex(X, Y - 1)] / 100;
+			const float ZE = Altitude[GetIndex(X + 1, Y)] / 100;
+			const float ZS = Altitude[GetIndex(X, Y + 1)] / 100;
+			const float ZW = Altitude[GetIndex(X - 1, Y)] / 100;
+			const float Z = Altitude[GetIndex(X, Y)] / 100;
+
+			const float D = ((ZE + ZW) / 2 - Z) / (L * L);
+			const float E = ((ZN + ZS) / 2 - Z) / (L * L);
+			Curvature[GetIndex(X, Y)] = 2 * (D + E);
+		}
+	}
+
+	return MaxSnow;
+}
+
+void FSnowCellField::CopyRegion(const FSnowCellField& Source, int32 X0, int32 Y0, int32 InDimX, int32 InDimY)
+{
+	check(X0 >= 0 && Y0 >= 0 && X0 + InDimX <= Source.DimX && Y0 + InDimY <= Source.DimY);
+
+	Allocate(InDimX, InDimY);
+	Latitude = Source.Latitude;
+
+	const FSnowCellColumn* SourceColumns[] = { &Source.Altitude, &Source.Slope, &Source.Aspect, &Source.Area, &Source.AreaXY, &Source.Curvature, &Source.SWE, &Source.Albedo, &Source.Age };
+	FSnowCellColumn* Columns[] = { &Altitude, &Slope, &Aspect, &Area, &AreaXY, &Curvature, &SWE, &Albedo, &Age };
+	for (int32 Column = 0; Column < UE_ARRAY_COUNT(Columns); ++Column)
+	{
+		for (int32 Y = 0; Y < DimY; ++Y)
+		{
+			FMemory::Memcpy(Columns[Column]->GetData() + Y * DimX, SourceColumns[Column]->GetData() + Source.GetIndex(X0, Y0 + Y), DimX * sizeof(float));
+		}
+	}
+
+	const int32 SourceStride = Source.DimX + 1;
+	Corners.SetNumUninitialized((DimX + 1) * (DimY + 1));
+	for (int32 Y = 0; Y <= DimY; ++Y)
+	{
+		FMemory::Memcpy(Corners.GetData() + Y * (DimX + 1), Source.Corners.GetData() + X0 + (Y0 + Y) * SourceStride, (DimX + 1) * sizeof(FVector3f));
+	}
+
+	Holes.Empty();
+	if (Source.Holes.Num() > 0)
+	{
+		TBitArray<> RegionHoles(false, Num());
+		for (int32 Y = 0; Y < DimY; ++Y)
+		{
+			for (int32 X = 0; X < DimX; ++X)
+			{
+				RegionHoles[GetIndex(X, Y)] = Source.Holes[Source.GetIndex(X0 + X, Y0 + Y)];
+			}
+		}
+		if (RegionHoles.Contains(true))
+		{
+			Holes = MoveTemp(RegionHoles);
+		}
+	}
+}
+
+SIZE_T FSnowCellField::GetAllocatedSize() const
+{
+	SIZE_T Size = Corners.GetAllocatedSize() + Holes.GetAllocatedSize();
+	for (const FSnowCellColumn* Column : { &Altitude, &Slope, &Aspect, &Area, &AreaXY, &Curvature, &SWE, &Albedo, &Age })
+	{
+		Size += Column->GetAllocatedSize();
+	}
+	return Size;
+}
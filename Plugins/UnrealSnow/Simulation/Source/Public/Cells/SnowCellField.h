@@ -0,0 +1,129 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A single per-cell attribute column. Cache-line aligned so kernels can stream it with aligned vector loads. */
+using FSnowCellColumn = TArray<float, TAlignedHeapAllocator<64>>;
+
+/**
+* Columnar (structure-of-arrays) store for the simulation cells.
+*
+* Every per-cell attribute lives in its own aligned float column indexed by X + Y * DimX, so the step loops only pull
+* the columns they actually touch into cache. Cell geometry (corners, centroid, normal) is not stored per cell but
+* reconstructed on demand from the shared (DimX + 1) x (DimY + 1) corner lattice.
+*/
+struct SIMULATION_API FSnowCellField
+{
+	/** Number of cells in x direction. */
+	int32 DimX = 0;
+
+	/** Number of cells in y direction. */
+	int32 DimY = 0;
+
+	/** The latitude of the cells (constant for the whole landscape). */
+	float Latitude = 0.0f;
+
+	/** The altitude (in cm) of the cell's mid point. */
+	FSnowCellColumn Altitude;
+
+	/** The slope (inclination in radians) of the cell. */
+	FSnowCellColumn Slope;
+
+	/** The compass direction the cell faces in radians. */
+	FSnowCellColumn Aspect;
+
+	/** Area in cm^2. */
+	FSnowCellColumn Area;
+
+	/** Area of the cell projected onto the XY plane in cm^2. */
+	FSnowCellColumn AreaXY;
+
+	/** The curvature (second derivative) of the terrain for the cell. */
+	FSnowCellColumn Curvature;
+
+	/** Snow water equivalent (SWE) as the mass of water stored in liters. */
+	FSnowCellColumn SWE;
+
+	/** The albedo of the snow [0-1.0]. */
+	FSnowCellColumn Albedo;
+
+	/** The days since the last snow has fallen on the cell. */
+	FSnowCellColumn Age;
+
+	/** World space cell corners, (DimX + 1) * (DimY + 1) entries. */
+	TArray<FVector3f> Corners;
+
+	/** Cells cut out of the landscape (visibility layer holes), empty if the landscape has none. Holes never hold snow. */
+	TBitArray<> Holes;
+
+	/** Returns the number of cells. */
+	FORCEINLINE int32 Num() const { return DimX * DimY; }
+
+	FORCEINLINE bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < Num(); }
+
+	FORCEINLINE bool IsHole(int32 Index) const { return Holes.Num() > 0 && Holes[Index]; }
+
+	FORCEINLINE int32 GetIndex(int32 X, int32 Y) const { return X + Y * DimX; }
+
+	/** Resizes all columns to InDimX * InDimY cells and zeroes them. */
+	void Allocate(int32 InDimX, int32 InDimY);
+
+	/** Releases all memory. */
+	void Reset();
+
+	/**
+	* Builds the terrain attributes of all cells from the corner lattice and sets the initial snow conditions.
+	*
+	* @param InDimX				number of cells in x direction
+	* @param InDimY				number of cells in y direction
+	* @param InCorners			world space corners, (InDimX + 1) * (InDimY + 1) entries
+	* @param InLatitude			latitude of the cells
+	* @param CellSpacingMeters	distance between neighbouring cell centers in meters (used for the curvature)
+	* @param InHoles			optional hole mask with one bit per cell
+	* @return the maximum initial snow (mm) of any cell
+	*/
+	float Build(int32 InDimX, int32 InDimY, TArray<FVector3f>&& InCorners, float InLatitude, float CellSpacingMeters, TBitArray<>&& InHoles = TBitArray<>());
+
+	/**
+	* Makes the field a copy of the InDimX x InDimY cells of Source starting at (X0, Y0), with their corners and holes.
+	* Lets a region be built with a border of neighbouring cells (for the curvature) and the border dropped afterwards.
+	*/
+	void CopyRegion(const FSnowCellField& Source, int32 X0, int32 Y0, int32 InDimX, int32 InDimY);
+
+	/** Returns the four corners of the cell (P0 top left, P1 top right, P2 bottom left, P3 bottom right). */
+	FORCEINLINE void GetCorners(int32 Index, FVector& P0, FVector& P1, FVector& P2, FVector& P3) const
+	{
+		const int32 X = Index % DimX;
+		const int32 Y = Index / DimX;
+		const int32 Stride = DimX + 1;
+		P0 = FVector(Corners[X + Y * Stride]);
+		P1 = FVector(Corners[X + 1 + Y * Stride]);
+		P2 = FVector(Corners[X + (Y + 1) * Stride]);
+		P3 = FVector(Corners[X + 1 + (Y + 1) * Stride]);
+	}
+
+	/** Returns the midpoint of the cell. */
+	FVector GetCentroid(int32 Index) const
+	{
+		FVector P0, P1, P2, P3;
+		GetCorners(Index, P0, P1, P2, P3);
+		return (P0 + P1 + P2 + P3) / 4;
+	}
+
+	/** Returns the (unnormalized) normal of the cell. */
+	FVector GetNormal(int32 Index) const
+	{
+		FVector P0, P1, P2, P3;
+		GetCorners(Index, P0, P1, P2, P3);
+		return FVector::CrossProduct(P1 - P0, P2 - P0);
+	}
+
+	/** Returns the snow amount of the cell in mm (or liters/m^2). */
+	FORCEINLINE float GetSnowMM(int32 Index) const
+	{
+		return SWE[Index] / (Area[Index] / (100 * 100));
+	}
+
+	/** Returns the number of bytes held by the field. */
+	SIZE_T GetAllocatedSize() const;
+};
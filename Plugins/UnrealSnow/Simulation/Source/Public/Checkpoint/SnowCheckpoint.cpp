@@ -0,0 +1,169 @@
+#include "SnowCheckpoint.h"
+#include "SnowSimulationActor.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+
+static_assert(PLATFORM_LITTLE_ENDIAN, "Snow checkpoints are stored little-endian and mapped in place");
+
+FSnowCheckpointView::FSnowCheckpointView() = default;
+
+FSnowCheckpointView::~FSnowCheckpointView()
+{
+	// The region must be released before the file handle it was mapped from
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+bool FSnowCheckpointView::OpenFile(const FString& Path)
+{
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	Header = nullptr;
+
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (!MappedFile.IsValid())
+	{
+		UE_LOG(SimulationLog, Warning, TEXT("Could not map snow checkpoint %s"), *Path);
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize(), /*bPreloadHint=*/true));
+	if (!MappedRegion.IsValid())
+	{
+		UE_LOG(SimulationLog, Warning, TEXT("Could not map snow checkpoint %s"), *Path);
+		MappedFile.Reset();
+		return false;
+	}
+
+	Data = MappedRegion->GetMappedPtr();
+	Size = MappedRegion->GetMappedSize();
+	return Validate(Path);
+}
+
+bool FSnowCheckpointView::OpenMemory(TConstArrayView64<uint8> InData)
+{
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	Header = nullptr;
+
+	Data = InData.GetData();
+	Size = InData.Num();
+	return Validate(TEXT("memory"));
+}
+
+bool FSnowCheckpointView::Validate(const FString& Source)
+{
+	Header = nullptr;
+	if (!Data || Size < static_cast<int64>(sizeof(FSnowCheckpointHeader)))
+	{
+		UE_LOG(SimulationLog, Warning, TEXT("Snow checkpoint %s is truncated"), *Source);
+		return false;
+	}
+
+	const FSnowCheckpointHeader* Candidate = reinterpret_cast<const FSnowCheckpointHeader*>(Data);
+	if (Candidate->Magic != FSnowCheckpointHeader::MagicValue || Candidate->Version != FSnowCheckpointHeader::CurrentVersion)
+	{
+		UE_LOG(SimulationLog, Warning, TEXT("Snow checkpoint %s has an unsupported format (magic %08x, version %u)"), *Source, Candidate->Magic, Candidate->Version);
+		return false;
+	}
+
+	const uint64 ColumnBytes = static_cast<uint64>(FMath::Max(0, Candidate->GridX)) * FMath::Max(0, Candidate->GridY) * sizeof(float);
+	const uint32 NumColumns = FMath::Min(Candidate->NumColumns, static_cast<uint32>(ESnowCheckpointColumn::Num));
+	for (uint32 Column = 0; Column < NumColumns; ++Column)
+	{
+		const uint64 Offset = Candidate->ColumnOffsets[Column];
+		const uint64 ColumnSize = Candidate->ColumnSizes[Column];
+		// Offset + ColumnSize could wrap around for a corrupt header
+		const bool bInBounds = Offset <= static_cast<uint64>(Size) && ColumnSize <= static_cast<uint64>(Size) - Offset;
+		const bool bValidSize = ColumnSize == 0 || ColumnSize == ColumnBytes;
+		if (!bInBounds || !bValidSize || Offset % alignof(float) != 0)
+		{
+			UE_LOG(SimulationLog, Warning, TEXT("Snow checkpoint %s has a corrupt column %u"), *Source, Column);
+			return false;
+		}
+	}
+
+	Header = Candidate;
+	return true;
+}
+
+TConstArrayView<float> FSnowCheckpointView::GetColumn(ESnowCheckpointColumn Column) const
+{
+	const uint32 ColumnIndex = static_cast<uint32>(Column);
+	if (!Header || ColumnIndex >= Header->NumColumns || Header->ColumnSizes[ColumnIndex] == 0)
+	{
+		return TConstArrayView<float>();
+	}
+	const float* ColumnData = reinterpret_cast<const float*>(Data + Header->ColumnOffsets[ColumnIndex]);
+	return TConstArrayView<float>(ColumnData, static_cast<int32>(Header->ColumnSizes[ColumnIndex] / sizeof(float)));
+}
+
+bool FSnowCheckpointView::CopyColumn(ESnowCheckpointColumn Column, float* Out, int32 Num) const
+{
+	const TConstArrayView<float> Values = GetColumn(Column);
+	if (Values.Num() == 0 || Values.Num() != Num)
+	{
+		return false;
+	}
+	FMemory::Memcpy(Out, Values.GetData(), Num * sizeof(float));
+	return true;
+}
+
+namespace
+{
+	/** Lays out the columns of State, returns the total size of the checkpoint in bytes. */
+	uint64 BuildHeader(const FSnowCheckpointState& State, FSnowCheckpointHeader& Header)
+	{
+		Header.GridX = State.GridX;
+		Header.GridY = State.GridY;
+		Header.SimulationTimeTicks = State.SimulationTime.GetTicks();
+		Header.SimulationStep = State.SimulationStep;
+
+		const int32 NumCells = State.GridX * State.GridY;
+		uint64 Offset = Align(sizeof(FSnowCheckpointHeader), FSnowCheckpointHeader::ColumnAlignment);
+		for (uint32 Column = 0; Column < Header.NumColumns; ++Column)
+		{
+			const bool bPresent = NumCells > 0 && State.Columns[Column].Num() == NumCells;
+			Header.ColumnOffsets[Column] = Offset;
+			Header.ColumnSizes[Column] = bPresent ? static_cast<uint64>(NumCells) * sizeof(float) : 0;
+			Offset = Align(Offset + Header.ColumnSizes[Column], FSnowCheckpointHeader::ColumnAlignment);
+		}
+		return Offset;
+	}
+
+	/** Copies the header and the columns into Out, which holds the zeroed size returned by BuildHeader. */
+	void WriteColumns(const FSnowCheckpointState& State, const FSnowCheckpointHeader& Header, uint8* Out)
+	{
+		FMemory::Memcpy(Out, &Header, sizeof(Header));
+		for (uint32 Column = 0; Column < Header.NumColumns; ++Column)
+		{
+			if (Header.ColumnSizes[Column] > 0)
+			{
+				FMemory::Memcpy(Out + Header.ColumnOffsets[Column], State.Columns[Column].GetData(), Header.ColumnSizes[Column]);
+			}
+		}
+	}
+}
+
+void FSnowCheckpoint::Write(const FSnowCheckpointState& State, TArray64<uint8>& OutData)
+{
+	FSnowCheckpointHeader Header;
+	const uint64 Size = BuildHeader(State, Header);
+	OutData.SetNumZeroed(static_cast<int64>(Size));
+	WriteColumns(State, Header, OutData.GetData());
+}
+
+bool FSnowCheckpoint::Write(const FSnowCheckpointState& State, TArray<uint8>& OutData)
+{
+	FSnowCheckpointHeader Header;
+	const uint64 Size = BuildHeader(State, Header);
+	if (Size > static_cast<uint64>(MAX_int32))
+	{
+		UE_LOG(SimulationLog, Warning, TEXT("Snow checkpoint of %dx%d cells needs %llu bytes, more than a 32 bit array holds"), State.GridX, State.GridY, Size);
+		OutData.Reset();
+		return false;
+	}
+	OutData.SetNumZeroed(static_cast<int32>(Size));
+	WriteColumns(State, Header, OutData.GetData());
+	return true;
+}
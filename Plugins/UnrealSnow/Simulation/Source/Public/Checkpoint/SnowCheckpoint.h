@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/** Columns stored in a snow checkpoint, in file order. */
+enum class ESnowCheckpointColumn : uint32
+{
+	/** Snow depth in meters (USnowSimulation::DepthMeters). */
+	DepthMeters,
+	/** Snow water equivalent in liters (FSnowCellField::SWE). */
+	SWE,
+	/** Snow albedo (FSnowCellField::Albedo). */
+	Albedo,
+	/** Days since the last snowfall (FSnowCellField::Age). */
+	Age,
+
+	Num
+};
+
+/**
+* Fixed size header of a snow checkpoint. The header is followed by the columns, each GridX * GridY little-endian
+* floats starting at a 64 byte aligned offset, so a mapped checkpoint can be used in place without any parsing.
+*/
+struct FSnowCheckpointHeader
+{
+	static constexpr uint32 MagicValue = 0x4B434E53; // "SNCK"
+	static constexpr uint32 CurrentVersion = 1;
+	static constexpr uint32 ColumnAlignment = 64;
+
+	uint32 Magic = MagicValue;
+	uint32 Version = CurrentVersion;
+	int32 GridX = 0;
+	int32 GridY = 0;
+
+	/** FDateTime ticks of CurrentSimulationTime and the CurrentSimulationStep of the actor. */
+	int64 SimulationTimeTicks = 0;
+	int32 SimulationStep = 0;
+
+	/** Number of columns present, columns the writer did not have are stored with a size of 0. */
+	uint32 NumColumns = static_cast<uint32>(ESnowCheckpointColumn::Num);
+
+	/** Byte offset and size of every column from the start of the checkpoint. */
+	uint64 ColumnOffsets[static_cast<uint32>(ESnowCheckpointColumn::Num)] = {};
+	uint64 ColumnSizes[static_cast<uint32>(ESnowCheckpointColumn::Num)] = {};
+};
+
+/** Simulation state to write into a checkpoint. Columns may be empty, otherwise they must hold GridX * GridY values. */
+struct FSnowCheckpointState
+{
+	int32 GridX = 0;
+	int32 GridY = 0;
+	FDateTime SimulationTime;
+	int32 SimulationStep = 0;
+
+	TConstArrayView<float> Columns[static_cast<uint32>(ESnowCheckpointColumn::Num)];
+};
+
+/**
+* Read-only view of a checkpoint, either memory mapped from a file or pointing into a byte buffer (e.g. a save game).
+* The column views stay valid as long as the view (and the buffer it was opened on) is alive.
+*/
+class SIMULATION_API FSnowCheckpointView
+{
+public:
+	FSnowCheckpointView();
+	~FSnowCheckpointView();
+
+	FSnowCheckpointView(const FSnowCheckpointView&) = delete;
+	FSnowCheckpointView& operator=(const FSnowCheckpointView&) = delete;
+
+	/** Maps the checkpoint file with a single mapping, returns false and logs if the file is not a valid checkpoint. */
+	bool OpenFile(const FString& Path);
+
+	/** Views a checkpoint held in memory, Data must outlive the view. */
+	bool OpenMemory(TConstArrayView64<uint8> Data);
+
+	bool IsValid() const { return Header != nullptr; }
+
+	const FSnowCheckpointHeader& GetHeader() const { return *Header; }
+
+	FDateTime GetSimulationTime() const { return FDateTime(Header->SimulationTimeTicks); }
+
+	/** Returns the column, empty if the checkpoint does not contain it. */
+	TConstArrayView<float> GetColumn(ESnowCheckpointColumn Column) const;
+
+	/** Copies a column into Out if present with the expected number of values, returns true if it did. */
+	bool CopyColumn(ESnowCheckpointColumn Column, float* Out, int32 Num) const;
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	const FSnowCheckpointHeader* Header = nullptr;
+
+	bool Validate(const FString& Source);
+};
+
+/** Writes snow checkpoints. */
+struct SIMULATION_API FSnowCheckpoint
+{
+	/** Serializes State into OutData, replacing its contents. */
+	static void Write(const FSnowCheckpointState& State, TArray64<uint8>& OutData);
+
+	/** Same for 32 bit containers such as save games, returns false and leaves OutData empty if the checkpoint does not fit. */
+	static bool Write(const FSnowCheckpointState& State, TArray<uint8>& OutData);
+};
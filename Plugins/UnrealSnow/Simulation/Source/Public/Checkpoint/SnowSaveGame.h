@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/SaveGame.h"
+#include "SnowSaveGame.generated.h"
+
+/**
+* Save game holding a snow checkpoint (see FSnowCheckpoint). The checkpoint is stored as an opaque byte array, so
+* saving and loading a snowpack is a single bulk copy regardless of the grid size.
+*/
+UCLASS(BlueprintType)
+class SIMULATION_API USnowSaveGame : public USaveGame
+{
+	GENERATED_BODY()
+
+public:
+	/** Name of the simulation that wrote the checkpoint, for diagnostics. */
+	UPROPERTY(VisibleAnywhere, Category = "Snow")
+	FString SimulationName;
+
+	/** Checkpoint bytes in the FSnowCheckpoint format. */
+	UPROPERTY()
+	TArray<uint8> Checkpoint;
+};
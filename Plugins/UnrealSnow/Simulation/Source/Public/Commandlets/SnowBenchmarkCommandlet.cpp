@@ -0,0 +1,432 @@
+#include "SnowBenchmarkCommandlet.h"
+#include "SnowSimulation.h"
+#include "SnowSimulationActor.h"
+#include "SimpleAccumulationSim.h"
+#include "DegreeDay/DegreeDaySimulation.h"
+#include "DegreeDay/CPU/DegreeDayCPUSimulation.h"
+#include "Cells/SnowCellField.h"
+#include "Constant/ConstantWeatherProvider.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(LogSnowBenchmarkCommandlet, Log, All);
+
+namespace
+{
+	/** Set on the thread whose allocations are counted, allocations of every other thread are only forwarded. */
+	thread_local bool bCountAllocations = false;
+
+	/** Forwards to the wrapped allocator and counts the allocations of the threads that set bCountAllocations. */
+	class FSnowCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FSnowCountingMalloc(FMalloc* InInner)
+			: Inner(InInner)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			if (bCountAllocations)
+			{
+				Allocations.fetch_add(1, std::memory_order_relaxed);
+				AllocatedBytes.fetch_add(Count, std::memory_order_relaxed);
+			}
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			// Growing or moving a block costs as much as a fresh allocation
+			if (bCountAllocations && Count > 0)
+			{
+				Allocations.fetch_add(1, std::memory_order_relaxed);
+				AllocatedBytes.fetch_add(Count, std::memory_order_relaxed);
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("SnowCountingMalloc"); }
+
+		FMalloc* GetInner() const { return Inner; }
+
+		void ResetCounts()
+		{
+			Allocations.store(0, std::memory_order_relaxed);
+			AllocatedBytes.store(0, std::memory_order_relaxed);
+		}
+
+		int64 GetAllocations() const { return Allocations.load(std::memory_order_relaxed); }
+		int64 GetAllocatedBytes() const { return AllocatedBytes.load(std::memory_order_relaxed); }
+
+	private:
+		FMalloc* Inner;
+		std::atomic<int64> Allocations{ 0 };
+		std::atomic<int64> AllocatedBytes{ 0 };
+	};
+
+	/**
+	* Counts the allocations of the calling thread for its lifetime. The counting allocator is created once and never
+	* destroyed, so threads that read GMalloc while it is installed may still call it after it was swapped out.
+	*/
+	struct FScopedAllocationCounter
+	{
+		FSnowCountingMalloc& Counter;
+
+		FScopedAllocationCounter()
+			: Counter(Get())
+		{
+			Counter.ResetCounts();
+			FPlatformAtomics::InterlockedExchangePtr(reinterpret_cast<void**>(&GMalloc), &Counter);
+			bCountAllocations = true;
+		}
+
+		~FScopedAllocationCounter()
+		{
+			bCountAllocations = false;
+			FPlatformAtomics::InterlockedExchangePtr(reinterpret_cast<void**>(&GMalloc), Counter.GetInner());
+		}
+
+	private:
+		static FSnowCountingMalloc& Get()
+		{
+			static FSnowCountingMalloc* Instance = new FSnowCountingMalloc(GMalloc);
+			return *Instance;
+		}
+	};
+
+	/**
+	* Bytes of cell columns each step streams through memory per cell (reads plus writes). This is a model of the kernels,
+	* not a measurement, the reported bandwidth is the effective one the step achieves.
+	*/
+	float GetBytesPerCell(const USimulationBase* Simulation)
+	{
+		if (Simulation->IsA<UDegreeDayCPUSimulation>())
+		{
+			// Altitude, AreaXY, Area, Slope, Aspect, Curvature read; SWE, Albedo, Age read + written; InterpolatedSWE written
+			return (6 + 3 * 2 + 1) * sizeof(float);
+		}
+		if (Simulation->IsA<UDegreeDaySimulation>())
+		{
+			// Depth read + written, redistribution factor read, Age and Albedo read + written
+			return (2 + 1 + 2 * 2) * sizeof(float);
+		}
+		// Depth read + written
+		return 2 * sizeof(float);
+	}
+
+	bool ParseIntList(const TCHAR* CmdLine, const TCHAR* Name, TArray<int32>& OutValues)
+	{
+		FString Text;
+		if (!FParse::Value(CmdLine, Name, Text, false))
+		{
+			return false;
+		}
+		TArray<FString> Items;
+		Text.ParseIntoArray(Items, TEXT(","));
+		OutValues.Reset();
+		for (const FString& Item : Items)
+		{
+			OutValues.Add(FCString::Atoi(*Item));
+		}
+		return true;
+	}
+}
+
+double USnowBenchmarkCommandlet::FResult::GetNanosecondsPerCellStep() const
+{
+	const double CellSteps = static_cast<double>(Size) * Size * Steps;
+	return CellSteps > 0.0 ? Seconds * 1e9 / CellSteps : 0.0;
+}
+
+double USnowBenchmarkCommandlet::FResult::GetGigabytesPerSecond() const
+{
+	const double Bytes = static_cast<double>(Size) * Size * Steps * BytesPerCell;
+	return Seconds > 0.0 ? Bytes / Seconds / 1e9 : 0.0;
+}
+
+USnowBenchmarkCommandlet::USnowBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 USnowBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TCHAR* CmdLine = *Params;
+
+	TArray<int32> Sizes = { 256, 512, 1024, 2048, 4096, 8192 };
+	ParseIntList(CmdLine, TEXT("Sizes="), Sizes);
+
+	// Powers of two up to every task graph worker plus the calling thread, 0 stands for "all"
+	TArray<int32> ThreadCounts;
+	if (!ParseIntList(CmdLine, TEXT("Threads="), ThreadCounts))
+	{
+		const int32 MaxThreads = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+		for (int32 Threads = 1; Threads < MaxThreads; Threads *= 2)
+		{
+			ThreadCounts.Add(Threads);
+		}
+		ThreadCounts.Add(MaxThreads);
+	}
+
+	int32 Steps = 24;
+	FParse::Value(CmdLine, TEXT("Steps="), Steps);
+	int32 Warmup = 2;
+	FParse::Value(CmdLine, TEXT("Warmup="), Warmup);
+	float CellMeters = 10.0f;
+	FParse::Value(CmdLine, TEXT("CellMeters="), CellMeters);
+	FString OutputDir = FPaths::ProjectSavedDir() / TEXT("SnowBenchmark");
+	FParse::Value(CmdLine, TEXT("Out="), OutputDir);
+
+	TArray<UClass*> SimulationClasses = { USimpleAccumulationSim::StaticClass(), UDegreeDaySimulation::StaticClass(), UDegreeDayCPUSimulation::StaticClass() };
+	FString SimulationList;
+	if (FParse::Value(CmdLine, TEXT("Simulations="), SimulationList, false))
+	{
+		TArray<FString> Names;
+		SimulationList.ParseIntoArray(Names, TEXT(","));
+		SimulationClasses.Reset();
+		for (const FString& Name : Names)
+		{
+			UClass* SimulationClass = LoadClass<USimulationBase>(nullptr, *Name);
+			if (!SimulationClass || SimulationClass->HasAnyClassFlags(CLASS_Abstract))
+			{
+				UE_LOG(LogSnowBenchmarkCommandlet, Error, TEXT("%s is not a concrete simulation class"), *Name);
+				return 1;
+			}
+			SimulationClasses.Add(SimulationClass);
+		}
+	}
+
+	if (Steps <= 0 || Sizes.Num() == 0 || ThreadCounts.Num() == 0)
+	{
+		UE_LOG(LogSnowBenchmarkCommandlet, Error, TEXT("Nothing to run (%d sizes, %d thread counts, %d steps)"), Sizes.Num(), ThreadCounts.Num(), Steps);
+		return 1;
+	}
+
+	// The legacy Simulate API reads the forcing and the clock from an actor, spawned into a transient world that never begins play
+	UWorld* World = UWorld::CreateWorld(EWorldType::None, /*bInformEngineOfWorld=*/false);
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.ObjectFlags = RF_Transient;
+	ASnowSimulationActor* Actor = World->SpawnActor<ASnowSimulationActor>(SpawnParameters);
+	if (!Actor)
+	{
+		UE_LOG(LogSnowBenchmarkCommandlet, Error, TEXT("Could not spawn the simulation actor"));
+		World->DestroyWorld(false);
+		return 1;
+	}
+
+	// Fixed forcing: light snowfall just above freezing, so accumulation, melt and aging all run every step
+	UConstantWeatherProvider* Provider = NewObject<UConstantWeatherProvider>(Actor);
+	Provider->Temperature_C = 1.0f;
+	Provider->Precipitation_mmph = 1.0f;
+	Provider->SnowFraction = 1.0f;
+	const FDateTime StartTime(2016, 1, 15);
+	Provider->Initialize(StartTime, StartTime + FTimespan::FromHours(Warmup + 2 * Steps + 1));
+
+	Actor->ClimateDataComponent = Provider;
+	Actor->WeatherProvider = Provider;
+	Actor->CurrentSimulationTime = StartTime;
+
+	TArray<FResult> Results;
+	for (const int32 Size : Sizes)
+	{
+		if (Size < 2)
+		{
+			continue;
+		}
+
+		TSharedPtr<FSnowCellField> CellField = MakeSyntheticTerrain(Size, CellMeters);
+		Actor->CellsDimensionX = Size;
+		Actor->CellsDimensionY = Size;
+		Actor->NumCells = Size * Size;
+		UE_LOG(LogSnowBenchmarkCommandlet, Display, TEXT("Terrain %dx%d: %.1f MB of cell columns"), Size, Size, CellField->GetAllocatedSize() / (1024.0 * 1024.0));
+
+		for (UClass* SimulationClass : SimulationClasses)
+		{
+			USimulationBase* Simulation = NewObject<USimulationBase>(GetTransientPackage(), SimulationClass);
+			Simulation->AddToRoot();
+
+			// Simulations without tile kernels run on the calling thread only
+			const bool bTiled = Simulation->IsA<USnowSimulation>() && !Simulation->IsA<UDegreeDayCPUSimulation>();
+			for (const int32 Threads : ThreadCounts)
+			{
+				FResult Result = Run(Simulation, Actor, Provider, CellField, CellMeters, Threads, Warmup, Steps);
+				UE_LOG(LogSnowBenchmarkCommandlet, Display, TEXT("%-28s %5d^2 cells, %2d threads: %8.3f ns/cell/step, %6.2f GB/s, %.1f allocations/step"),
+					*Result.Simulation, Result.Size, Result.Threads, Result.GetNanosecondsPerCellStep(), Result.GetGigabytesPerSecond(),
+					static_cast<double>(Result.Allocations) / Result.Steps);
+				Results.Add(MoveTemp(Result));
+
+				if (!bTiled)
+				{
+					break;
+				}
+			}
+
+			Simulation->RemoveFromRoot();
+			Simulation->MarkAsGarbage();
+		}
+
+		// Large grids take gigabytes, give them back before the next size
+		CellField.Reset();
+		CollectGarbage(RF_NoFlags);
+	}
+
+	World->DestroyWorld(/*bInformEngineOfWorld=*/false);
+	return WriteResults(OutputDir, Results) ? 0 : 1;
+}
+
+TSharedPtr<FSnowCellField> USnowBenchmarkCommandlet::MakeSyntheticTerrain(int32 Size, float CellMeters) const
+{
+	// Corner lattice of ridges and valleys between 1500 m and 3700 m, so some cells start with snow (above 3300 m)
+	const int32 NumCorners = Size + 1;
+	TArray<FVector3f> Corners;
+	Corners.SetNumUninitialized(NumCorners * NumCorners);
+	const float Frequency = 2.0f * PI / 128.0f;
+	for (int32 Y = 0; Y < NumCorners; ++Y)
+	{
+		for (int32 X = 0; X < NumCorners; ++X)
+		{
+			const float Ridges = FMath::Sin(X * Frequency) * FMath::Cos(Y * Frequency * 0.7f);
+			const float Detail = 0.25f * FMath::Sin((X + 2 * Y) * Frequency * 3.1f);
+			const float ElevationMeters = 2600.0f + 880.0f * (Ridges + Detail);
+			Corners[X + Y * NumCorners] = FVector3f(X * CellMeters * 100.0f, Y * CellMeters * 100.0f, ElevationMeters * 100.0f);
+		}
+	}
+
+	TSharedPtr<FSnowCellField> Field = MakeShared<FSnowCellField>();
+	Field->Build(Size, Size, MoveTemp(Corners), 46.5f, CellMeters);
+	return Field;
+}
+
+USnowBenchmarkCommandlet::FResult USnowBenchmarkCommandlet::Run(USimulationBase* Simulation, ASnowSimulationActor* Actor, USimulationWeatherDataProviderBase* Provider,
+	const TSharedPtr<FSnowCellField>& CellField, float CellMeters, int32 Threads, int32 Warmup, int32 Steps) const
+{
+	FResult Result;
+	Result.Simulation = Simulation->GetClass()->GetName();
+	Result.Size = CellField->DimX;
+	Result.Threads = Threads;
+	Result.Steps = Steps;
+	Result.BytesPerCell = GetBytesPerCell(Simulation);
+
+	const float DtSeconds = 3600.0f;
+	TArray<FDebugCell> DebugCells;
+	UDegreeDayCPUSimulation* LegacySimulation = Cast<UDegreeDayCPUSimulation>(Simulation);
+	USnowSimulation* SnowSimulation = LegacySimulation ? nullptr : Cast<USnowSimulation>(Simulation);
+
+	// Every configuration starts from the same snow free grid
+	if (SnowSimulation)
+	{
+		SnowSimulation->Initialize(CellField->DimX, CellField->DimY, CellMeters);
+		SnowSimulation->SetTerrainMetadata(CellField);
+		SnowSimulation->SetMaxWorkerThreads(Threads);
+	}
+	else
+	{
+		Result.Threads = 1;
+		Simulation->Initialize(Actor, CellField, 0.0f, Actor->GetWorld());
+	}
+
+	auto RunStep = [&](int32 StepIndex)
+	{
+		if (SnowSimulation)
+		{
+			const FWeatherForcingData Forcing = Provider->GetWeatherForcing(Actor->CurrentSimulationTime + FTimespan::FromHours(StepIndex));
+			SnowSimulation->Step(DtSeconds, Forcing, SnowSimulation->DepthMeters);
+		}
+		else
+		{
+			Simulation->Simulate(Actor, StepIndex, 1, false, false, DebugCells);
+		}
+	};
+
+	for (int32 StepIndex = 0; StepIndex < Warmup; ++StepIndex)
+	{
+		RunStep(StepIndex);
+	}
+
+	const double StartSeconds = FPlatformTime::Seconds();
+	for (int32 StepIndex = Warmup; StepIndex < Warmup + Steps; ++StepIndex)
+	{
+		RunStep(StepIndex);
+	}
+	Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+
+	// Allocations are counted in a separate pass on the calling thread only, so other threads are not counted
+	if (SnowSimulation)
+	{
+		SnowSimulation->SetMaxWorkerThreads(1);
+	}
+	{
+		FScopedAllocationCounter AllocationCounter;
+		for (int32 StepIndex = Warmup + Steps; StepIndex < Warmup + 2 * Steps; ++StepIndex)
+		{
+			RunStep(StepIndex);
+		}
+		Result.Allocations = AllocationCounter.Counter.GetAllocations();
+		Result.AllocatedBytes = AllocationCounter.Counter.GetAllocatedBytes();
+	}
+	return Result;
+}
+
+bool USnowBenchmarkCommandlet::WriteResults(const FString& OutputDir, const TArray<FResult>& Results) const
+{
+	IFileManager::Get().MakeDirectory(*OutputDir, true);
+
+	FString Csv = TEXT("simulation,cells_per_side,cells,threads,steps,seconds,ns_per_cell_step,gb_per_s,bytes_per_cell,allocs_per_step,alloc_bytes_per_step\n");
+	FString Json;
+	TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Json);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	Writer->WriteValue(TEXT("platform"), FString(FPlatformProperties::IniPlatformName()));
+	Writer->WriteValue(TEXT("cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+	Writer->WriteValue(TEXT("cores"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	Writer->WriteArrayStart(TEXT("results"));
+	for (const FResult& Result : Results)
+	{
+		const double AllocsPerStep = static_cast<double>(Result.Allocations) / Result.Steps;
+		const double AllocBytesPerStep = static_cast<double>(Result.AllocatedBytes) / Result.Steps;
+		Csv += FString::Printf(TEXT("%s,%d,%lld,%d,%d,%f,%f,%f,%.0f,%f,%f\n"), *Result.Simulation, Result.Size, static_cast<int64>(Result.Size) * Result.Size,
+			Result.Threads, Result.Steps, Result.Seconds, Result.GetNanosecondsPerCellStep(), Result.GetGigabytesPerSecond(), Result.BytesPerCell, AllocsPerStep, AllocBytesPerStep);
+
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("simulation"), Result.Simulation);
+		Writer->WriteValue(TEXT("cells_per_side"), Result.Size);
+		Writer->WriteValue(TEXT("cells"), static_cast<int64>(Result.Size) * Result.Size);
+		Writer->WriteValue(TEXT("threads"), Result.Threads);
+		Writer->WriteValue(TEXT("steps"), Result.Steps);
+		Writer->WriteValue(TEXT("seconds"), Result.Seconds);
+		Writer->WriteValue(TEXT("ns_per_cell_step"), Result.GetNanosecondsPerCellStep());
+		Writer->WriteValue(TEXT("gb_per_s"), Result.GetGigabytesPerSecond());
+		Writer->WriteValue(TEXT("bytes_per_cell"), Result.BytesPerCell);
+		Writer->WriteValue(TEXT("allocs_per_step"), AllocsPerStep);
+		Writer->WriteValue(TEXT("alloc_bytes_per_step"), AllocBytesPerStep);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	const FString CsvPath = OutputDir / TEXT("benchmark.csv");
+	const FString JsonPath = OutputDir / TEXT("benchmark.json");
+	if (!FFileHelper::SaveStringToFile(Csv, *CsvPath) || !FFileHelper::SaveStringToFile(Json, *JsonPath))
+	{
+		UE_LOG(LogSnowBenchmarkCommandlet, Error, TEXT("Could not write the results to %s"), *OutputDir);
+		return false;
+	}
+	UE_LOG(LogSnowBenchmarkCommandlet, Display, TEXT("Wrote %d results to %s and %s"), Results.Num(), *CsvPath, *JsonPath);
+	return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SnowBenchmarkCommandlet.generated.h"
+
+class USimulationBase;
+class USimulationWeatherDataProviderBase;
+class ASnowSimulationActor;
+struct FSnowCellField;
+
+/**
+* Microbenchmark of the simulation step kernels on synthetic terrain with fixed forcing:
+*
+*	UnrealEditor-Cmd SnowLumen.uproject -run=SnowBenchmark -nullrhi -unattended
+*		-Sizes=256,512,1024,2048,4096,8192 -Steps=24 -Warmup=2 -Threads=1,2,4,8 -Out=Saved/SnowBenchmark
+*
+* Runs USimpleAccumulationSim, UDegreeDaySimulation (Step) and UDegreeDayCPUSimulation (Simulate) on every grid size
+* (cells per side) and worker count, and writes benchmark.csv and benchmark.json with ns/cell/step, the effective
+* memory bandwidth and the allocations per step (counted in a separate pass of Steps steps on one thread). The simulations can be restricted with -Simulations=<class,class>.
+*/
+UCLASS()
+class SIMULATION_API USnowBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USnowBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** One measured configuration. */
+	struct FResult
+	{
+		FString Simulation;
+		int32 Size = 0;
+		int32 Threads = 0;
+		int32 Steps = 0;
+		double Seconds = 0.0;
+		int64 Allocations = 0;
+		int64 AllocatedBytes = 0;
+		float BytesPerCell = 0.0f;
+
+		double GetNanosecondsPerCellStep() const;
+		double GetGigabytesPerSecond() const;
+	};
+
+	/** Builds a Size x Size cell field of rolling alpine terrain, deterministic for a given size. */
+	TSharedPtr<FSnowCellField> MakeSyntheticTerrain(int32 Size, float CellMeters) const;
+
+	/**
+	* Runs Warmup untimed and Steps timed steps of Simulation limited to Threads workers (0 = all), then Steps more on the
+	* calling thread counting their allocations.
+	*/
+	FResult Run(USimulationBase* Simulation, ASnowSimulationActor* Actor, USimulationWeatherDataProviderBase* Provider, const TSharedPtr<FSnowCellField>& CellField, float CellMeters, int32 Threads, int32 Warmup, int32 Steps) const;
+
+	/** Writes the results as CSV and JSON to OutputDir. */
+	bool WriteResults(const FString& OutputDir, const TArray<FResult>& Results) const;
+};
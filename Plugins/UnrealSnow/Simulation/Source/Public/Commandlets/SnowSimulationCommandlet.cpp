@@ -0,0 +1,333 @@
+#include "SnowSimulationCommandlet.h"
+#include "Simulation.h"
+#include "SnowSimulation.h"
+#include "Cells/SnowCellField.h"
+#include "SimulationWeatherDataProviderBase.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "UObject/UObjectGlobals.h"
+#include "Engine/EngineTypes.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSnowSimulationCommandlet, Log, All);
+
+namespace
+{
+	bool ParseDateTime(const FString& Text, FDateTime& OutTime)
+	{
+		return FDateTime::ParseIso8601(*Text, OutTime) || FDateTime::Parse(Text, OutTime);
+	}
+
+	/** Parses the "KEY VALUE" lines of an ESRI .hdr file, keys are upper-cased. */
+	TMap<FString, FString> ParseBilHeader(const FString& HeaderPath)
+	{
+		TMap<FString, FString> Header;
+		TArray<FString> Lines;
+		if (FFileHelper::LoadFileToStringArray(Lines, *HeaderPath))
+		{
+			for (const FString& Line : Lines)
+			{
+				FString Key, Value;
+				if (Line.TrimStartAndEnd().Split(TEXT(" "), &Key, &Value))
+				{
+					Header.Add(Key.ToUpper(), Value.TrimStartAndEnd());
+				}
+			}
+		}
+		return Header;
+	}
+}
+
+USnowSimulationCommandlet::USnowSimulationCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 USnowSimulationCommandlet::Main(const FString& Params)
+{
+	const TCHAR* CmdLine = *Params;
+
+	FString HeightmapPath;
+	if (!FParse::Value(CmdLine, TEXT("Heightmap="), HeightmapPath))
+	{
+		UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("Missing -Heightmap=<file.bil>"));
+		return 1;
+	}
+
+	float CellMeters = 0.0f;
+	FParse::Value(CmdLine, TEXT("CellMeters="), CellMeters);
+	float Latitude = 0.0f;
+	FParse::Value(CmdLine, TEXT("Latitude="), Latitude);
+
+	FString SimulationClassPath = TEXT("/Script/Simulation.DegreeDaySimulation");
+	FParse::Value(CmdLine, TEXT("Simulation="), SimulationClassPath);
+	FString ProviderClassPath = TEXT("/Script/SimulationData.ConstantWeatherProvider");
+	FParse::Value(CmdLine, TEXT("Provider="), ProviderClassPath);
+	FString ProviderOverrides, SimulationOverrides;
+	FParse::Value(CmdLine, TEXT("ProviderSet="), ProviderOverrides, false);
+	FParse::Value(CmdLine, TEXT("SimulationSet="), SimulationOverrides, false);
+
+	FDateTime StartTime(2015, 10, 1);
+	FDateTime EndTime(2016, 9, 1);
+	FString DateText;
+	if (FParse::Value(CmdLine, TEXT("Start="), DateText) && !ParseDateTime(DateText, StartTime))
+	{
+		UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("Invalid -Start=%s"), *DateText);
+		return 1;
+	}
+	if (FParse::Value(CmdLine, TEXT("End="), DateText) && !ParseDateTime(DateText, EndTime))
+	{
+		UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("Invalid -End=%s"), *DateText);
+		return 1;
+	}
+
+	float DtSeconds = 3600.0f;
+	FParse::Value(CmdLine, TEXT("Dt="), DtSeconds);
+	float SnapshotHours = 24.0f;
+	FParse::Value(CmdLine, TEXT("SnapshotHours="), SnapshotHours);
+	FString OutputDir = FPaths::ProjectSavedDir() / TEXT("SnowSimulation");
+	FParse::Value(CmdLine, TEXT("Out="), OutputDir);
+
+	if (DtSeconds <= 0.0f || EndTime <= StartTime)
+	{
+		UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("Invalid time range %s - %s with dt=%.0fs"), *StartTime.ToString(), *EndTime.ToString(), DtSeconds);
+		return 1;
+	}
+
+	// Terrain
+	TSharedPtr<FSnowCellField> CellField = LoadHeightmap(HeightmapPath, CellMeters, Latitude);
+	if (!CellField.IsValid())
+	{
+		return 1;
+	}
+
+	// Simulation
+	UClass* SimulationClass = LoadClass<USnowSimulation>(nullptr, *SimulationClassPath);
+	if (!SimulationClass || SimulationClass->HasAnyClassFlags(CLASS_Abstract))
+	{
+		UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("%s is not a concrete USnowSimulation class"), *SimulationClassPath);
+		return 1;
+	}
+	USnowSimulation* Simulation = NewObject<USnowSimulation>(GetTransientPackage(), SimulationClass);
+	Simulation->AddToRoot();
+	if (!ApplyPropertyOverrides(Simulation, SimulationOverrides))
+	{
+		Simulation->RemoveFromRoot();
+		return 1;
+	}
+	Simulation->Initialize(CellField->DimX, CellField->DimY, CellMeters);
+	Simulation->SetTerrainMetadata(CellField);
+
+	// Weather
+	UClass* ProviderClass = LoadClass<USimulationWeatherDataProviderBase>(nullptr, *ProviderClassPath);
+	if (!ProviderClass || ProviderClass->HasAnyClassFlags(CLASS_Abstract))
+	{
+		UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("%s is not a concrete weather provider class"), *ProviderClassPath);
+		Simulation->RemoveFromRoot();
+		return 1;
+	}
+	USimulationWeatherDataProviderBase* Provider = NewObject<USimulationWeatherDataProviderBase>(GetTransientPackage(), ProviderClass);
+	Provider->AddToRoot();
+	if (!ApplyPropertyOverrides(Provider, ProviderOverrides))
+	{
+		Provider->RemoveFromRoot();
+		Simulation->RemoveFromRoot();
+		return 1;
+	}
+	Provider->Initialize(StartTime, EndTime);
+
+	IFileManager::Get().MakeDirectory(*OutputDir, true);
+	FString Summary = TEXT("time,min_m,max_m,mean_m\n");
+
+	const int32 NumSteps = FMath::FloorToInt((EndTime - StartTime).GetTotalSeconds() / DtSeconds);
+	const int32 SnapshotSteps = FMath::Max(1, FMath::RoundToInt(SnapshotHours * 3600.0f / DtSeconds));
+
+	UE_LOG(LogSnowSimulationCommandlet, Display, TEXT("Running %s with %s on %dx%d cells: %d steps of %.0fs, snapshot every %d steps to %s"),
+		*Simulation->GetSimulationName(), *ProviderClass->GetName(), CellField->DimX, CellField->DimY, NumSteps, DtSeconds, SnapshotSteps, *OutputDir);
+
+	// Providers with a time series read it through a cursor stepping with the simulation instead of a search per step
+	FWeatherForcingCursor StepCursor;
+	Provider->SetUpStepCursor(StepCursor, FTimespan::FromSeconds(DtSeconds));
+
+	const double StartSeconds = FPlatformTime::Seconds();
+	double NextProgressSeconds = StartSeconds + 10.0;
+	bool bWriteFailed = false;
+
+	// Steps run in spans ending at the snapshots, so quiescent stretches are fast-forwarded instead of stepped
+	constexpr int32 MaxSpanSteps = 1024;
+	TArray<FWeatherForcingData> SpanForcing;
+	SpanForcing.Reserve(FMath::Min(SnapshotSteps, MaxSpanSteps));
+	for (int32 SpanStart = 0; SpanStart < NumSteps && !bWriteFailed;)
+	{
+		const int32 NextSnapshot = FMath::Min((SpanStart / SnapshotSteps + 1) * SnapshotSteps, NumSteps);
+		const int32 SpanEnd = FMath::Min(NextSnapshot, SpanStart + MaxSpanSteps);
+		SpanForcing.Reset();
+		for (int32 StepIndex = SpanStart; StepIndex < SpanEnd; ++StepIndex)
+		{
+			SpanForcing.Add(Provider->GetWeatherForcingAtStep(StepCursor, StepIndex));
+		}
+		Simulation->StepSpan(DtSeconds, SpanForcing, Simulation->DepthMeters);
+		SpanStart = SpanEnd;
+
+		const FDateTime SpanEndTime = StartTime + FTimespan::FromSeconds(static_cast<double>(SpanEnd) * DtSeconds);
+		if (SpanEnd == NextSnapshot)
+		{
+			bWriteFailed = !WriteSnapshot(OutputDir, *Simulation, SpanEndTime, Summary);
+		}
+
+		const double Now = FPlatformTime::Seconds();
+		if (Now >= NextProgressSeconds)
+		{
+			UE_LOG(LogSnowSimulationCommandlet, Display, TEXT("%s: %d / %d steps (%.1f steps/s)"),
+				*SpanEndTime.ToString(), SpanEnd, NumSteps, SpanEnd / (Now - StartSeconds));
+			NextProgressSeconds = Now + 10.0;
+		}
+	}
+
+	FFileHelper::SaveStringToFile(Summary, *(OutputDir / TEXT("summary.csv")));
+
+	const double ElapsedSeconds = FPlatformTime::Seconds() - StartSeconds;
+	UE_LOG(LogSnowSimulationCommandlet, Display, TEXT("Simulated %d steps in %.2fs (%.1f steps/s)"), NumSteps, ElapsedSeconds, NumSteps / FMath::Max(ElapsedSeconds, 1e-6));
+
+	Provider->RemoveFromRoot();
+	Simulation->RemoveFromRoot();
+	return bWriteFailed ? 1 : 0;
+}
+
+TSharedPtr<FSnowCellField> USnowSimulationCommandlet::LoadHeightmap(const FString& Path, float& CellMeters, float Latitude) const
+{
+	const TMap<FString, FString> Header = ParseBilHeader(FPaths::ChangeExtension(Path, TEXT("hdr")));
+	const int32 NumRows = Header.Contains(TEXT("NROWS")) ? FCString::Atoi(*Header[TEXT("NROWS")]) : 0;
+	const int32 NumCols = Header.Contains(TEXT("NCOLS")) ? FCString::Atoi(*Header[TEXT("NCOLS")]) : 0;
+	const int32 NumBits = Header.Contains(TEXT("NBITS")) ? FCString::Atoi(*Header[TEXT("NBITS")]) : 16;
+	const bool bFloat = Header.Contains(TEXT("PIXELTYPE")) && Header[TEXT("PIXELTYPE")].Equals(TEXT("FLOAT"), ESearchCase::IgnoreCase);
+	const bool bBigEndian = Header.Contains(TEXT("BYTEORDER")) && Header[TEXT("BYTEORDER")].Equals(TEXT("M"), ESearchCase::IgnoreCase);
+	const float NoData = Header.Contains(TEXT("NODATA")) ? FCString::Atof(*Header[TEXT("NODATA")]) : -9999.0f;
+	if (CellMeters <= 0.0f)
+	{
+		CellMeters = Header.Contains(TEXT("XDIM")) ? FCString::Atof(*Header[TEXT("XDIM")]) : 1.0f;
+	}
+
+	if (NumRows < 2 || NumCols < 2 || (NumBits != 16 && NumBits != 32))
+	{
+		UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("%s: unsupported BIL header (%dx%d, %d bit)"), *Path, NumCols, NumRows, NumBits);
+		return nullptr;
+	}
+
+	TArray<uint8> Raw;
+	const int32 BytesPerSample = NumBits / 8;
+	if (!FFileHelper::LoadFileToArray(Raw, *Path) || Raw.Num() < NumRows * NumCols * BytesPerSample)
+	{
+		UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("%s: could not read %dx%d samples"), *Path, NumCols, NumRows);
+		return nullptr;
+	}
+
+	// Samples are the cell corners, positions in cm as in the landscape
+	TArray<FVector3f> Corners;
+	Corners.SetNumUninitialized(NumRows * NumCols);
+	for (int32 Index = 0; Index < NumRows * NumCols; ++Index)
+	{
+		const uint8* Sample = &Raw[Index * BytesPerSample];
+		uint32 Bits = 0;
+		for (int32 Byte = 0; Byte < BytesPerSample; ++Byte)
+		{
+			const int32 Shift = bBigEndian ? (BytesPerSample - 1 - Byte) * 8 : Byte * 8;
+			Bits |= static_cast<uint32>(Sample[Byte]) << Shift;
+		}
+
+		float Elevation;
+		if (NumBits == 16)
+		{
+			Elevation = static_cast<int16>(Bits);
+		}
+		else if (bFloat)
+		{
+			FMemory::Memcpy(&Elevation, &Bits, sizeof(float));
+		}
+		else
+		{
+			Elevation = static_cast<int32>(Bits);
+		}
+		if (Elevation == NoData)
+		{
+			Elevation = 0.0f;
+		}
+
+		Corners[Index] = FVector3f((Index % NumCols) * CellMeters * 100.0f, (Index / NumCols) * CellMeters * 100.0f, Elevation * 100.0f);
+	}
+
+	TSharedPtr<FSnowCellField> Field = MakeShared<FSnowCellField>();
+	Field->Build(NumCols - 1, NumRows - 1, MoveTemp(Corners), Latitude, CellMeters);
+
+	UE_LOG(LogSnowSimulationCommandlet, Display, TEXT("Loaded %s: %dx%d cells of %.1fm"), *Path, Field->DimX, Field->DimY, CellMeters);
+	return Field;
+}
+
+bool USnowSimulationCommandlet::ApplyPropertyOverrides(UObject* Object, const FString& Overrides) const
+{
+	TArray<FString> Assignments;
+	Overrides.ParseIntoArray(Assignments, TEXT(";"));
+
+	for (const FString& Assignment : Assignments)
+	{
+		FString Name, Value;
+		if (!Assignment.Split(TEXT("="), &Name, &Value))
+		{
+			UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("Invalid property override '%s', expected Name=Value"), *Assignment);
+			return false;
+		}
+		Name.TrimStartAndEndInline();
+		Value.TrimStartAndEndInline();
+
+		FProperty* Property = FindFProperty<FProperty>(Object->GetClass(), *Name);
+		if (!Property)
+		{
+			UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("%s has no property '%s'"), *Object->GetClass()->GetName(), *Name);
+			return false;
+		}
+
+		// Allow plain paths for FFilePath/FDirectoryPath
+		const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+		if (StructProperty && !Value.StartsWith(TEXT("(")))
+		{
+			if (StructProperty->Struct == FFilePath::StaticStruct())
+			{
+				Value = FString::Printf(TEXT("(FilePath=\"%s\")"), *Value);
+			}
+			else if (StructProperty->Struct == FDirectoryPath::StaticStruct())
+			{
+				Value = FString::Printf(TEXT("(Path=\"%s\")"), *Value);
+			}
+		}
+
+		if (!Property->ImportText_InContainer(*Value, Object, Object, PPF_None))
+		{
+			UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("Could not set %s.%s to '%s'"), *Object->GetClass()->GetName(), *Name, *Value);
+			return false;
+		}
+	}
+	return true;
+}
+
+bool USnowSimulationCommandlet::WriteSnapshot(const FString& OutputDir, USnowSimulation& Simulation, const FDateTime& Time, FString& Summary) const
+{
+	Simulation.ResolveCellState();
+	const TArray<float>& Depth = Simulation.DepthMeters;
+
+	// The step kernels already reduced the statistics, only a simulation without them rescans the grid
+	const FSnowStepStats& Stats = Simulation.EnsureStepStats(Depth);
+	Summary += FString::Printf(TEXT("%s,%f,%f,%f\n"), *Time.ToIso8601(), Stats.MinDepth, Stats.MaxDepth, Stats.GetMeanDepth());
+
+	// Raw float32 grid, all supported platforms are little-endian
+	const FString FileName = OutputDir / FString::Printf(TEXT("depth_%dx%d_%s.r32"), Simulation.GridX, Simulation.GridY, *Time.ToString(TEXT("%Y%m%d_%H%M")));
+	const TArrayView<const uint8> Bytes(reinterpret_cast<const uint8*>(Depth.GetData()), Depth.Num() * sizeof(float));
+	if (!FFileHelper::SaveArrayToFile(Bytes, *FileName))
+	{
+		UE_LOG(LogSnowSimulationCommandlet, Error, TEXT("Could not write snapshot %s"), *FileName);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SnowSimulationCommandlet.generated.h"
+
+class USnowSimulation;
+class USimulationWeatherDataProviderBase;
+struct FSnowCellField;
+
+/**
+* Runs a USnowSimulation headless and as fast as the CPU allows, e.g. for nightly full-season batch runs:
+*
+*	UnrealEditor-Cmd SnowLumen.uproject -run=SnowSimulation -nullrhi -unattended
+*		-Heightmap=TestData/sample.bil -CellMeters=30 -Latitude=46.5
+*		-Simulation=/Script/Simulation.DegreeDaySimulation
+*		-Provider=/Script/SimulationData.CsvWeatherProvider -ProviderSet="CsvFilePath=TestWeatherData.csv;bUniformGrid=true"
+*		-Start=2015-10-01T00:00:00 -End=2016-09-01T00:00:00 -Dt=3600 -SnapshotHours=24 -Out=Saved/SnowSim
+*
+* The terrain is an ESRI BIL heightmap (16 or 32 bit, elevation in meters) whose samples are the cell corners.
+* Snapshots are written as raw little-endian float32 depth grids (meters, row-major) next to a summary.csv.
+*/
+UCLASS()
+class SIMULATION_API USnowSimulationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USnowSimulationCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Builds the cell field from a BIL heightmap, returns nullptr on failure. A CellMeters <= 0 is taken from the header. */
+	TSharedPtr<FSnowCellField> LoadHeightmap(const FString& Path, float& CellMeters, float Latitude) const;
+
+	/** Applies "Name=Value;Name=Value" property overrides to Object. */
+	bool ApplyPropertyOverrides(UObject* Object, const FString& Overrides) const;
+
+	/** Writes the depth grid of Simulation at Time to OutputDir and appends a line to Summary. */
+	bool WriteSnapshot(const FString& OutputDir, USnowSimulation& Simulation, const FDateTime& Time, FString& Summary) const;
+};
@@ -22,17 +22,24 @@ void UDegreeDayCPUSimulation::Simulate(ASnowSimulationActor* SimulationActor, in
 {
 	MaxSnow = 0;
 
-	auto ClimateDataArray = SimulationActor->ClimateDataComponent->CreateRawClimateDataResourceArray(SimulationActor->StartTime, SimulationActor->EndTime);
-	
-	// Simulation
-	for (auto& Cell : Cells)
+	if (!CellField.IsValid())
 	{
-		const FVector& CellCentroid = Cell.Centroid;
+		return;
+	}
+	FSnowCellField& Cells = *CellField;
 
-		
-		auto ClimateData = (*ClimateDataArray)[CurrentSimulationStep];
-			
-		float Altitude = CellCentroid.Z - SimulationActor->ClimateDataComponent->GetMeasurementAltitude(); // Altitude in cm
+	const FClimateData ClimateData = SimulationActor->ClimateDataComponent->GetClimateData(CurrentSimulationStep);
+	const float MeasurementAltitude = SimulationActor->ClimateDataComponent->GetMeasurementAltitude();
+	const int32 DayOfYear = SimulationActor->CurrentSimulationTime.GetDayOfYear();
+
+	// The day terms are shared by all cells, only evaluate them once per step
+	const bool bUseTable = bUseSolarRadiationTable && SolarRadiationTable.IsBuilt() && SolarRadiationTable.GetLatitude() == Cells.Latitude;
+	const FSolarDayTerms DayTerms = bUseTable ? SolarRadiationTable.GetDayTerms(DayOfYear) : FSolarRadiation::ComputeDayTerms(Cells.Latitude, DayOfYear);
+
+	// Simulation
+	for (int32 Index = 0; Index < Cells.Num(); ++Index)
+	{
+		float Altitude = Cells.Altitude[Index] - MeasurementAltitude; // Altitude in cm
 		
 		float TemperatureLapse = -0.5f * Altitude / (100 * 100);
 		float PrecipitationLapse = 0.5f * Altitude / (100 * 1000);
@@ -42,36 +49,38 @@ void UDegreeDayCPUSimulation::Simulate(ASnowSimulationActor* SimulationActor, in
 		const float Precipitation = ClimateData.Precipitation + PrecipitationLapse; // l/m^2 or mm
 			
 		// @TODO use AreaXY because very steep slopes with big areas would receive too much snow
-		const float AreaSquareMeters = Cell.AreaXY / (100 * 100); // m^2
+		const float AreaSquareMeters = Cells.AreaXY[Index] / (100 * 100); // m^2
+
+		float& SnowWaterEquivalent = Cells.SWE[Index];
+		float& SnowAlbedo = Cells.Albedo[Index];
+		float& DaysSinceLastSnowfall = Cells.Age[Index];
 
 		// Apply precipitation
 		if (Precipitation > 0)
 		{
-			Cell.DaysSinceLastSnowfall = 0;
+			DaysSinceLastSnowfall = 0;
 
 			// New snow/rainfall
-			const bool Rain = TAir > TSnowB;
-
 			if (TAir > TSnowB)
 			{
-				Cell.SnowAlbedo = 0.4; // New rain drops the albedo to 0.4
+				SnowAlbedo = 0.4; // New rain drops the albedo to 0.4
 			}
 			else 
 			{
 				// Variable lapse rate as described in "A variable lapse rate snowline model for the Remarkables, Central Otago, New Zealand"
 				float SnowRate = FMath::Clamp(1 - (TAir - TSnowA) / (TSnowB - TSnowA), 0.0f, 1.0f);
 
-				Cell.SnowWaterEquivalent += (Precipitation * AreaSquareMeters * SnowRate); // l/m^2 * m^2 = l
-				Cell.SnowAlbedo = 0.8; // New snow sets the albedo to 0.8
+				SnowWaterEquivalent += (Precipitation * AreaSquareMeters * SnowRate); // l/m^2 * m^2 = l
+				SnowAlbedo = 0.8; // New snow sets the albedo to 0.8
 			}
 		}
 
 		// Apply melt
-		if (Cell.SnowWaterEquivalent > 0)
+		if (SnowWaterEquivalent > 0)
 		{
-			if (Cell.DaysSinceLastSnowfall >= 0) {
+			if (DaysSinceLastSnowfall >= 0) {
 				// @TODO is time T the degree-days or the time since the last snowfall?
-				Cell.SnowAlbedo = 0.4 * (1 + FMath::Exp(-k_e * Cell.DaysSinceLastSnowfall)); 
+				SnowAlbedo = 0.4 * (1 + FMath::Exp(-k_e * DaysSinceLastSnowfall)); 
 			}
 
 			// Temperature higher than melt threshold and cell contains snow
@@ -80,70 +89,59 @@ void UDegreeDayCPUSimulation::Simulate(ASnowSimulationActor* SimulationActor, in
 				const float DayNormalization = 1.0f / 24.0f; // day 
 
 				// @TODO radiation index at nighttime? How about newer simulations?
-				// @TODO Bl�schl (???) used different radiation values during night
+				// @TODO Blöschl (???) used different radiation values during night
 				
 				// Radiation Index
-				const float R_i = SolarRadiationIndex(Cell.Inclination, Cell.Aspect, Cell.Latitude, SimulationActor->CurrentSimulationTime.GetDayOfYear()); // 1
+				const float R_i = bUseTable
+					? SolarRadiationTable.GetRadiationIndex(Cells.Slope[Index], Cells.Aspect[Index], DayOfYear)
+					: FSolarRadiation::Evaluate(Cells.Slope[Index], Cells.Aspect[Index], Cells.Latitude, DayTerms).Ri; // 1
 
 				// Melt factor
 				const float VegetationDensity = 0;
 				const float k_v = FMath::Exp(-4 * VegetationDensity); // 1
-				const float c_m = k_m * k_v * R_i *  (1 - Cell.SnowAlbedo) * DayNormalization * AreaSquareMeters; // l/m^2/C�/day * day * m^2 = l/m^2 * 1/day * day * m^2 = l/C�
+				const float c_m = k_m * k_v * R_i *  (1 - SnowAlbedo) * DayNormalization * AreaSquareMeters; // l/m^2/C°/day * day * m^2 = l/m^2 * 1/day * day * m^2 = l/C°
 				const float MeltFactor = TAir < TMeltB ? (TAir - TMeltA) * (TAir - TMeltA) / (TMeltB - TMeltA) : (TAir - TMeltA);
 			
-				const float M = c_m * MeltFactor; // l/C� * C� = l
+				const float M = c_m * MeltFactor; // l/C° * C° = l
 
 				// Apply melt
-				Cell.SnowWaterEquivalent -= M; 
-				Cell.SnowWaterEquivalent = FMath::Max(0.0f, Cell.SnowWaterEquivalent);
+				SnowWaterEquivalent -= M; 
+				SnowWaterEquivalent = FMath::Max(0.0f, SnowWaterEquivalent);
 			}
 		}
 
-		Cell.DaysSinceLastSnowfall += 1.0f / 24.0f;
+		DaysSinceLastSnowfall += 1.0f / 24.0f;
 	}
 
-	// Interpolation according to Bl�schls "Distributed Snowmelt Simulations in an Alpine Catchment"
-	for (auto& Cell : Cells)
+	// Interpolation according to Blöschls "Distributed Snowmelt Simulations in an Alpine Catchment"
+	InterpolatedSWE.SetNumUninitialized(Cells.Num(), EAllowShrinking::No);
+	for (int32 Index = 0; Index < Cells.Num(); ++Index)
 	{
-		float Slope = FMath::RadiansToDegrees(Cell.Inclination);
+		float Slope = FMath::RadiansToDegrees(Cells.Slope[Index]);
 
 		float f = Slope < 15 ? 0 : Slope / 65;
 		float a3 = 50;
-		float we = FMath::Max(0.0f, Cell.SnowWaterEquivalent * (1 - f) * (1 + a3 * Cell.Curvature));
+		float we = FMath::Max(0.0f, Cells.SWE[Index] * (1 - f) * (1 + a3 * Cells.Curvature[Index]));
 
-		Cell.InterpolatedSnowWaterEquivalent = we;
+		InterpolatedSWE[Index] = we;
 
-		auto AreaSquareMeters = Cell.Area / (100 * 100);
-		MaxSnow = FMath::Max(Cell.InterpolatedSnowWaterEquivalent / AreaSquareMeters, MaxSnow);
-	}
-
-	if (CaptureDebugInformation)
-	{
-		// Fill debug array
-		for (auto& Cell : Cells)
-		{
-			/*
-			float SnowMM = Cell.InterpolatedSWE / (Cell.Area / (100 * 100));
-			DebugInformation.Add(FDebugCellInformation(SnowMM);
-			*/
-		}
+		auto AreaSquareMeters = Cells.Area[Index] / (100 * 100);
+		MaxSnow = FMath::Max(we / AreaSquareMeters, MaxSnow);
 	}
 }
 
-void UDegreeDayCPUSimulation::Initialize(ASnowSimulationActor* SimulationActor, const TArray<FLandscapeCell>& LandscapeCells, float InitialMaxSnow, UWorld* World)
+void UDegreeDayCPUSimulation::Initialize(ASnowSimulationActor* SimulationActor, const TSharedPtr<FSnowCellField>& Cells, float InitialMaxSnow, UWorld* World)
 {
-	// Create Cells - Note: LocalCells was created but never used, removed to avoid confusion
-	// TResourceArray<FGPUSimulationCell> LocalCells;
-	// for (const FLandscapeCell& LandscapeCell : LandscapeCells)
-	// {
-	// 	FGPUSimulationCell Cell(LandscapeCell.Aspect, LandscapeCell.Inclination, LandscapeCell.Altitude,
-	// 		LandscapeCell.Latitude, LandscapeCell.Area, LandscapeCell.AreaXY, LandscapeCell.InitialWaterEquivalent);
-	// 	LocalCells.Add(Cell);
-	// }
-
-	// Distance between neighboring cells in cm (calculate as in https://forums.unrealengine.com/showthread.php?57338-Calculating-Exact-Map-Size)
-	auto Scale = SimulationActor->LandscapeScale;
-	const float L = SimulationActor->LandscapeScale.X / 100 * SimulationActor->CellSize;
+	// The cells are shared with the actor, the simulation state (SWE, albedo, age) is updated in place
+	CellField = Cells;
+	CellsDimensionX = SimulationActor->CellsDimensionX;
+	CellsDimensionY = SimulationActor->CellsDimensionY;
+	InterpolatedSWE.SetNumZeroed(CellField.IsValid() ? CellField->Num() : 0);
+
+	if (bUseSolarRadiationTable && CellField.IsValid())
+	{
+		SolarRadiationTable.Build(CellField->Latitude, SolarTableInclinationStep, SolarTableAspectStep);
+	}
 }
 
 UTexture* UDegreeDayCPUSimulation::GetSnowMapTexture()
@@ -161,18 +159,18 @@ UTexture* UDegreeDayCPUSimulation::GetSnowMapTexture()
 		*UEnum::GetValueAsString(SnowMapTexture->GetPixelFormat()),
 		SnowMapTexture->SRGB ? TEXT("true") : TEXT("false"),
 		SnowMapTexture->GetSizeX(), SnowMapTexture->GetSizeY());
-	SnowMapTextureData.Empty(Cells.Num());
+	SnowMapTextureData.Empty(InterpolatedSWE.Num());
 
 	// Update snow map texture
 	for (int32 Y = 0; Y < CellsDimensionY; ++Y)
 	{
 		for (int32 X = 0; X < CellsDimensionX; ++X)
 		{
-			auto& Cell = Cells[Y * CellsDimensionX + X];
+			const int32 Index = Y * CellsDimensionX + X;
 
 			// Snow map texture
-			float AreaSquareMeters = Cell.Area / (100 * 100);
-			float SnowMM = Cell.InterpolatedSnowWaterEquivalent / AreaSquareMeters;
+			float AreaSquareMeters = CellField->Area[Index] / (100 * 100);
+			float SnowMM = InterpolatedSWE[Index] / AreaSquareMeters;
 			float Gray = SnowMM / GetMaxSnow() * 255;
 			uint8 GrayInt = static_cast<uint8>(Gray);
 			SnowMapTextureData.Add(FColor(GrayInt, GrayInt, GrayInt));
@@ -0,0 +1,163 @@
+#include "DegreeDayKernel.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+#if INTEL_ISPC
+#include "DegreeDayKernel.ispc.generated.h"
+#endif
+
+#if !defined(SNOW_DEGREE_DAY_ISPC_ENABLED_DEFAULT)
+#define SNOW_DEGREE_DAY_ISPC_ENABLED_DEFAULT 1
+#endif
+
+// Support run-time toggling on supported platforms in non-shipping configurations
+#if !INTEL_ISPC || UE_BUILD_SHIPPING
+static constexpr bool bSnow_DegreeDay_ISPC_Enabled = INTEL_ISPC && SNOW_DEGREE_DAY_ISPC_ENABLED_DEFAULT;
+#else
+static bool bSnow_DegreeDay_ISPC_Enabled = SNOW_DEGREE_DAY_ISPC_ENABLED_DEFAULT;
+static FAutoConsoleVariableRef CVarSnowDegreeDayISPCEnabled(
+	TEXT("snow.Sim.DegreeDay.ISPC"),
+	bSnow_DegreeDay_ISPC_Enabled,
+	TEXT("Whether to use the ISPC degree-day kernel (otherwise the VectorRegister4Float kernel is used)."));
+#endif
+
+#if !UE_BUILD_SHIPPING
+static bool bSnow_DegreeDay_ValidateKernel = false;
+static FAutoConsoleVariableRef CVarSnowDegreeDayValidateKernel(
+	TEXT("snow.Sim.DegreeDay.ValidateKernel"),
+	bSnow_DegreeDay_ValidateKernel,
+	TEXT("Compare the degree-day kernel against the scalar reference every step and log the largest difference."));
+#else
+static constexpr bool bSnow_DegreeDay_ValidateKernel = false;
+#endif
+
+void FDegreeDayKernel::Run(float* Depth, const float* Factor, int32 Num, float Accumulation, float Melt)
+{
+	if (Num <= 0)
+	{
+		return;
+	}
+
+	if (bSnow_DegreeDay_ISPC_Enabled)
+	{
+#if INTEL_ISPC
+		if (Factor)
+		{
+			ispc::DegreeDayRedistributed(Depth, Factor, Num, Accumulation, Melt);
+		}
+		else
+		{
+			ispc::DegreeDayUniform(Depth, Num, Accumulation, Melt);
+		}
+#endif
+	}
+	else
+	{
+		RunVector(Depth, Factor, Num, Accumulation, Melt);
+	}
+}
+
+void FDegreeDayKernel::RunVector(float* Depth, const float* Factor, int32 Num, float Accumulation, float Melt)
+{
+	const VectorRegister4Float VAccumulation = VectorSetFloat1(Accumulation);
+	const VectorRegister4Float VMelt = VectorSetFloat1(Melt);
+	const VectorRegister4Float VZero = VectorZeroFloat();
+
+	// Multiply and add are kept separate (no FMA) so the vector path rounds exactly like the scalar reference
+	int32 i = 0;
+	if (Factor)
+	{
+		for (; i + 4 <= Num; i += 4)
+		{
+			VectorRegister4Float H = VectorLoad(Depth + i);
+			H = VectorAdd(H, VectorMultiply(VAccumulation, VectorLoad(Factor + i)));
+			H = VectorMax(VectorSubtract(H, VMelt), VZero);
+			VectorStore(H, Depth + i);
+		}
+	}
+	else
+	{
+		for (; i + 4 <= Num; i += 4)
+		{
+			VectorRegister4Float H = VectorLoad(Depth + i);
+			H = VectorMax(VectorSubtract(VectorAdd(H, VAccumulation), VMelt), VZero);
+			VectorStore(H, Depth + i);
+		}
+	}
+
+	// Remainder
+	RunScalar(Depth + i, Factor ? Factor + i : nullptr, Num - i, Accumulation, Melt);
+}
+
+void FDegreeDayKernel::RunScalar(float* Depth, const float* Factor, int32 Num, float Accumulation, float Melt)
+{
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const float Added = Factor ? Accumulation * Factor[i] : Accumulation;
+		Depth[i] = FMath::Max(0.0f, (Depth[i] + Added) - Melt);
+	}
+}
+
+void FDegreeDayKernel::AgeSnow(float* Age, float* Albedo, const float* Depth, const float* Factor, int32 Num, float Accumulation, float Days, float DecayRate)
+{
+	for (int32 i = 0; i < Num; ++i)
+	{
+		if (Depth[i] > 0.0f)
+		{
+			const bool bSnowfall = Accumulation > 0.0f && (!Factor || Factor[i] > 0.0f);
+			Age[i] = (bSnowfall ? 0.0f : Age[i]) + Days;
+			Albedo[i] = 0.4f * (1.0f + FMath::Exp(-DecayRate * Age[i]));
+		}
+	}
+}
+
+void FDegreeDayKernel::RunField(float* Depth, const float* Factor, const float* Accumulation, const float* Melt, int32 Num)
+{
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const float Added = Factor ? Accumulation[i] * Factor[i] : Accumulation[i];
+		Depth[i] = FMath::Max(0.0f, (Depth[i] + Added) - Melt[i]);
+	}
+}
+
+void FDegreeDayKernel::AgeSnowField(float* Age, float* Albedo, const float* Depth, const float* Factor, const float* Accumulation, int32 Num, float Days, float DecayRate)
+{
+	for (int32 i = 0; i < Num; ++i)
+	{
+		if (Depth[i] > 0.0f)
+		{
+			const bool bSnowfall = Accumulation[i] > 0.0f && (!Factor || Factor[i] > 0.0f);
+			Age[i] = (bSnowfall ? 0.0f : Age[i]) + Days;
+			Albedo[i] = 0.4f * (1.0f + FMath::Exp(-DecayRate * Age[i]));
+		}
+	}
+}
+
+void FDegreeDayKernel::AgeSnowActive(float* Age, float* Albedo, const int32* Cells, int32 Num, float Days, float DecayRate)
+{
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const int32 Index = Cells[i];
+		Age[Index] += Days;
+		Albedo[Index] = 0.4f * (1.0f + FMath::Exp(-DecayRate * Age[Index]));
+	}
+}
+
+void FDegreeDayKernel::MeltActive(float* Depth, const int32* Cells, int32 Num, float Melt)
+{
+	for (int32 i = 0; i < Num; ++i)
+	{
+		float& H = Depth[Cells[i]];
+		H = FMath::Max(0.0f, H - Melt);
+	}
+}
+
+bool FDegreeDayKernel::IsISPCEnabled()
+{
+	return bSnow_DegreeDay_ISPC_Enabled;
+}
+
+bool FDegreeDayKernel::IsValidationEnabled()
+{
+	return bSnow_DegreeDay_ValidateKernel;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+* Vectorized per-cell accumulation and melt of the degree-day simulation:
+*
+*	Depth[i] = max(0, (Depth[i] + Accumulation * Factor[i]) - Melt)
+*
+* Factor is the precomputed terrain redistribution factor of each cell or nullptr for uniform accumulation.
+* Run dispatches to the ISPC kernel (compiled for every ISPC target of the platform, the matching one is picked at
+* runtime) when available and enabled via snow.Sim.DegreeDay.ISPC, otherwise to the VectorRegister4Float version.
+* RunScalar is the plain reference used for validation (snow.Sim.DegreeDay.ValidateKernel).
+*/
+struct SIMULATION_API FDegreeDayKernel
+{
+	/** Applies the kernel to Num consecutive cells using the fastest available implementation. */
+	static void Run(float* Depth, const float* Factor, int32 Num, float Accumulation, float Melt);
+
+	/** SIMD implementation on VectorRegister4Float, four cells per instruction. */
+	static void RunVector(float* Depth, const float* Factor, int32 Num, float Accumulation, float Melt);
+
+	/** Scalar reference implementation. */
+	static void RunScalar(float* Depth, const float* Factor, int32 Num, float Accumulation, float Melt);
+
+	/**
+	* Ages the snow cover of Num cells by Days. Cells receiving snow (Accumulation > 0 and a positive Factor) restart at
+	* age 0, snow covered cells age and get the decayed albedo 0.4 * (1 + exp(-DecayRate * Age)). Snow free cells keep
+	* their age, it restarts with their next snowfall. Aging is linear in time, so a span of quiescent steps is a single
+	* call with the summed Days.
+	*/
+	static void AgeSnow(float* Age, float* Albedo, const float* Depth, const float* Factor, int32 Num, float Accumulation, float Days, float DecayRate);
+
+	/** Ages the Num snow covered cells listed in Cells by Days without snowfall, see AgeSnow. */
+	static void AgeSnowActive(float* Age, float* Albedo, const int32* Cells, int32 Num, float Days, float DecayRate);
+
+	/** Scalar kernel with per-cell Accumulation and Melt, for forcing that varies over the grid. */
+	static void RunField(float* Depth, const float* Factor, const float* Accumulation, const float* Melt, int32 Num);
+
+	/** AgeSnow with per-cell Accumulation, see RunField. */
+	static void AgeSnowField(float* Age, float* Albedo, const float* Depth, const float* Factor, const float* Accumulation, int32 Num, float Days, float DecayRate);
+
+	/** Applies the melt to the Num cells listed in Cells, the sparse counterpart of Run for steps without snowfall. */
+	static void MeltActive(float* Depth, const int32* Cells, int32 Num, float Melt);
+
+	/** Returns true if Run uses the ISPC kernel. */
+	static bool IsISPCEnabled();
+
+	/** Returns true if callers should check Run against RunScalar. */
+	static bool IsValidationEnabled();
+
+	/** Computes the terrain redistribution factor (1 - f(slope)) * (1 + 50 * curvature) for a cell. */
+	static FORCEINLINE float RedistributionFactor(float SlopeRadians, float Curvature)
+	{
+		// Using f = 0 for slope<15°, else slope/65 as in CPU sim; a3=50
+		constexpr float SlopeThresholdDeg = 15.0f;
+		constexpr float SlopeScale = 65.0f;
+		constexpr float A3 = 50.0f;
+		const float SlopeDeg = FMath::RadiansToDegrees(SlopeRadians);
+		const float F = (SlopeDeg < SlopeThresholdDeg) ? 0.0f : (SlopeDeg / SlopeScale);
+		return FMath::Max(0.0f, (1.0f - F) * (1.0f + A3 * Curvature));
+	}
+};
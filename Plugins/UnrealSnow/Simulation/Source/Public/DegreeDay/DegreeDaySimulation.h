@@ -4,6 +4,7 @@
 #pragma once
 
 #include "SnowSimulation.h"
+#include "DegreeDayKernel.h"
 #include "DegreeDaySimulation.generated.h"
 
 
@@ -21,6 +22,7 @@ public:
 	virtual void Initialize_Implementation(int32 GX, int32 GY, float CellM) override
 	{
 		Super::Initialize_Implementation(GX, GY, CellM);
+		PendingAgeDays = 0.0f;
 	}
 	/** Slope threshold for the snow deposition of the cells in degrees.*/
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation")
@@ -50,6 +52,36 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation", DisplayName = "k_m")
 	float k_m = 4;
 
+	// Precompute the per-cell redistribution factor so the step kernel is a branch-free multiply-add
+	virtual void SetTerrainMetadata(const TSharedPtr<FSnowCellField>& InCellField) override
+	{
+		Super::SetTerrainMetadata(InCellField);
+
+		RedistributionFactor.Reset();
+		if (bHasTerrainMetadata)
+		{
+			RedistributionFactor.SetNumUninitialized(CellField->Num());
+			EnsureTilesFor(DepthMeters);
+			const float* Slope = CellField->Slope.GetData();
+			const float* Curvature = CellField->Curvature.GetData();
+			float* Factor = RedistributionFactor.GetData();
+			const FSnowCellField* Cells = CellField.Get();
+			ForEachCell([Factor, Slope, Curvature, Cells](int32 i)
+			{
+				// Holes never receive snow, so they never enter the active cells either
+				Factor[i] = Cells->IsHole(i) ? 0.0f : FDegreeDayKernel::RedistributionFactor(Slope[i], Curvature[i]);
+			});
+		}
+		ActiveCells.Invalidate();
+		PendingAgeDays = 0.0f;
+	}
+
+	virtual void ResolveCellState() override
+	{
+		ApplyPendingAging(DepthMeters);
+		ResolveAdaptiveCells(DepthMeters);
+	}
+
 	// Per-step accumulation + simple degree-day melt on OutDepthMeters (meters)
 	virtual void Step(float DtSeconds, const FWeatherForcingData& W, TArray<float>& OutDepthMeters) override
 	{
@@ -58,59 +90,440 @@ public:
 			return;
 		}
 
-		// 1) Accumulation from precipitation (kg/m^2/s → m/s via density)
-		const float precip_kg_m2_s = FMath::Max(0.0f, W.PrecipRate_kgm2s);
-		const float snowfrac = FMath::Clamp(W.SnowFrac_01, 0.0f, 1.0f);
-		// Convert water-equivalent mass flux to snow depth using configurable density
-		const float rho_snow = (FreshSnowDensity_kgm3 > 1.0f) ? FreshSnowDensity_kgm3 : 100.0f; // kg/m^3
-		float dH_acc = (rho_snow > 1e-6f) ? (precip_kg_m2_s * snowfrac / rho_snow) * DtSeconds : 0.0f;
-		
-		// 2) Simple degree-day melt when air temperature > 0°C
-		const float Tair_C = W.Temperature_K - 273.15f;
-		float melt_m = 0.0f;
-		if (Tair_C > 0.0f)
+		if (HasSpatialForcing())
 		{
-			const float DDF_m_per_C_day = 0.004f; // m/°C/day (tunable)
-			melt_m = DDF_m_per_C_day * Tair_C * (DtSeconds / 86400.0f);
+			ApplyPendingAging(OutDepthMeters);
+			ResolveAdaptiveCells(OutDepthMeters);
+			StepField(DtSeconds, W.Timestamp, OutDepthMeters);
+			return;
 		}
 
+		// 1) Accumulation from precipitation and 2) simple degree-day melt when air temperature > 0°C
+		float dH_acc = 0.0f;
+		float melt_m = 0.0f;
+		ComputeRates(DtSeconds, W, dH_acc, melt_m);
+
 		// Convert precipitation water equivalent during the step to mm for logging (1 kg/m² = 1 mm)
-		const float PrecipWE_mm = precip_kg_m2_s * DtSeconds; // kg/m²/s * s = kg/m² = mm
+		const float PrecipWE_mm = FMath::Max(0.0f, W.PrecipRate_kgm2s) * DtSeconds; // kg/m²/s * s = kg/m² = mm
 		const float DeltaSnow_mm = (dH_acc - melt_m) * 1000.0f; // meters to mm
 
 		// Log each simulation step using depth units
 		UE_LOG(LogTemp, Verbose, TEXT("[Snow] t=%s, dts=%.0f, precipWE=%.2f mm, SnowFrac=%.2f -> dS=%.2f mm"),
-			*W.Timestamp.ToString(), DtSeconds, PrecipWE_mm, snowfrac, DeltaSnow_mm);
+			*W.Timestamp.ToString(), DtSeconds, PrecipWE_mm, FMath::Clamp(W.SnowFrac_01, 0.0f, 1.0f), DeltaSnow_mm);
 
-		if (dH_acc > 0.0f)
+		const float Days = DtSeconds / 86400.0f;
+		if (dH_acc <= 0.0f && melt_m <= 0.0f)
 		{
-			// 3) Terrain redistribution (Blöschl-inspired): reduce on steep slopes, increase with curvature
-			if (bHasTerrainMetadata && TerrainSlopeDegrees.Num() == OutDepthMeters.Num() && TerrainCurvature.Num() == OutDepthMeters.Num())
+			// Depth is unchanged, only the snow cover ages, in a single pass once the dry span ends
+			DeferAging(OutDepthMeters, Days);
+			return;
+		}
+		ApplyPendingAging(OutDepthMeters);
+
+		if (UsesAdaptiveGrid(OutDepthMeters))
+		{
+			StepAdaptive(OutDepthMeters, dH_acc, melt_m, Days);
+			return;
+		}
+
+		// The cells are stepped directly, the super-cells are rebuilt if the adaptive grid is used again
+		ResolveAdaptiveCells(OutDepthMeters);
+		AdaptiveGrid.Invalidate();
+
+		// 3) Terrain redistribution (Blöschl-inspired): reduce on steep slopes, increase with curvature.
+		// The per-cell factor (1 - f(slope)) * (1 + a3 * curvature) is precomputed in SetTerrainMetadata.
+		const float* Factor = (dH_acc > 0.0f && bHasTerrainMetadata && RedistributionFactor.Num() == OutDepthMeters.Num())
+			? RedistributionFactor.GetData() : nullptr;
+
+		TArray<float> Reference;
+		if (FDegreeDayKernel::IsValidationEnabled())
+		{
+			Reference = OutDepthMeters;
+			FDegreeDayKernel::RunScalar(Reference.GetData(), Factor, Reference.Num(), dH_acc, melt_m);
+		}
+
+		// Vectorized accumulation + melt, one kernel call per tile row, statistics reduced while the row is in cache.
+		// Melt-only steps visit just the active cells of tiles where few cells hold snow.
+		EnsureActiveCells(OutDepthMeters);
+		float* Depth = OutDepthMeters.GetData();
+		const int32 Stride = Tiles.GridX;
+		float* Age = HasCellState(OutDepthMeters) ? CellField->Age.GetData() : nullptr;
+		float* Albedo = Age ? CellField->Albedo.GetData() : nullptr;
+		SetStepStats(ReduceTiles(FSnowStepStats(), [this, Depth, Factor, Age, Albedo, Stride, dH_acc, melt_m, Days](const FSnowTile& Tile)
+		{
+			const int32 NumActive = ActiveCells.NumTileCells(Tile.Index);
+			if (dH_acc <= 0.0f)
 			{
-				// Compute per-cell factor: (1 - f(slope)) * (1 + a3 * curvature)
-				// Using f = 0 for slope<15°, else slope/65 as in CPU sim; a3=50
-				constexpr float SlopeThresholdDeg = 15.0f;
-				constexpr float SlopeScale = 65.0f;
-				constexpr float A3 = 50.0f;
-				for (int32 i = 0; i < OutDepthMeters.Num(); ++i)
+				// Melt alone cannot change a tile without snow, leave it clean so it is not uploaded
+				if (NumActive == 0)
 				{
-					const float slopeDeg = TerrainSlopeDegrees[i];
-					const float f = (slopeDeg < SlopeThresholdDeg) ? 0.0f : (slopeDeg / SlopeScale);
-					const float factor = FMath::Max(0.0f, (1.0f - f) * (1.0f + A3 * TerrainCurvature[i]));
-					OutDepthMeters[i] += dH_acc * factor;
+					return FSnowStepStats::SnowFree(Tile.Num());
 				}
+
+				if (NumActive * SparseTileRatio < Tile.Num())
+				{
+					SnowStats::AddCellsStepped(NumActive);
+					return MeltActiveTile(Tile, Depth, Age, Albedo, melt_m, Days);
+				}
+			}
+
+			SnowStats::AddCellsStepped(Tile.Num());
+			FSnowStepStats TileStats;
+			for (int32 Y = Tile.Y0; Y < Tile.Y1; ++Y)
+			{
+				const int32 RowStart = Y * Stride + Tile.X0;
+				FDegreeDayKernel::Run(Depth + RowStart, Factor ? Factor + RowStart : nullptr, Tile.Width(), dH_acc, melt_m);
+				TileStats.AccumulateRow(Depth + RowStart, Tile.Width());
+			}
+			if (Age)
+			{
+				AgeTile(Age, Albedo, Depth, Factor, Stride, Tile, dH_acc, Days, k_e);
 			}
-			else
+			ActiveCells.RebuildTile(Tiles, Tile, Depth);
+			MarkTileDirty(Tile);
+			return TileStats;
+		}, &FSnowStepStats::Combine));
+
+		if (Reference.Num() > 0)
+		{
+			float MaxError = 0.0f;
+			for (int32 i = 0; i < Reference.Num(); ++i)
 			{
-				for (float& h : OutDepthMeters) { h += dH_acc; }
+				MaxError = FMath::Max(MaxError, FMath::Abs(Reference[i] - OutDepthMeters[i]));
 			}
+			UE_LOG(LogTemp, Display, TEXT("[Snow] Degree-day kernel (%s) vs scalar reference: max abs error %g m over %d cells"),
+				FDegreeDayKernel::IsISPCEnabled() ? TEXT("ISPC") : TEXT("SIMD"), MaxError, Reference.Num());
 		}
+	}
 
-		if (melt_m > 0.0f)
+	// Dry steps without melt leave the depth untouched, a single sample cannot tell for spatially varying forcing
+	virtual bool IsQuiescent(const FWeatherForcingData& W) const override
+	{
+		if (HasSpatialForcing())
 		{
-			for (float& h : OutDepthMeters) { h = FMath::Max(0.0f, h - melt_m); }
+			return false;
 		}
+
+		float dH_acc = 0.0f;
+		float melt_m = 0.0f;
+		ComputeRates(1.0f, W, dH_acc, melt_m);
+		return dH_acc <= 0.0f && melt_m <= 0.0f;
 	}
 
-};
+	// A quiescent span only ages the snow cover, which is linear in time, so it only adds to the deferred aging
+	virtual void FastForward(float DtSeconds, int32 NumSteps, const FWeatherForcingData& W, TArray<float>& OutDepthMeters) override
+	{
+		if (!IsQuiescent(W) || OutDepthMeters.Num() == 0 || DtSeconds <= 0.0f)
+		{
+			Super::FastForward(DtSeconds, NumSteps, W, OutDepthMeters);
+			return;
+		}
+
+		UE_LOG(LogTemp, Verbose, TEXT("[Snow] t=%s, fast-forwarding %d quiescent steps of %.0fs"), *W.Timestamp.ToString(), NumSteps, DtSeconds);
+		DeferAging(OutDepthMeters, NumSteps * DtSeconds / 86400.0f);
+	}
+
+protected:
+	/** Per-cell terrain redistribution factor aligned with CellField, empty without terrain metadata. */
+	FSnowCellColumn RedistributionFactor;
+
+	/** Scratch of StepField: the forcing field of every tile converted to accumulation and melt, TileSize² values per tile. */
+	FSnowCellColumn FieldAccumulation;
+	FSnowCellColumn FieldMelt;
+	FSnowCellColumn FieldSnowFrac;
+
+	/**
+	* Days of dry steps the snow covered cells have not been aged by yet. The snow cover cannot change during a dry
+	* span and the albedo only depends on the final age, so the whole span is one aging pass, see ApplyPendingAging.
+	*/
+	float PendingAgeDays = 0.0f;
+
+	/** Adds Days without snowfall to the deferred aging. */
+	void DeferAging(const TArray<float>& Depth, float Days)
+	{
+		if (HasCellState(Depth) && Days > 0.0f)
+		{
+			PendingAgeDays += Days;
+		}
+	}
+
+	/** Ages the snow cover by the deferred dry days, before anything changes the depth or reads the cell state. */
+	void ApplyPendingAging(TArray<float>& Depth)
+	{
+		if (PendingAgeDays > 0.0f)
+		{
+			const float Days = PendingAgeDays;
+			PendingAgeDays = 0.0f;
+			AgeSnowCover(Depth, Days);
+		}
+	}
+
+	/** Snow depth accumulated from precipitation and melted by the degree-day model over DtSeconds, in meters. */
+	void ComputeRates(float DtSeconds, const FWeatherForcingData& W, float& OutAccumulation, float& OutMelt) const
+	{
+		ComputeRates(DtSeconds, W.Temperature_K, W.PrecipRate_kgm2s, W.SnowFrac_01, OutAccumulation, OutMelt);
+	}
+
+	void ComputeRates(float DtSeconds, float Temperature_K, float PrecipRate_kgm2s, float SnowFrac_01, float& OutAccumulation, float& OutMelt) const
+	{
+		// Accumulation from precipitation (kg/m^2/s → m/s via density)
+		const float precip_kg_m2_s = FMath::Max(0.0f, PrecipRate_kgm2s);
+		const float snowfrac = FMath::Clamp(SnowFrac_01, 0.0f, 1.0f);
+		// Convert water-equivalent mass flux to snow depth using configurable density
+		const float rho_snow = (FreshSnowDensity_kgm3 > 1.0f) ? FreshSnowDensity_kgm3 : 100.0f; // kg/m^3
+		OutAccumulation = (rho_snow > 1e-6f) ? (precip_kg_m2_s * snowfrac / rho_snow) * DtSeconds : 0.0f;
+
+		// Simple degree-day melt when air temperature > 0°C
+		const float Tair_C = Temperature_K - 273.15f;
+		OutMelt = 0.0f;
+		if (Tair_C > 0.0f)
+		{
+			const float DDF_m_per_C_day = 0.004f; // m/°C/day (tunable)
+			OutMelt = DDF_m_per_C_day * Tair_C * (DtSeconds / 86400.0f);
+		}
+	}
+
+	/**
+	* Step under the forcing of ForcingFieldProvider at Time: every tile fills its forcing field and runs the kernel with
+	* per-cell rates. Always runs on the full grid, so the super-cells are rebuilt before the next adaptive step.
+	*/
+	void StepField(float DtSeconds, const FDateTime& Time, TArray<float>& OutDepthMeters)
+	{
+		EnsureActiveCells(OutDepthMeters);
+
+		// Only resized when the tile layout changes, the steps reuse the scratch
+		const int32 ScratchPerTile = Tiles.TileSize * Tiles.TileSize;
+		for (FSnowCellColumn* Column : { &FieldAccumulation, &FieldMelt, &FieldSnowFrac })
+		{
+			if (Column->Num() != Tiles.NumTiles() * ScratchPerTile)
+			{
+				Column->SetNumUninitialized(Tiles.NumTiles() * ScratchPerTile, EAllowShrinking::No);
+			}
+		}
+
+		float* Depth = OutDepthMeters.GetData();
+		const int32 Stride = Tiles.GridX;
+		const float* Factor = (bHasTerrainMetadata && RedistributionFactor.Num() == OutDepthMeters.Num()) ? RedistributionFactor.GetData() : nullptr;
+		float* Age = HasCellState(OutDepthMeters) ? CellField->Age.GetData() : nullptr;
+		float* Albedo = Age ? CellField->Albedo.GetData() : nullptr;
+		const float Days = DtSeconds / 86400.0f;
+		USimulationWeatherDataProviderBase* Provider = ForcingFieldProvider;
+		const FIntPoint Origin = ForcingFieldOrigin;
+		Provider->PrepareForcingField(Time);
+		SetStepStats(ReduceTiles(FSnowStepStats(), [this, Provider, Origin, Time, Depth, Factor, Age, Albedo, Stride, DtSeconds, Days, ScratchPerTile](const FSnowTile& Tile)
+		{
+			// The forcing columns are converted in place to the accumulation and melt of every cell
+			const int32 Num = Tile.Num();
+			float* Accumulation = FieldAccumulation.GetData() + Tile.Index * ScratchPerTile;
+			float* Melt = FieldMelt.GetData() + Tile.Index * ScratchPerTile;
+			float* SnowFrac = FieldSnowFrac.GetData() + Tile.Index * ScratchPerTile;
+			FWeatherForcingField Field;
+			Field.Temperature_K = Melt;
+			Field.PrecipRate_kgm2s = Accumulation;
+			Field.SnowFrac_01 = SnowFrac;
+			Provider->FillForcingField(Time, FIntRect(Origin.X + Tile.X0, Origin.Y + Tile.Y0, Origin.X + Tile.X1, Origin.Y + Tile.Y1), Field);
+			for (int32 i = 0; i < Num; ++i)
+			{
+				ComputeRates(DtSeconds, Melt[i], Accumulation[i], SnowFrac[i], Accumulation[i], Melt[i]);
+			}
+
+			SnowStats::AddCellsStepped(Num);
+			FSnowStepStats TileStats;
+			for (int32 Y = Tile.Y0; Y < Tile.Y1; ++Y)
+			{
+				const int32 RowStart = Y * Stride + Tile.X0;
+				const int32 FieldRow = (Y - Tile.Y0) * Tile.Width();
+				FDegreeDayKernel::RunField(Depth + RowStart, Factor ? Factor + RowStart : nullptr, Accumulation + FieldRow, Melt + FieldRow, Tile.Width());
+				if (Age)
+				{
+					FDegreeDayKernel::AgeSnowField(Age + RowStart, Albedo + RowStart, Depth + RowStart, Factor ? Factor + RowStart : nullptr, Accumulation + FieldRow, Tile.Width(), Days, k_e);
+				}
+				TileStats.AccumulateRow(Depth + RowStart, Tile.Width());
+			}
+			ActiveCells.RebuildTile(Tiles, Tile, Depth);
+			MarkTileDirty(Tile);
+			return TileStats;
+		}, &FSnowStepStats::Combine));
+
+		AdaptiveGrid.Invalidate();
+	}
+
+	/** Returns true if the cell field holds age and albedo columns aligned with Depth. */
+	bool HasCellState(const TArray<float>& Depth) const
+	{
+		return bHasTerrainMetadata && CellField->Age.Num() == Depth.Num() && CellField->Albedo.Num() == Depth.Num();
+	}
+
+	/** Returns true if Step runs on the super-cells of the adaptive grid, which needs the redistribution factor of every cell. */
+	bool UsesAdaptiveGrid(const TArray<float>& Depth) const
+	{
+		return bAdaptiveGrid && bHasTerrainMetadata && RedistributionFactor.Num() == Depth.Num() && Depth.Num() == GridX * GridY;
+	}
+
+	/** Writes the super-cells that changed since they were last written back to the cells of Depth and the cell field. */
+	void ResolveAdaptiveCells(TArray<float>& Depth)
+	{
+		if (Depth.Num() != Tiles.GridX * Tiles.GridY)
+		{
+			return;
+		}
+
+		float* Age = HasCellState(Depth) ? CellField->Age.GetData() : nullptr;
+		float* Albedo = Age ? CellField->Albedo.GetData() : nullptr;
+		AdaptiveGrid.ScatterPending(Tiles, Depth.GetData(), Age, Albedo);
+	}
+
+	/** Makes sure AdaptiveGrid holds the super-cells of Depth for the current tolerances. */
+	void EnsureAdaptiveGrid(TArray<float>& Depth)
+	{
+		EnsureTilesFor(Depth);
+		const FSnowAdaptiveTolerances Tolerances = GetAdaptiveTolerances();
+		if (!AdaptiveGrid.IsValidFor(Tiles, Tolerances))
+		{
+			// Super-cells built for other tolerances still hold changes their cells have not received
+			ResolveAdaptiveCells(Depth);
+			AdaptiveGrid.Build(Tiles, *CellField, RedistributionFactor.GetData(), Depth.GetData(), Tolerances);
+			AdaptiveStepsSinceRebuild = 0;
+		}
+	}
+
+	/**
+	* Step on the adaptive grid: the kernel runs once per super-cell and the cells receive the changes only when a tile is
+	* rebuilt or the cell state is resolved, see ResolveAdaptiveCells. Tiles with a super-cell whose cells may have
+	* diverged beyond the depth tolerance are rebuilt, and every AdaptiveRebuildInterval steps all tiles are rebuilt so
+	* uniform blocks merge again.
+	*/
+	void StepAdaptive(TArray<float>& OutDepthMeters, float Accumulation, float Melt, float Days)
+	{
+		EnsureAdaptiveGrid(OutDepthMeters);
+		const bool bRebuildAll = AdaptiveRebuildInterval > 0 && ++AdaptiveStepsSinceRebuild >= AdaptiveRebuildInterval;
+		if (bRebuildAll)
+		{
+			AdaptiveStepsSinceRebuild = 0;
+		}
+
+		float* Depth = OutDepthMeters.GetData();
+		const int32 Stride = Tiles.GridX;
+		float* Age = HasCellState(OutDepthMeters) ? CellField->Age.GetData() : nullptr;
+		float* Albedo = Age ? CellField->Albedo.GetData() : nullptr;
+		const float* Factor = RedistributionFactor.GetData();
+		SetStepStats(ReduceTiles(FSnowStepStats(), [this, Depth, Age, Albedo, Factor, Stride, Accumulation, Melt, Days, bRebuildAll](const FSnowTile& Tile)
+		{
+			FSnowAdaptiveLeaves& Leaves = AdaptiveGrid.GetTileLeaves(Tile.Index);
+			const int32 NumLeaves = Leaves.Num();
+			SnowStats::AddCellsStepped(NumLeaves);
+			FDegreeDayKernel::Run(Leaves.Depth.GetData(), Leaves.Factor.GetData(), NumLeaves, Accumulation, Melt);
+			if (Age)
+			{
+				FDegreeDayKernel::AgeSnow(Leaves.Age.GetData(), Leaves.Albedo.GetData(), Leaves.Depth.GetData(), Leaves.Factor.GetData(), NumLeaves, Accumulation, Days, k_e);
+			}
 
+			FSnowStepStats TileStats;
+			bool bChanged = false;
+			bool bRefine = bRebuildAll;
+			for (int32 Leaf = 0; Leaf < NumLeaves; ++Leaf)
+			{
+				const FSnowTile& Block = Leaves.Blocks[Leaf];
+				bChanged |= FSnowAdaptiveGrid::HasDepthChanged(Leaves, Leaf);
+				Leaves.Accumulated[Leaf] += Accumulation;
+				bRefine |= AdaptiveGrid.NeedsRefinement(Leaves, Leaf);
+				TileStats.AccumulateUniform(Leaves.Depth[Leaf], Block.Num());
+			}
+
+			// The tile is marked dirty now, so everything that consumes dirty tiles resolves the cell state first
+			Leaves.bPendingScatter |= bChanged || Age != nullptr;
+			if (bRefine)
+			{
+				// Rebuilding writes the per-cell snowfall differences, so the statistics are taken from the cells
+				AdaptiveGrid.ScatterTile(Tile, Stride, Depth, Age, Albedo);
+				AdaptiveGrid.RebuildTile(Tiles, Tile, *CellField, Factor, Depth);
+				TileStats = ComputeTileStats(Depth, Stride, Tile);
+				bChanged = true;
+			}
+			if (bChanged)
+			{
+				MarkTileDirty(Tile);
+			}
+			return TileStats;
+		}, &FSnowStepStats::Combine));
+
+		// The active cells are not maintained on the adaptive grid
+		ActiveCells.Invalidate();
+	}
+
+	/** Ages the snow covered super-cells by Days without snowfall, their cells receive age and albedo when resolved. */
+	void AgeAdaptive(TArray<float>& Depth, float Days)
+	{
+		EnsureAdaptiveGrid(Depth);
+		ForEachTile([this, Days](const FSnowTile& Tile)
+		{
+			FSnowAdaptiveLeaves& Leaves = AdaptiveGrid.GetTileLeaves(Tile.Index);
+			SnowStats::AddCellsStepped(Leaves.Num());
+			FDegreeDayKernel::AgeSnow(Leaves.Age.GetData(), Leaves.Albedo.GetData(), Leaves.Depth.GetData(), nullptr, Leaves.Num(), 0.0f, Days, k_e);
+			Leaves.bPendingScatter = true;
+		});
+	}
+
+	/** A melt-only step visits the active cell list of a tile instead of its rows when fewer than 1 / SparseTileRatio of its cells hold snow. */
+	static constexpr int32 SparseTileRatio = 4;
+
+	/** Melts and ages the active cells of Tile, drops the ones that became snow free and returns the tile statistics. */
+	FSnowStepStats MeltActiveTile(const FSnowTile& Tile, float* Depth, float* Age, float* Albedo, float Melt, float Days)
+	{
+		TArrayView<int32> Cells = ActiveCells.GetTileCells(Tile.Index);
+		FDegreeDayKernel::MeltActive(Depth, Cells.GetData(), Cells.Num(), Melt);
+		ActiveCells.CompactTile(Tile, Depth);
+
+		Cells = ActiveCells.GetTileCells(Tile.Index);
+		if (Age)
+		{
+			FDegreeDayKernel::AgeSnowActive(Age, Albedo, Cells.GetData(), Cells.Num(), Days, k_e);
+		}
+
+		// Cells outside the list are snow free
+		FSnowStepStats ActiveStats;
+		ActiveStats.AccumulateCells(Depth, Cells.GetData(), Cells.Num());
+		MarkTileDirty(Tile);
+		return FSnowStepStats::Combine(FSnowStepStats::SnowFree(Tile.Num() - Cells.Num()), ActiveStats);
+	}
+
+	/** Ages the snow covered cells by Days without snowfall, the depth and therefore the dirty tiles and statistics are unchanged. */
+	void AgeSnowCover(TArray<float>& Depth, float Days)
+	{
+		if (!HasCellState(Depth) || Days <= 0.0f)
+		{
+			return;
+		}
+
+		if (UsesAdaptiveGrid(Depth))
+		{
+			AgeAdaptive(Depth, Days);
+			return;
+		}
+
+		ResolveAdaptiveCells(Depth);
+		AdaptiveGrid.Invalidate();
+		EnsureActiveCells(Depth);
+		float* Age = CellField->Age.GetData();
+		float* Albedo = CellField->Albedo.GetData();
+		ForEachTile([this, Age, Albedo, Days](const FSnowTile& Tile)
+		{
+			const TArrayView<int32> Cells = ActiveCells.GetTileCells(Tile.Index);
+			SnowStats::AddCellsStepped(Cells.Num());
+			FDegreeDayKernel::AgeSnowActive(Age, Albedo, Cells.GetData(), Cells.Num(), Days, k_e);
+		});
+	}
+
+	/** Runs FDegreeDayKernel::AgeSnow over the rows of Tile. */
+	static void AgeTile(float* Age, float* Albedo, const float* Depth, const float* Factor, int32 Stride, const FSnowTile& Tile, float Accumulation, float Days, float DecayRate)
+	{
+		for (int32 Y = Tile.Y0; Y < Tile.Y1; ++Y)
+		{
+			const int32 RowStart = Y * Stride + Tile.X0;
+			FDegreeDayKernel::AgeSnow(Age + RowStart, Albedo + RowStart, Depth + RowStart, Factor ? Factor + RowStart : nullptr, Tile.Width(), Accumulation, Days, DecayRate);
+		}
+	}
+
+	virtual bool TracksDirtyTiles() const override { return true; }
+	virtual bool CountsSteppedCells() const override { return true; }
+};
@@ -4,6 +4,7 @@
 #include "LandscapeDataAccess.h"
 #include "SnowSimulationActor.h"
 #include "Util/MathUtil.h"
+#include "DegreeDay/SolarRadiation.h"
 #include "LandscapeComponent.h"
 
 FString UDegreeDayGPUSimulation::GetSimulationName() const
@@ -13,7 +14,11 @@ FString UDegreeDayGPUSimulation::GetSimulationName() const
 
 void UDegreeDayGPUSimulation::Simulate(ASnowSimulationActor* SimulationActor, int32 CurrentSimulationStep, int32 Timesteps, bool SaveSnowMap, bool CaptureDebugInformation, TArray<FDebugCell>& DebugCells)
 {
-	SimulationComputeShader->ExecuteComputeShader(CurrentSimulationStep, Timesteps, SimulationActor->CurrentSimulationTime.GetHour(), CaptureDebugInformation, DebugCells);
+	// The day-of-year radiation terms are identical for every cell, evaluate them once on the CPU
+	const int32 DayOfYear = SimulationActor->CurrentSimulationTime.GetDayOfYear();
+	const FSolarDayTerms SolarDay = FSolarRadiation::ComputeDayTerms(CellField.IsValid() ? CellField->Latitude : 0.0f, DayOfYear);
+
+	SimulationComputeShader->ExecuteComputeShader(CurrentSimulationStep, Timesteps, SimulationActor->CurrentSimulationTime.GetHour(), DayOfYear, SolarDay, CaptureDebugInformation, DebugCells);
 	SimulationPixelShader->ExecutePixelShader(RenderTarget, SaveSnowMap);
 
 	// Log snow depth statistics
@@ -24,18 +29,22 @@ void UDegreeDayGPUSimulation::Simulate(ASnowSimulationActor* SimulationActor, in
 	}
 }
 
-void UDegreeDayGPUSimulation::Initialize(ASnowSimulationActor* SimulationActor, const TArray<FLandscapeCell>& LandscapeCells, float InitialMaxSnow, UWorld* World)
+void UDegreeDayGPUSimulation::Initialize(ASnowSimulationActor* SimulationActor, const TSharedPtr<FSnowCellField>& LandscapeCells, float InitialMaxSnow, UWorld* World)
 {
 	// Create shader
 	SimulationComputeShader = new FSimulationComputeShader(World->Scene->GetFeatureLevel());
 	SimulationPixelShader = new FSnowPixelShader(World->Scene->GetFeatureLevel());
 
 	// Create Cells
+	CellField = LandscapeCells;
+	const FSnowCellField& Field = *LandscapeCells;
 	TResourceArray<FGPUSimulationCell> Cells;
-	for (const FLandscapeCell& LandscapeCell : LandscapeCells)
+	Cells.Reserve(Field.Num());
+	for (int32 Index = 0; Index < Field.Num(); ++Index)
 	{
-		FGPUSimulationCell Cell(LandscapeCell.Aspect, LandscapeCell.Inclination, LandscapeCell.Altitude, 
-			LandscapeCell.Latitude, LandscapeCell.Area, LandscapeCell.AreaXY, LandscapeCell.InitialWaterEquivalent);
+		FGPUSimulationCell Cell(Field.Aspect[Index], Field.Slope[Index], Field.Altitude[Index], 
+			Field.Latitude, Field.Area[Index], Field.AreaXY[Index], Field.SWE[Index]);
+		Cell.Curvature = Field.Curvature[Index];
 		Cells.Add(Cell);
 	}
 	
@@ -65,11 +74,13 @@ void UDegreeDayGPUSimulation::Initialize(ASnowSimulationActor* SimulationActor,
 		RenderTarget->SizeX, RenderTarget->SizeY);
 	
 	// Initialize shaders
-	auto ClimateData = SimulationActor->ClimateDataComponent->CreateRawClimateDataResourceArray(SimulationActor->StartTime, SimulationActor->EndTime);
+	// The upload needs a resource array, copy the provider's timeline once
+	TResourceArray<FClimateData> ClimateData;
+	ClimateData.Append(SimulationActor->ClimateDataComponent->GetClimateTimeline());
 	auto SimulationTimeSpan = SimulationActor->EndTime - SimulationActor->StartTime;
 	int32 TotalHours = static_cast<int32>(SimulationTimeSpan.GetTotalHours());
 
-	SimulationComputeShader->Initialize(Cells, *ClimateData, k_e, k_m, TMeltA, TMeltB, TSnowA, TSnowB, TotalHours, 
+	SimulationComputeShader->Initialize(Cells, ClimateData, k_e, k_m, TMeltA, TMeltB, TSnowA, TSnowB, TotalHours, 
 		SimulationActor->CellsDimensionX, SimulationActor->CellsDimensionY, SimulationActor->ClimateDataComponent->GetMeasurementAltitude(), InitialMaxSnow);
 
 	SimulationPixelShader->Initialize(SimulationComputeShader->GetSnowBuffer(), SimulationComputeShader->GetMaxSnowBuffer(), SimulationActor->CellsDimensionX, SimulationActor->CellsDimensionY);
@@ -6,7 +6,7 @@
 #include "DegreeDay/DegreeDaySimulation.h"
 #include "SimulationBase.h"
 #include "Cells/DebugCell.h"
-#include "Cells/LandscapeCell.h"
+#include "Cells/SnowCellField.h"
 #include "DegreeDayGPUSimulation.generated.h"
 
 
@@ -32,7 +32,7 @@ public:
 
 	virtual void Simulate(ASnowSimulationActor* SimulationActor, int32 CurrentSimulationStep, int32 Timesteps, bool SaveSnowMap, bool CaptureDebugInformation, TArray<FDebugCell>& DebugCells) override final;
 
-	virtual void Initialize(ASnowSimulationActor* SimulationActor, const TArray<FLandscapeCell>& Cells, float InitialMaxSnow, UWorld* World) override final;
+	virtual void Initialize(ASnowSimulationActor* SimulationActor, const TSharedPtr<FSnowCellField>& Cells, float InitialMaxSnow, UWorld* World) override final;
 
 	// Ensure base grid/texture setup is called for the BN-event initializer
 	virtual void Initialize_Implementation(int32 GX, int32 GY, float CellM) override
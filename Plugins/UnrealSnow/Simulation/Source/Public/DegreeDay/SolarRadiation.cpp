@@ -0,0 +1,194 @@
+#include "SolarRadiation.h"
+#include "Simulation.h"
+#include "SnowSimulationActor.h"
+#include "Async/ParallelFor.h"
+#include <limits>
+
+FSolarDayTerms FSolarRadiation::ComputeDayTerms(float L0, float J)
+{
+	FSolarDayTerms Day;
+	Day.D = 0.007 - 0.4067 * FMath::Cos((J + 10) * 0.0172);
+	Day.SinD = FMath::Sin(Day.D);
+	Day.CosD = FMath::Cos(Day.D);
+	Day.TanD = FMath::Tan(Day.D);
+
+	float E = 1.0 - 0.0167 * FMath::Cos((J - 3) * 0.0172);
+
+	const float R0 = 1.95;
+	Day.R1 = 60 * R0 / (E * E);
+	// float R1 = (PI / 3) * R0 / (E * E);
+
+	Day.T1 = Func2(L0, Day.TanD);
+	Day.R3 = Func3(0.0, L0, Day.T1, -Day.T1, Day);
+	return Day;
+}
+
+FSolarRadiationSample FSolarRadiation::Evaluate(float I, float A, float L0, const FSolarDayTerms& Day)
+{
+	// Rounding can push the argument just past ±1, which would make the table node NaN
+	float L1 = FMath::Asin(FMath::Clamp(FMath::Cos(I) * FMath::Sin(L0) + FMath::Sin(I) * FMath::Cos(L0) * FMath::Cos(A), -1.0f, 1.0f));
+	float L2 = FMath::Atan((FMath::Sin(I) * FMath::Sin(A)) / (FMath::Cos(I) * FMath::Cos(L0) - FMath::Sin(I) * FMath::Sin(L0) * FMath::Cos(A)));
+
+	float T = Func2(L1, Day.TanD);
+	float T7 = T - L2;
+	float T6 = -T - L2;
+	float T1 = Day.T1;
+	float T0 = -Day.T1;
+	float T3 = FMath::Min(T7, T1);
+	float T2 = FMath::Max(T6, T0);
+
+	FSolarRadiationSample Result;
+	Result.Sunrise = T2 * (12 / PI);
+	Result.Sunset = T3 * (12 / PI);
+
+	//float R4 = Func3(L2, L1, T3, T2, Day); // Figure1
+	if (T3 < T2) // Figure2
+	{
+		T2 = T3 = 0;
+	}
+
+	T6 = T6 + PI * 2;
+
+	float R4;
+	if (T6 < T1)
+	{
+		float T8 = T6;
+		float T9 = T1;
+		R4 = Func3(L2, L1, T3, T2, Day) + Func3(L2, L1, T9, T8, Day);
+	}
+	else
+	{
+		T7 = T7 - PI * 2;
+
+		if (T7 > T0)
+		{
+			float T8 = T0;
+			float T9 = T0;
+			R4 = Func3(L2, L1, T3, T2, Day) + Func3(L2, L1, T9, T8, Day);
+		}
+		else
+		{
+			R4 = Func3(L2, L1, T3, T2, Day);
+		}
+	}
+
+	Result.Ri = R4 / Day.R3;
+	return Result;
+}
+
+void FSolarRadiationTable::Build(float InLatitude, float InclinationStepDeg, float AspectStepDeg)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	Latitude = InLatitude;
+
+	// Round the spacing down so the nodes end exactly at 90° and 360°
+	NumInclination = FMath::CeilToInt(90.0f / FMath::Clamp(InclinationStepDeg, 0.1f, 45.0f)) + 1;
+	NumAspect = FMath::CeilToInt(360.0f / FMath::Clamp(AspectStepDeg, 0.1f, 90.0f)) + 1;
+	const float InclinationStep = (PI / 2) / (NumInclination - 1);
+	const float AspectStep = (PI * 2) / (NumAspect - 1);
+	InvInclinationStep = 1.0f / InclinationStep;
+	InvAspectStep = 1.0f / AspectStep;
+
+	Days.SetNumUninitialized(NumDays);
+	Samples.SetNumUninitialized(NumDays * NumInclination * NumAspect);
+
+	ParallelFor(NumDays, [this, InclinationStep, AspectStep](int32 DayIndex)
+	{
+		const FSolarDayTerms Day = FSolarRadiation::ComputeDayTerms(Latitude, FMath::Max(DayIndex, 1));
+		Days[DayIndex] = Day;
+
+		FSolarRadiationSample* DaySamples = &Samples[DayIndex * NumInclination * NumAspect];
+		for (int32 InclinationNode = 0; InclinationNode < NumInclination; ++InclinationNode)
+		{
+			const float I = FMath::Min(InclinationNode * InclinationStep, PI / 2);
+			for (int32 AspectNode = 0; AspectNode < NumAspect; ++AspectNode)
+			{
+				const float A = (AspectNode == NumAspect - 1) ? 0.0f : AspectNode * AspectStep;
+				DaySamples[InclinationNode * NumAspect + AspectNode] = FSolarRadiation::Evaluate(I, A, Latitude, Day);
+			}
+		}
+	});
+
+	MaxAbsError = MeasureMaxAbsError();
+
+	UE_LOG(SimulationLog, Display, TEXT("Solar radiation table: %dx%d nodes x %d days, %.1f MB, max abs error %g, built in %.1f ms"),
+		NumInclination, NumAspect, NumDays, GetAllocatedSize() / (1024.0 * 1024.0), MaxAbsError, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+FSolarRadiationSample FSolarRadiationTable::Sample(float Inclination, float Aspect, int32 DayOfYear) const
+{
+	const int32 Day = FMath::Clamp(DayOfYear, 0, NumDays - 1);
+
+	const float IX = FMath::Clamp(Inclination * InvInclinationStep, 0.0f, static_cast<float>(NumInclination - 1));
+	const int32 I0 = FMath::Min(static_cast<int32>(IX), NumInclination - 2);
+	const float IAlpha = IX - I0;
+
+	// Aspect wraps around, the last node duplicates the first one
+	float Wrapped = FMath::Fmod(Aspect, PI * 2);
+	if (Wrapped < 0) Wrapped += PI * 2;
+	const float AX = FMath::Clamp(Wrapped * InvAspectStep, 0.0f, static_cast<float>(NumAspect - 1));
+	const int32 A0 = FMath::Min(static_cast<int32>(AX), NumAspect - 2);
+	const float AAlpha = AX - A0;
+
+	const FSolarRadiationSample* Row0 = &Samples[(Day * NumInclination + I0) * NumAspect + A0];
+	const FSolarRadiationSample* Row1 = Row0 + NumAspect;
+
+	auto Bilinear = [IAlpha, AAlpha](float V00, float V01, float V10, float V11)
+	{
+		return FMath::Lerp(FMath::Lerp(V00, V01, AAlpha), FMath::Lerp(V10, V11, AAlpha), IAlpha);
+	};
+
+	FSolarRadiationSample Result;
+	Result.Sunrise = Bilinear(Row0[0].Sunrise, Row0[1].Sunrise, Row1[0].Sunrise, Row1[1].Sunrise);
+	Result.Sunset = Bilinear(Row0[0].Sunset, Row0[1].Sunset, Row1[0].Sunset, Row1[1].Sunset);
+	Result.Ri = Bilinear(Row0[0].Ri, Row0[1].Ri, Row1[0].Ri, Row1[1].Ri);
+	return Result;
+}
+
+float FSolarRadiationTable::MeasureMaxAbsError() const
+{
+	// Probe cell centers of the grid (the farthest points from the nodes) plus random points, in parallel per day
+	constexpr int32 RandomSamplesPerDay = 256;
+	TArray<float> DayErrors;
+	DayErrors.SetNumZeroed(NumDays);
+
+	ParallelFor(NumDays - 1, [this, &DayErrors](int32 DayIndex)
+	{
+		const int32 Day = DayIndex + 1;
+		const FSolarDayTerms& Terms = Days[Day];
+		float MaxError = 0.0f;
+
+		auto Probe = [&](float I, float A)
+		{
+			const float Exact = FSolarRadiation::Evaluate(I, A, Latitude, Terms).Ri;
+			const float Approx = Sample(I, A, Day).Ri;
+			// A non-finite value on either side is an unbounded error, not a probe to skip
+			const bool bFinite = FMath::IsFinite(Exact) && FMath::IsFinite(Approx);
+			MaxError = bFinite ? FMath::Max(MaxError, FMath::Abs(Exact - Approx)) : std::numeric_limits<float>::infinity();
+		};
+
+		for (int32 InclinationNode = 0; InclinationNode < NumInclination - 1; ++InclinationNode)
+		{
+			for (int32 AspectNode = 0; AspectNode < NumAspect - 1; ++AspectNode)
+			{
+				Probe(FMath::Min((InclinationNode + 0.5f) / InvInclinationStep, PI / 2), (AspectNode + 0.5f) / InvAspectStep);
+			}
+		}
+
+		FRandomStream Random(Day);
+		for (int32 i = 0; i < RandomSamplesPerDay; ++i)
+		{
+			Probe(Random.FRand() * PI / 2, Random.FRand() * PI * 2);
+		}
+
+		DayErrors[Day] = MaxError;
+	});
+
+	float MaxError = 0.0f;
+	for (const float Error : DayErrors)
+	{
+		MaxError = FMath::Max(MaxError, Error);
+	}
+	return MaxError;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Day-of-year terms of Swifts algorithm. They only depend on the day and the latitude, so they are shared by all cells. */
+struct FSolarDayTerms
+{
+	/** Solar declination in radians. */
+	float D = 0.0f;
+	float SinD = 0.0f;
+	float CosD = 1.0f;
+	float TanD = 0.0f;
+
+	/** Solar constant corrected for the earth-sun distance. */
+	float R1 = 0.0f;
+
+	/** Sunset hour angle of a horizontal surface at the latitude, Func2(L0, D). */
+	float T1 = 0.0f;
+
+	/** Daily radiation on a horizontal surface at the latitude, the denominator of the radiation index. */
+	float R3 = 0.0f;
+};
+
+/** Radiation index and sunrise/sunset offsets (hours from solar noon). Layout matches SolarRadiation in the degree-day shader. */
+struct FSolarRadiationSample
+{
+	float Sunrise = 0.0f;
+	float Sunset = 0.0f;
+	float Ri = 0.0f;
+};
+
+/** Analytic solar radiation as described in Swifts "Algorithm for Solar Radiation on Mountain Slopes". */
+struct SIMULATION_API FSolarRadiation
+{
+	/**
+	* Computes the terms shared by every cell for a day.
+	*
+	* @param L0		The latitude in radians.
+	* @param J		The day of the year.
+	*/
+	static FSolarDayTerms ComputeDayTerms(float L0, float J);
+
+	/**
+	* Calculates the solar radiation index of a slope for the day described by Day.
+	*
+	* @param I		The inclination of the slope in radians.
+	* @param A		The aspect (compass direction) that the slope faces in radians.
+	* @param L0		The latitude of the slope in radians, must match the latitude of Day.
+	*/
+	static FSolarRadiationSample Evaluate(float I, float A, float L0, const FSolarDayTerms& Day);
+
+	/** Reference version computing everything from scratch. */
+	static float RadiationIndex(float I, float A, float L0, float J)
+	{
+		return Evaluate(I, A, L0, ComputeDayTerms(L0, J)).Ri;
+	}
+
+	// @TODO check for invalid latitudes (90°)
+	static FORCEINLINE float Func2(float L, float TanD) // sunrise/sunset
+	{
+		return FMath::Acos(FMath::Clamp(-FMath::Tan(L) * TanD, -1.0f, 1.0f));
+	}
+
+	static FORCEINLINE float Func3(float V, float W, float X, float Y, const FSolarDayTerms& Day) // radiation
+	{
+		return Day.R1 * (Day.SinD * FMath::Sin(W) * (X - Y) * (12 / PI) +
+			Day.CosD * FMath::Cos(W) * (FMath::Sin(X + V) - FMath::Sin(Y + V)) * (12 / PI));
+	}
+};
+
+/**
+* Precomputed solar radiation for a field of constant latitude.
+*
+* Holds the day terms for every day of the year and the radiation index plus sunrise/sunset offsets on a regular
+* inclination x aspect grid for all 366 days, laid out day by day so the lookups of one step stay in a small slab.
+* Lookups interpolate bilinearly between the grid nodes. The table is built in parallel and measures its largest
+* deviation from the analytic version, which is available through GetMaxAbsError.
+*/
+class SIMULATION_API FSolarRadiationTable
+{
+public:
+	/** Days are indexed directly by the day of the year [1, 366], index 0 is a copy of day 1. */
+	static constexpr int32 NumDays = 367;
+
+	/**
+	* Builds the table.
+	*
+	* @param InLatitude				the latitude of the field in radians
+	* @param InclinationStepDeg		grid spacing of the inclination in degrees
+	* @param AspectStepDeg			grid spacing of the aspect in degrees
+	*/
+	void Build(float InLatitude, float InclinationStepDeg, float AspectStepDeg);
+
+	bool IsBuilt() const { return Samples.Num() > 0; }
+
+	float GetLatitude() const { return Latitude; }
+
+	/** Largest absolute error of the radiation index against the analytic version measured during Build. */
+	float GetMaxAbsError() const { return MaxAbsError; }
+
+	FORCEINLINE const FSolarDayTerms& GetDayTerms(int32 DayOfYear) const
+	{
+		return Days[FMath::Clamp(DayOfYear, 0, NumDays - 1)];
+	}
+
+	/** Bilinearly interpolated radiation of a slope with the given inclination and aspect (radians) for a day. */
+	FSolarRadiationSample Sample(float Inclination, float Aspect, int32 DayOfYear) const;
+
+	FORCEINLINE float GetRadiationIndex(float Inclination, float Aspect, int32 DayOfYear) const
+	{
+		return Sample(Inclination, Aspect, DayOfYear).Ri;
+	}
+
+	SIZE_T GetAllocatedSize() const { return Days.GetAllocatedSize() + Samples.GetAllocatedSize(); }
+
+private:
+	float Latitude = 0.0f;
+
+	/** Number of grid nodes per axis, the aspect axis includes 360° as a copy of 0° so it wraps without a modulo. */
+	int32 NumInclination = 0;
+	int32 NumAspect = 0;
+
+	/** Inverse grid spacing in 1/radians. */
+	float InvInclinationStep = 0.0f;
+	float InvAspectStep = 0.0f;
+
+	float MaxAbsError = 0.0f;
+
+	TArray<FSolarDayTerms> Days;
+
+	/** Samples[(Day * NumInclination + InclinationNode) * NumAspect + AspectNode] */
+	TArray<FSolarRadiationSample> Samples;
+
+	float MeasureMaxAbsError() const;
+};
@@ -28,4 +28,14 @@ void ASimulationHUD::DrawHUD()
 		//Draw
 		Canvas->DrawItem(TextItem);
 	}
+
+	if (Simulation->DrawStepStats)
+	{
+		// Reduced by the simulation kernels during the step, reading them is free
+		const FSnowStepStats& Stats = Simulation->GetLastStepStats();
+		FText StatsText = FText::FromString(FString::Printf(TEXT("Snow depth %.1f / %.1f / %.1f mm (min/mean/max), %d/%d cells covered"),
+			Stats.MinDepth * 1000.0f, Stats.GetMeanDepth() * 1000.0f, Stats.MaxDepth * 1000.0f, Stats.SnowCoveredCells, Stats.NumCells));
+		FCanvasTextItem StatsItem(FVector2D(20, 50), StatsText, UE4Font, FColor(0, 0, 0, 255));
+		Canvas->DrawItem(StatsItem);
+	}
 }
\ No newline at end of file
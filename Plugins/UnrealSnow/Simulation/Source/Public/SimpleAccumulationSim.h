@@ -12,7 +12,7 @@ class SIMULATION_API USimpleAccumulationSim : public USnowSimulation
 public:
 	virtual FString GetSimulationName() const override { return TEXT("SimpleAccumulation"); }
 
-	virtual void Initialize(ASnowSimulationActor* SimulationActor, const TArray<FLandscapeCell>& Cells, float InitialMaxSnow, UWorld* World) override
+	virtual void Initialize(ASnowSimulationActor* SimulationActor, const TSharedPtr<FSnowCellField>& Cells, float InitialMaxSnow, UWorld* World) override
 	{
 		const int32 DimX = SimulationActor ? SimulationActor->CellsDimensionX : 0;
 		const int32 DimY = SimulationActor ? SimulationActor->CellsDimensionY : 0;
@@ -43,7 +43,43 @@ public:
 		UE_LOG(LogTemp, Verbose, TEXT("[Snow][Accum] dt=%.0fs precipWE=%.2f mm SnowFrac=%.2f -> dS=%.3f mm ; depth=%.3f mm"),
 			DtSeconds, PrecipWE_mm, SnowFrac, dS_mm, CurrentDepth_mm);
 
-		for (float& H : OutDepthMeters) { H += dS_m; }
+		if (dS_m <= 0.0f)
+		{
+			return;
+		}
+
+		EnsureTilesFor(OutDepthMeters);
+		float* Depth = OutDepthMeters.GetData();
+		const int32 Stride = Tiles.GridX;
+		SetStepStats(ReduceTiles(FSnowStepStats(), [this, Depth, Stride, dS_m](const FSnowTile& Tile)
+		{
+			FSnowStepStats TileStats;
+			for (int32 Y = Tile.Y0; Y < Tile.Y1; ++Y)
+			{
+				float* Row = Depth + Y * Stride + Tile.X0;
+				for (int32 X = 0; X < Tile.Width(); ++X)
+				{
+					Row[X] += dS_m;
+				}
+				TileStats.AccumulateRow(Row, Tile.Width());
+			}
+			MarkTileDirty(Tile);
+			return TileStats;
+		}, &FSnowStepStats::Combine));
+	}
+
+	// Only snowfall changes the depth
+	virtual bool IsQuiescent(const FWeatherForcingData& W) const override
+	{
+		return FMath::Max(0.0f, W.PrecipRate_kgm2s) * FMath::Clamp(W.SnowFrac_01, 0.f, 1.f) <= 0.0f;
+	}
+
+	virtual void FastForward(float DtSeconds, int32 NumSteps, const FWeatherForcingData& W, TArray<float>& OutDepthMeters) override
+	{
+		if (!IsQuiescent(W))
+		{
+			Super::FastForward(DtSeconds, NumSteps, W, OutDepthMeters);
+		}
 	}
 
 	virtual void Simulate(ASnowSimulationActor* SimulationActor, int32 /*CurrentSimulationStep*/, int32 /*Timesteps*/, bool /*SaveSnowMap*/, bool /*CaptureDebugInformation*/, TArray<FDebugCell>& /*DebugCells*/) override
@@ -80,7 +116,10 @@ public:
 			DepthBefore_0_0, DepthBefore_Center,
 			DepthBefore_0_0 + dS_m, DepthBefore_Center + dS_m);
 
-		for (float& H : DepthMeters) { H += dS_m; }
+		EnsureTilesFor(DepthMeters);
+		float* Depth = DepthMeters.GetData();
+		ForEachCell([Depth, dS_m](int32 i) { Depth[i] += dS_m; });
+		MarkAllTilesDirty();
 
 		// Upload to PF_R16F texture
 		UploadDepthToTexture();
@@ -96,8 +135,9 @@ public:
 
 	virtual float GetMaxSnow() override
 	{
-		float LocalMax = 0.0f;
-		for (const float V : DepthMeters) { LocalMax = FMath::Max(LocalMax, V); }
-		return LocalMax * 1000.0f; // mm
+		return EnsureStepStats(DepthMeters).MaxDepth * 1000.0f; // mm
 	}
+
+protected:
+	virtual bool TracksDirtyTiles() const override { return true; }
 };
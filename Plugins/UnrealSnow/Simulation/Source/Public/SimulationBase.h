@@ -5,7 +5,7 @@
 #include "CoreMinimal.h"
 #include "SimulationWeatherDataProviderBase.h"
 #include "Cells/DebugCell.h"
-#include "Cells/LandscapeCell.h"
+#include "Cells/SnowCellField.h"
 #include "SimulationBase.generated.h"
 
 // Forward declarations
@@ -21,6 +21,9 @@ class SIMULATION_API USimulationBase : public UObject
 	GENERATED_BODY()
 
 protected:
+	/** Columnar cell store shared with the simulation actor. */
+	TSharedPtr<FSnowCellField> CellField;
+
 	/** Number of cells in x direction. */
 	int32 CellsDimensionX;
 
@@ -37,7 +40,7 @@ public:
 	/**
 	* Initializes the simulation.
 	*/
-	virtual void Initialize(ASnowSimulationActor* SimulationActor, const TArray<FLandscapeCell>& Cells, float InitialMaxSnow, UWorld* World) PURE_VIRTUAL(USimulationBase::Initialize, return;);
+	virtual void Initialize(ASnowSimulationActor* SimulationActor, const TSharedPtr<FSnowCellField>& Cells, float InitialMaxSnow, UWorld* World) PURE_VIRTUAL(USimulationBase::Initialize, return;);
 
 	/**
 	* Runs the simulation on the given cells until the given end time is reached.
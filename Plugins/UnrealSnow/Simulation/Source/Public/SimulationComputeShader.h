@@ -5,6 +5,7 @@
 #include "ClimateData.h"
 #include "RWStructuredBuffer.h"
 #include "Cells/DebugCell.h"
+#include "DegreeDay/SolarRadiation.h"
 #include "RHI.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(SnowComputeShader, Log, All);
@@ -30,7 +31,7 @@ public:
 	* Run this to execute the compute shader once!
 	* @param TotalElapsedTimeSeconds - We use this for simulation state
 	*/
-	void ExecuteComputeShader(int CurrentTimeStep, int32 InTimesteps, int InHourOfDay, bool CaptureDebugInformation, TArray<FDebugCell>& DebugInformation);
+	void ExecuteComputeShader(int CurrentTimeStep, int32 InTimesteps, int InHourOfDay, int32 InDayOfYear, const FSolarDayTerms& InSolarDay, bool CaptureDebugInformation, TArray<FDebugCell>& DebugInformation);
 
 	/**
 	* Only execute this from the render thread.
@@ -80,6 +81,8 @@ private:
 	int32 Timesteps;
 	int32 DayOfYear;
 	int32 HourOfDay;
+	/** Day-of-year radiation terms shared by all cells. */
+	FSolarDayTerms SolarDay;
 
 	/** Main texture */
 	FTextureRHIRef Texture;
@@ -3,8 +3,15 @@
 #include "CoreMinimal.h"
 #include "SimulationBase.h"
 #include "Engine/Texture2D.h"
+#include "Misc/App.h"
 #include "Util/TextureUtil.h"
-#include "Cells/LandscapeCell.h"
+#include "Util/SnowTiles.h"
+#include "Util/SnowActiveSet.h"
+#include "Util/SnowAdaptiveGrid.h"
+#include "Util/DepthUploadRing.h"
+#include "SnowStepStats.h"
+#include "SnowStats.h"
+#include "Cells/SnowCellField.h"
 #include "SnowSimulation.generated.h"
 
 /**
@@ -20,6 +27,46 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snow|Physics", meta=(ClampMin="10.0", ClampMax="600.0"))
 	float FreshSnowDensity_kgm3 = 100.0f; // user-tunable density for converting precipitation mass to snow depth
 
+	/** Edge length in cells of the square tiles the per-cell kernels are scheduled in. Takes effect on the next InitializeGrid. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snow|Performance", meta=(ClampMin="8", ClampMax="1024"))
+	int32 TileSize = SnowDefaultTileSize;
+
+	/**
+	* Simulates blocks of cells with uniform terrain and snow as single super-cells of an adaptive quadtree. Needs terrain
+	* metadata; the super-cells are written back to their cells before an upload or readback (see ResolveCellState), so
+	* SnowMapTexture keeps the full resolution.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snow|Adaptive")
+	bool bAdaptiveGrid = false;
+
+	/** Largest super-cell edge length in cells. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snow|Adaptive", meta=(EditCondition="bAdaptiveGrid", ClampMin="1", ClampMax="256"))
+	int32 AdaptiveMaxBlockSize = 16;
+
+	/** Largest altitude spread within a super-cell in meters. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snow|Adaptive", meta=(EditCondition="bAdaptiveGrid", ClampMin="0.0"))
+	float AdaptiveAltitudeTolerance = 1.0f;
+
+	/** Largest slope spread within a super-cell in degrees. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snow|Adaptive", meta=(EditCondition="bAdaptiveGrid", ClampMin="0.0"))
+	float AdaptiveSlopeTolerance = 1.0f;
+
+	/** Largest curvature spread within a super-cell. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snow|Adaptive", meta=(EditCondition="bAdaptiveGrid", ClampMin="0.0"))
+	float AdaptiveCurvatureTolerance = 0.0002f;
+
+	/** Largest snow depth spread within a super-cell in meters, a super-cell is refined once its cells may differ by more. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snow|Adaptive", meta=(EditCondition="bAdaptiveGrid", ClampMin="0.0"))
+	float AdaptiveDepthTolerance = 0.005f;
+
+	/** Largest snow age spread within a super-cell in days. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snow|Adaptive", meta=(EditCondition="bAdaptiveGrid", ClampMin="0.0"))
+	float AdaptiveAgeTolerance = 1.0f;
+
+	/** Steps between rebuilds of all tiles, which merge blocks that became uniform again (0 = only refine). */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snow|Adaptive", meta=(EditCondition="bAdaptiveGrid", ClampMin="0"))
+	int32 AdaptiveRebuildInterval = 24;
+
 	// Bring base overload into scope to avoid name-hiding warnings
 	using USimulationBase::Initialize;
 	// Blueprint-friendly initializer for grid-based snow simulations
@@ -34,6 +81,10 @@ public:
 	UPROPERTY(Transient)
 	UTexture2D* SnowMapTexture = nullptr;
 
+	// Provider whose spatially varying forcing Step fills per tile, see SetForcingFieldProvider
+	UPROPERTY(Transient)
+	TObjectPtr<USimulationWeatherDataProviderBase> ForcingFieldProvider = nullptr;
+
 	// Grid resolution
 	int32 GridX = 0;
 	int32 GridY = 0;
@@ -42,16 +93,165 @@ public:
 	TArray<float> DepthMeters;
 
 protected:
-	// Optional per-cell terrain metadata aligned to DepthMeters (GridX * GridY)
-	TArray<float> TerrainSlopeDegrees;   // degrees
-	TArray<float> TerrainCurvature;      // unitless curvature
+	// True when CellField holds terrain metadata aligned to DepthMeters (GridX * GridY)
 	bool bHasTerrainMetadata = false;
 
+	// Tile layout of the GridX * GridY grid used to schedule per-cell kernels
+	FSnowTileGrid Tiles;
+
+	// Persistent staging buffers for SnowMapTexture uploads
+	FSnowDepthUploadRing DepthUploadRing;
+
+	// Change counter per tile of Tiles, bumped by Step for every tile it modifies
+	FSnowTileVersions TileVersions;
+
+	// Cells with snow per tile, maintained by simulations whose Step visits only active cells
+	FSnowActiveSet ActiveCells;
+
+	// Super-cells per tile, maintained by simulations that step the adaptive grid
+	FSnowAdaptiveGrid AdaptiveGrid;
+	int32 AdaptiveStepsSinceRebuild = 0;
+
+	// Tiles uploaded to SnowMapTexture and the regions of the current upload
+	FSnowDirtyTileTracker SnowMapDirtyTiles;
+	TArray<FSnowTile> SnowMapUploadRegions;
+
+	/**
+	* Returns true if Step marks the tiles it changes with MarkTileDirty, so uploads can skip unchanged tiles.
+	* Simulations that do not track changes upload the whole grid after every step.
+	*/
+	virtual bool TracksDirtyTiles() const { return false; }
+
+	/**
+	* Returns true if Step reports the cells its kernels visit with SnowStats::AddCellsStepped, a super-cell counting
+	* once. StepSpan counts the whole grid for every Step call of simulations that do not.
+	*/
+	virtual bool CountsSteppedCells() const { return false; }
+
+	/** Marks a tile as changed, safe to call from the worker running the tile. */
+	FORCEINLINE void MarkTileDirty(const FSnowTile& Tile)
+	{
+		TileVersions.Mark(Tile.Index);
+	}
+
+	// Depth statistics after the last Step, see GetStepStats
+	FSnowStepStats StepStats;
+
+	// Position of cell (0, 0) in the grid of ForcingFieldProvider
+	FIntPoint ForcingFieldOrigin = FIntPoint::ZeroValue;
+
+	/** Returns true if Step should fill the forcing per tile from ForcingFieldProvider instead of using its forcing argument. */
+	bool HasSpatialForcing() const
+	{
+		return ForcingFieldProvider && ForcingFieldProvider->HasSpatialForcing();
+	}
+
+	/** Stores the statistics reduced by a Step kernel and derives the SWE sum from the snow density. */
+	void SetStepStats(const FSnowStepStats& InStats)
+	{
+		StepStats = InStats;
+		StepStats.SumSWE_mm = StepStats.SumDepth * FreshSnowDensity_kgm3; // m * kg/m^3 = kg/m^2 = mm
+	}
+
+	/** Statistics of the rows of Tile in Depth, for kernels that reduce them right after writing the tile. */
+	static FSnowStepStats ComputeTileStats(const float* Depth, int32 Stride, const FSnowTile& Tile)
+	{
+		FSnowStepStats Stats;
+		for (int32 Y = Tile.Y0; Y < Tile.Y1; ++Y)
+		{
+			Stats.AccumulateRow(Depth + Y * Stride + Tile.X0, Tile.Width());
+		}
+		return Stats;
+	}
+
+	/**
+	* Runs Body(const FSnowTile&) for every tile of the grid in parallel. Derived C++ simulations should express their
+	* Step as tile or cell kernels so they scale with the available cores. Body runs on worker threads and must only
+	* write cells of its own tile.
+	*/
+	template <typename FuncType>
+	void ForEachTile(FuncType&& Body) const
+	{
+		Tiles.ForEachTile(Forward<FuncType>(Body));
+	}
+
+	/** Runs Body(int32 CellIndex) for every cell of the grid in parallel, see ForEachTile. */
+	template <typename FuncType>
+	void ForEachCell(FuncType&& Body) const
+	{
+		Tiles.ForEachCell(Forward<FuncType>(Body));
+	}
+
+	/** Parallel reduction over tiles whose result does not depend on the thread count, see FSnowTileGrid::ReduceTiles. */
+	template <typename T, typename TileFuncType, typename CombineFuncType>
+	T ReduceTiles(T Identity, TileFuncType&& TileBody, CombineFuncType&& Combine) const
+	{
+		return Tiles.ReduceTiles(Identity, Forward<TileFuncType>(TileBody), Forward<CombineFuncType>(Combine));
+	}
+
+	/** Makes sure the tile layout covers Buffer; buffers that do not match the grid are tiled as a single row of cells. */
+	void EnsureTilesFor(const TArray<float>& Buffer)
+	{
+		if (Tiles.GridX * Tiles.GridY != Buffer.Num())
+		{
+			const bool bMatchesGrid = Buffer.Num() == GridX * GridY;
+			Tiles.Initialize(bMatchesGrid ? GridX : Buffer.Num(), bMatchesGrid ? GridY : 1, bMatchesGrid ? TileSize : TileSize * TileSize);
+			TileVersions.Reset(Tiles.NumTiles());
+			ActiveCells.Invalidate();
+			AdaptiveGrid.Invalidate();
+		}
+	}
+
+	/** Tolerances of the adaptive grid in the units of the cell field. */
+	FSnowAdaptiveTolerances GetAdaptiveTolerances() const
+	{
+		FSnowAdaptiveTolerances Tolerances;
+		Tolerances.MaxBlockSize = FMath::Max(1, AdaptiveMaxBlockSize);
+		Tolerances.Altitude = AdaptiveAltitudeTolerance * 100.0f; // m → cm
+		Tolerances.Slope = FMath::DegreesToRadians(AdaptiveSlopeTolerance);
+		Tolerances.Curvature = AdaptiveCurvatureTolerance;
+		Tolerances.Depth = AdaptiveDepthTolerance;
+		Tolerances.Age = AdaptiveAgeTolerance;
+		return Tolerances;
+	}
+
+	/** Makes sure ActiveCells lists the cells with snow of Buffer, rebuilding them after outside writes (see MarkAllTilesDirty). */
+	void EnsureActiveCells(const TArray<float>& Buffer)
+	{
+		EnsureTilesFor(Buffer);
+		if (!ActiveCells.IsValidFor(Tiles))
+		{
+			const bool bGridHoles = bHasTerrainMetadata && Tiles.GridX == GridX && Tiles.GridY == GridY;
+			ActiveCells.Build(Tiles, Buffer.GetData(), bGridHoles ? &CellField->Holes : nullptr);
+		}
+	}
+
+	/** Returns the largest value of Values using a deterministic tile reduction. */
+	float ReduceMax(const TArray<float>& Values)
+	{
+		EnsureTilesFor(Values);
+		const float* Data = Values.GetData();
+		const int32 Stride = Tiles.GridX;
+		return ReduceTiles(0.0f, [Data, Stride](const FSnowTile& Tile)
+		{
+			float TileMax = 0.0f;
+			for (int32 Y = Tile.Y0; Y < Tile.Y1; ++Y)
+			{
+				for (int32 X = Tile.X0; X < Tile.X1; ++X)
+				{
+					TileMax = FMath::Max(TileMax, Data[Y * Stride + X]);
+				}
+			}
+			return TileMax;
+		}, [](float A, float B) { return FMath::Max(A, B); });
+	}
+
 public:
 	// Ensure texture exists and matches size/format
 	virtual void EnsureSnowTexture(int32 InWidth, int32 InHeight, EPixelFormat InFormat = PF_R16F)
 	{
-		if (InWidth <= 0 || InHeight <= 0)
+		// Headless runs (commandlets, -nullrhi) only need the CPU depth buffer
+		if (InWidth <= 0 || InHeight <= 0 || !FApp::CanEverRender())
 		{
 			return;
 		}
@@ -64,6 +264,7 @@ public:
 		if (bNeedsCreate)
 		{
 			SnowMapTexture = UTexture2D::CreateTransient(InWidth, InHeight, InFormat);
+			SnowMapDirtyTiles.Invalidate();
 			if (SnowMapTexture)
 			{
 				SnowMapTexture->SRGB = false;
@@ -91,27 +292,98 @@ public:
 		GridY = InGridY;
 		DepthMeters.SetNum(GridX * GridY, EAllowShrinking::No);
 		for (float& V : DepthMeters) { V = 0.0f; }
+		Tiles.Initialize(GridX, GridY, TileSize);
+		TileVersions.Reset(Tiles.NumTiles());
+		ActiveCells.Invalidate();
+		AdaptiveGrid.Invalidate();
+		SetStepStats(FSnowStepStats::SnowFree(DepthMeters.Num()));
 		EnsureSnowTexture(GridX, GridY, PF_R16F);
 	}
 
 	// Optional: supply terrain metadata for redistribution models
-	virtual void SetTerrainMetadata(const TArray<FLandscapeCell>& Cells, int32 DimX, int32 DimY)
+	virtual void SetTerrainMetadata(const TSharedPtr<FSnowCellField>& InCellField)
+	{
+		CellField = InCellField;
+		bHasTerrainMetadata = CellField.IsValid() && CellField->Num() > 0 && CellField->Num() == GridX * GridY;
+		AdaptiveGrid.Invalidate();
+	}
+
+	/**
+	* Lets Step sample the forcing of Provider per tile with FillForcingField if it varies over the grid; the forcing
+	* passed to Step then only gives the time. Origin is the position of cell (0, 0) in the provider's grid.
+	*/
+	void SetForcingFieldProvider(USimulationWeatherDataProviderBase* Provider, FIntPoint Origin = FIntPoint::ZeroValue)
 	{
-		if (DimX <= 0 || DimY <= 0 || Cells.Num() != DimX * DimY)
+		ForcingFieldProvider = Provider;
+		ForcingFieldOrigin = Origin;
+	}
+
+	USimulationWeatherDataProviderBase* GetForcingFieldProvider() const { return ForcingFieldProvider; }
+
+	// Limit the number of worker threads the tile kernels may use (0 = all task graph workers)
+	void SetMaxWorkerThreads(int32 InMaxWorkers)
+	{
+		Tiles.MaxWorkers = FMath::Max(0, InMaxWorkers);
+	}
+
+	// Call after writing DepthMeters outside of Step so the next uploads send the whole grid, the active cells and super-cells are rebuilt and the step statistics are recomputed
+	void MarkAllTilesDirty()
+	{
+		TileVersions.MarkAll();
+		ActiveCells.Invalidate();
+		AdaptiveGrid.Invalidate();
+		InvalidateStepStats();
+	}
+
+	/**
+	* Depth statistics of the buffer passed to the last Step. Steps that change the buffer reduce them in their own
+	* kernels, steps that leave it untouched keep the previous ones, so reading them costs no extra pass over the grid.
+	*/
+	const FSnowStepStats& GetStepStats() const { return StepStats; }
+
+	/**
+	* Returns the step statistics if they describe Buffer, otherwise recomputes them with a separate pass. Covers
+	* simulations whose Step does not produce statistics; MarkAllTilesDirty after writing Buffer outside Step invalidates them.
+	*/
+	const FSnowStepStats& EnsureStepStats(const TArray<float>& Buffer)
+	{
+		if (!StepStats.IsValidFor(Buffer.Num()))
 		{
-			bHasTerrainMetadata = false;
-			TerrainSlopeDegrees.Reset();
-			TerrainCurvature.Reset();
-			return;
+			SNOW_SCOPE(Stats);
+			EnsureTilesFor(Buffer);
+			const float* Data = Buffer.GetData();
+			const int32 Stride = Tiles.GridX;
+			SetStepStats(ReduceTiles(FSnowStepStats(), [Data, Stride](const FSnowTile& Tile)
+			{
+				return ComputeTileStats(Data, Stride, Tile);
+			}, &FSnowStepStats::Combine));
 		}
-		TerrainSlopeDegrees.SetNum(DimX * DimY, EAllowShrinking::No);
-		TerrainCurvature.SetNum(DimX * DimY, EAllowShrinking::No);
-		for (int32 idx = 0; idx < Cells.Num(); ++idx)
+		return StepStats;
+	}
+
+	void InvalidateStepStats()
+	{
+		StepStats = FSnowStepStats();
+	}
+
+	/**
+	* Collects the regions (in cells) of DepthMeters that changed since Tracker last saw them. The whole grid is
+	* reported if the simulation does not track dirty tiles, OutRegions is empty if nothing changed. Call
+	* ResolveCellState first, the regions may still be waiting for their cells to be written.
+	*/
+	void ConsumeDirtyRegions(FSnowDirtyTileTracker& Tracker, TArray<FSnowTile>& OutRegions) const
+	{
+		const bool bTracked = TracksDirtyTiles() && Tiles.GridX == GridX && Tiles.GridY == GridY;
+		if (!bTracked)
 		{
-			TerrainSlopeDegrees[idx] = FMath::RadiansToDegrees(Cells[idx].Inclination);
-			TerrainCurvature[idx] = Cells[idx].Curvature;
+			Tracker.Invalidate();
+			OutRegions.Reset();
+			FSnowTile& Full = OutRegions.AddDefaulted_GetRef();
+			Full.X1 = GridX;
+			Full.Y1 = GridY;
+			return;
 		}
-		bHasTerrainMetadata = true;
+		Tracker.Consume(Tiles, TileVersions, OutRegions);
 	}
 
 	// Never return nullptr when GridX/Y are valid
@@ -124,6 +396,8 @@ public:
 	// Upload DepthMeters (float meters) to PF_R16F texture using correct strides
 	virtual void UploadDepthToTexture()
 	{
+		// Also brings DepthMeters up to date for the readbacks that follow the upload
+		ResolveCellState();
 		if (!SnowMapTexture || GridX <= 0 || GridY <= 0)
 		{
 			return;
@@ -133,7 +407,18 @@ public:
 			// resize or bail; safest is to bail to avoid garbage
 			return;
 		}
-		UpdateTextureR16FFromFloat(SnowMapTexture, GridX, GridY, DepthMeters);
+		SNOW_SCOPE(Upload);
+		// Only the tiles changed since the last upload are sent, dry and cold steps upload nothing
+		ConsumeDirtyRegions(SnowMapDirtyTiles, SnowMapUploadRegions);
+		DepthUploadRing.Upload(SnowMapTexture, GridX, GridY, DepthMeters, SnowMapUploadRegions);
+	}
+
+	/**
+	* Applies per-cell state the simulation deferred (e.g. the aging of dry spans or the super-cells of the adaptive grid)
+	* to DepthMeters and the cell field. Call before they are read or replaced outside of Step.
+	*/
+	virtual void ResolveCellState()
+	{
 	}
 
 	// Optional stepping interface for simple sims
@@ -142,6 +427,62 @@ public:
 		// no-op by default
 	}
 
+	/**
+	* Returns true if a step under W cannot change the snow depth (no snowfall, no melt), so runs of such steps can be
+	* fast-forwarded. Simulations that cannot tell return false and are always stepped.
+	*/
+	virtual bool IsQuiescent(const FWeatherForcingData& /*W*/) const
+	{
+		return false;
+	}
+
+	/**
+	* Advances NumSteps consecutive steps under the same forcing W. Simulations override this with a closed-form update
+	* for quiescent forcing; the default runs Step NumSteps times.
+	*/
+	virtual void FastForward(float DtSeconds, int32 NumSteps, const FWeatherForcingData& W, TArray<float>& OutDepthMeters)
+	{
+		for (int32 i = 0; i < NumSteps; ++i)
+		{
+			Step(DtSeconds, W, OutDepthMeters);
+		}
+	}
+
+	/**
+	* Runs one step per entry of Forcing. Runs of quiescent forcing are handed to FastForward as a single update when
+	* bAllowFastForward is set, everything else is stepped. Returns the number of Step calls made.
+	*/
+	int32 StepSpan(float DtSeconds, TConstArrayView<FWeatherForcingData> Forcing, TArray<float>& OutDepthMeters, bool bAllowFastForward = true)
+	{
+		SNOW_SCOPE(Kernel);
+		int32 NumStepCalls = 0;
+		for (int32 Index = 0; Index < Forcing.Num();)
+		{
+			const FWeatherForcingData& W = Forcing[Index];
+			if (!bAllowFastForward || !IsQuiescent(W))
+			{
+				Step(DtSeconds, W, OutDepthMeters);
+				++NumStepCalls;
+				++Index;
+				continue;
+			}
+
+			// Quiescent steps do not depend on the exact forcing, so the whole run is one update
+			int32 RunEnd = Index + 1;
+			while (RunEnd < Forcing.Num() && IsQuiescent(Forcing[RunEnd]))
+			{
+				++RunEnd;
+			}
+			FastForward(DtSeconds, RunEnd - Index, W, OutDepthMeters);
+			Index = RunEnd;
+		}
+		if (!CountsSteppedCells())
+		{
+			SnowStats::AddCellsStepped(static_cast<int64>(NumStepCalls) * GridX * GridY);
+		}
+		return NumStepCalls;
+	}
+
 	UFUNCTION(CallInEditor, Category="Snow|Debug")
 	void DebugFillDepth(float MaxDepthMeters = 0.2f)
 	{
@@ -169,6 +510,7 @@ public:
 				DepthMeters[y * GridX + x] = t * MaxDepthMeters;
 			}
 		}
+		MarkAllTilesDirty();
 		UploadDepthToTexture();
 	}
 };
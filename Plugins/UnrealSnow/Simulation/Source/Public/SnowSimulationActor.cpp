@@ -25,9 +25,27 @@
 #include "EngineUtils.h"
 #include "SnowSimulation.h"
 #include "SimpleAccumulationSim.h"
+#include "HAL/IConsoleManager.h"
+#include "Tasks/Task.h"
+#include "Checkpoint/SnowSaveGame.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "SnowStats.h"
 
 DEFINE_LOG_CATEGORY(SimulationLog);
 
+static TAutoConsoleVariable<int32> CVarSnowAsyncStep(
+	TEXT("snow.Sim.AsyncStep"),
+	1,
+	TEXT("1 = run snow simulation steps on a worker task with double-buffered depth (if enabled on the actor), 0 = step synchronously in Tick."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarSnowFastForward(
+	TEXT("snow.Sim.FastForward"),
+	1,
+	TEXT("1 = advance spans of quiescent weather (no snowfall, no melt) with a single closed-form update, 0 = step every hour."),
+	ECVF_Default);
+
 ASnowSimulationActor::ASnowSimulationActor()
 {
 	PrimaryActorTick.bCanEverTick = true;
@@ -44,6 +62,8 @@ ASnowSimulationActor::ASnowSimulationActor()
 
 void ASnowSimulationActor::BeginPlay()
 {
+	SNOW_SCOPE(BeginPlay);
+
 	Super::BeginPlay();
 
 	// Compute the cells and grid from the landscape first
@@ -98,20 +118,30 @@ void ASnowSimulationActor::BeginPlay()
 	if (Simulation && Landscape)
 	{
 		// Prefer new BN-event initializer when using USnowSimulation
-		if (USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation))
+		USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation);
+		if (SnowSim && bStreamDomain)
+		{
+			// The simulation is the template of the page simulations and is never stepped itself
+			InitializeStreamedDomain(SnowSim);
+		}
+		else if (SnowSim)
 		{
 			SnowSim->Initialize(CellsDimensionX, CellsDimensionY, MetersPerCell);
 			// Provide terrain metadata to the simulation for redistribution models
-			SnowSim->SetTerrainMetadata(LandscapeCells, CellsDimensionX, CellsDimensionY);
+			SnowSim->SetTerrainMetadata(CellField);
 			// Bind material once (create MID and bind texture parameter)
 			UpdateMaterialTexture();
 			// Perform an initial upload so bound material sees a valid texture content
 			SnowSim->UploadDepthToTexture();
 		}
+		else if (!CellField.IsValid())
+		{
+			UE_LOG(SimulationLog, Warning, TEXT("%s cannot run on a streamed domain, disable bStreamDomain."), *Simulation->GetClass()->GetName());
+		}
 		else
 		{
 			// Fallback to legacy Initialize signature
-			Simulation->Initialize(this, LandscapeCells, InitialMaxSnow, GetWorld());
+			Simulation->Initialize(this, CellField, InitialMaxSnow, GetWorld());
 			// Bind material once for legacy path as well
 			UpdateMaterialTexture();
 		}
@@ -168,6 +198,13 @@ void ASnowSimulationActor::BeginPlay()
 		WeatherProvider->Initialize(SimulationStart, SimulationEnd);
 	}
 
+	// Spatially varying providers are sampled per tile by the step kernels
+	if (USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation))
+	{
+		SnowSim->SetForcingFieldProvider(WeatherProvider);
+		StreamedDomain.SetForcingFieldProvider(WeatherProvider);
+	}
+
 	// Log comprehensive startup information
 	UE_LOG(LogTemp, Display, TEXT("[Snow] === STARTUP SUMMARY ==="));
 	UE_LOG(LogTemp, Display, TEXT("[Snow] Weather Provider: %s (Mode: %s)"), 
@@ -220,6 +257,8 @@ void ASnowSimulationActor::BeginPlay()
 
 void ASnowSimulationActor::Tick(float DeltaTime)
 {
+	SNOW_SCOPE(Tick);
+
 	Super::Tick(DeltaTime);
 
 	// Retry VHM integration if bounds weren't ready initially
@@ -236,7 +275,31 @@ void ASnowSimulationActor::Tick(float DeltaTime)
 
 	VisualAccumulator += DeltaTime;
 	const float StepInterval = (SimRateHz > 0) ? (1.0f / static_cast<float>(SimRateHz)) : 0.25f;
-	while (VisualAccumulator >= StepInterval)
+
+	USnowSimulation* AsyncSim = Cast<USnowSimulation>(Simulation);
+	const bool bAsyncStepping = AsyncSim && IsAsyncStepEnabled();
+	if (bAsyncStepping)
+	{
+		// Publish the latest completed step and kick the next one, the game thread never waits for a step
+		if (PendingStep.IsValid() && PendingStep.IsCompleted())
+		{
+			PublishAsyncStep(AsyncSim);
+		}
+
+		if (!PendingStep.IsValid() && VisualAccumulator >= StepInterval)
+		{
+			const int32 NumSteps = FMath::FloorToInt(VisualAccumulator / StepInterval);
+			VisualAccumulator -= NumSteps * StepInterval;
+			KickAsyncStep(AsyncSim, NumSteps);
+		}
+	}
+	else
+	{
+		// Synchronous fallback, finish a step that is still running from async mode first
+		FlushAsyncStep();
+	}
+
+	while (!bAsyncStepping && VisualAccumulator >= StepInterval)
 	{
 		VisualAccumulator -= StepInterval;
 
@@ -244,51 +307,36 @@ void ASnowSimulationActor::Tick(float DeltaTime)
 		FWeatherForcingData WeatherForcing;
 		if (WeatherProvider)
 		{
+			SNOW_SCOPE(ForcingFetch);
 			WeatherForcing = WeatherProvider->GetWeatherForcing(CurrentSimulationTime);
 		}
 
-		if (USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation))
+		if (StreamedDomain.IsInitialized())
+		{
+			StepStreamedDomain(SimDtSeconds, MakeArrayView(&WeatherForcing, 1));
+		}
+		else if (USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation))
 		{
-			SnowSim->Step(SimDtSeconds, WeatherForcing, SnowSim->DepthMeters);
+			SnowSim->SetMaxWorkerThreads(StepWorkerThreads);
+			SnowSim->StepSpan(SimDtSeconds, MakeArrayView(&WeatherForcing, 1), SnowSim->DepthMeters, /*bAllowFastForward=*/false);
 			SnowSim->UploadDepthToTexture();
 			
 			// Sync CPU buffer with simulation data for HUD display
 			UpdateCpuDepthMeters(SnowSim->DepthMeters);
 			
-		// Log stats
-		float MinV = FLT_MAX, MaxV = -FLT_MAX; double Sum = 0.0; const int32 Count = SnowSim->DepthMeters.Num();
-		for (int32 i = 0; i < Count; ++i) { const float v = SnowSim->DepthMeters[i]; MinV = FMath::Min(MinV, v); MaxV = FMath::Max(MaxV, v); Sum += v; }
-		const float Mean = (Count > 0) ? static_cast<float>(Sum / Count) : 0.0f;
-		UE_LOG(LogTemp, Display, TEXT("[Snow] Depth min/max/mean = %.4f / %.4f / %.4f m"), MinV, MaxV, Mean);
-		
-		// Log HUD stats for CPU buffer
-		if (CpuDepthMeters.Num() > 0)
-		{
-			float CpuMinV = FLT_MAX, CpuMaxV = -FLT_MAX;
-			for (int32 i = 0; i < CpuDepthMeters.Num(); ++i) 
-			{ 
-				const float v = CpuDepthMeters[i]; 
-				CpuMinV = FMath::Min(CpuMinV, v); 
-				CpuMaxV = FMath::Max(CpuMaxV, v); 
-			}
-			UE_LOG(LogTemp, Display, TEXT("[Snow][HUD] CPUbuf min/max(mm)=%.1f/%.1f, tex size=%dx%d"), 
-				CpuMinV * 1000.0f, CpuMaxV * 1000.0f, CellsDimensionX, CellsDimensionY);
-		}
+			// Stats come from the step kernels, no extra pass over the grid
+			ApplyStepStats(SnowSim->EnsureStepStats(SnowSim->DepthMeters));
 		}
 		else
 		{
 			// Legacy simulation path; use existing simulate API for a single step
+			SNOW_SCOPE(Kernel);
+			SnowStats::AddCellsStepped(NumCells);
 			Simulation->Simulate(this, this->CurrentSimulationStep, /*Timesteps=*/1, SaveMaterialTextures, DebugVisualizationType != EDebugVisualizationType::Nothing, DebugCells);
 		}
 
 		// Advance time
-		CurrentSimulationTime += FTimespan::FromSeconds(SimDtSeconds);
-		this->CurrentSimulationStep += FMath::RoundToInt(SimDtSeconds / 3600.0f);
-		if (bLoopTime && CurrentSimulationTime > SimulationEnd)
-		{
-			CurrentSimulationTime = SimulationStart;
-			this->CurrentSimulationStep = 0;
-		}
+		AdvanceSimulationTime(CurrentSimulationTime, this->CurrentSimulationStep);
 
 		// Update material bindings after the step
 		UpdateMaterialTexture();
@@ -298,84 +346,215 @@ void ASnowSimulationActor::Tick(float DeltaTime)
 	if (RenderGrid) DoRenderGrid();
 }
 
+void ASnowSimulationActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// The worker references the simulation and the back buffers, never let it outlive them
+	if (PendingStep.IsValid())
+	{
+		PendingStep.Wait();
+		PendingStep = {};
+	}
+	DepthUploadRing.Release();
+	StreamedDomain.Release();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ASnowSimulationActor::IsAsyncStepEnabled() const
+{
+	// Paging touches the page file and the landscape, the streamed domain is stepped on the game thread
+	return bAsyncStep && !StreamedDomain.IsInitialized() && CVarSnowAsyncStep.GetValueOnGameThread() != 0;
+}
+
+void ASnowSimulationActor::AdvanceSimulationTime(FDateTime& Time, int32& Step) const
+{
+	Time += FTimespan::FromSeconds(SimDtSeconds);
+	Step += FMath::RoundToInt(SimDtSeconds / 3600.0f);
+	if (bLoopTime && Time > SimulationEnd)
+	{
+		Time = SimulationStart;
+		Step = 0;
+	}
+}
+
+void ASnowSimulationActor::KickAsyncStep(USnowSimulation* SnowSim, int32 NumSteps)
+{
+	// Weather providers are not thread safe, so the forcing of every step is sampled up front on the game thread
+	TArray<FWeatherForcingData> Forcing;
+	Forcing.SetNum(NumSteps);
+	FDateTime Time = CurrentSimulationTime;
+	int32 Step = CurrentSimulationStep;
+	const bool bConstantForcing = WeatherProvider && WeatherProvider->IsForcingConstant();
+	{
+		SNOW_SCOPE(ForcingFetch);
+		for (FWeatherForcingData& W : Forcing)
+		{
+			if (WeatherProvider)
+			{
+				W = (bConstantForcing && &W != &Forcing[0]) ? Forcing[0] : WeatherProvider->GetWeatherForcing(Time);
+			}
+			AdvanceSimulationTime(Time, Step);
+		}
+	}
+
+	SnowSim->SetMaxWorkerThreads(StepWorkerThreads);
+	const float DtSeconds = SimDtSeconds;
+	const bool bFastForward = CVarSnowFastForward.GetValueOnGameThread() != 0;
+
+	PendingStep = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, SnowSim, Forcing = MoveTemp(Forcing), DtSeconds, bFastForward]()
+	{
+		// The simulation state belongs to the worker until the step is published, the game thread only reads the
+		// published CpuDepthMeters and LastStepStats in the meantime
+		TArray<float>& Depth = SnowSim->DepthMeters;
+		SnowSim->StepSpan(DtSeconds, Forcing, Depth, bFastForward);
+		SnowSim->ResolveCellState();
+
+		FAsyncStepResult Result;
+		Result.NumSteps = Forcing.Num();
+		Result.Stats = SnowSim->EnsureStepStats(Depth);
+
+		// The back buffer is one publish behind, only the tiles changed since it was last written are converted
+		SNOW_SCOPE(HalfConversion);
+		if (BackCpuDepthMeters.Num() != Depth.Num())
+		{
+			BackCpuDepthMeters.SetNumUninitialized(Depth.Num(), EAllowShrinking::No);
+			BackCpuDepthTiles.Invalidate();
+		}
+		SnowSim->ConsumeDirtyRegions(BackCpuDepthTiles, BackCpuDepthRegions);
+		const int32 Stride = SnowSim->GridX;
+		for (const FSnowTile& Region : BackCpuDepthRegions)
+		{
+			for (int32 Y = Region.Y0; Y < Region.Y1; ++Y)
+			{
+				for (int32 X = Region.X0; X < Region.X1; ++X)
+				{
+					BackCpuDepthMeters[Y * Stride + X] = FFloat16(Depth[Y * Stride + X]);
+				}
+			}
+		}
+		return Result;
+	});
+}
+
+void ASnowSimulationActor::PublishAsyncStep(USnowSimulation* SnowSim)
+{
+	const FAsyncStepResult Result = PendingStep.GetResult();
+	PendingStep = {};
+
+	// Flip the half precision front and back buffers, each one keeps the tile versions it was written at
+	Swap(CpuDepthMeters, BackCpuDepthMeters);
+	Swap(CpuDepthTiles, BackCpuDepthTiles);
+
+	for (int32 i = 0; i < Result.NumSteps; ++i)
+	{
+		AdvanceSimulationTime(CurrentSimulationTime, this->CurrentSimulationStep);
+	}
+
+	SnowSim->UploadDepthToTexture();
+	UploadDepthToTexture(/*bLogStats=*/false);
+
+	ApplyStepStats(Result.Stats, Result.NumSteps);
+
+	// Update material bindings after the step
+	UpdateMaterialTexture();
+}
+
+void ASnowSimulationActor::FlushAsyncStep()
+{
+	if (!PendingStep.IsValid())
+	{
+		return;
+	}
+
+	PendingStep.Wait();
+	if (USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation))
+	{
+		PublishAsyncStep(SnowSim);
+	}
+	else
+	{
+		PendingStep = {};
+	}
+}
+
 void ASnowSimulationActor::DoRenderGrid()
 {
+	SNOW_SCOPE(DebugDraw);
+
+	if (!CellField.IsValid()) return;
+
 	const auto Location = GetWorld()->GetFirstPlayerController()->PlayerCameraManager->GetCameraLocation();
-	
-	for (FDebugCell& Cell : DebugCells)
-	{
-		FVector Normal(Cell.Normal);
-		Normal.Normalize();
 
-		// @TODO get exact position using the height map
-		FVector zOffset(0, 0, DebugGridZOffset);
+	// @TODO get exact position using the height map
+	const FVector zOffset(0, 0, DebugGridZOffset);
+
+	for (int32 Index = 0; Index < CellField->Num(); Index++)
+	{
+		FVector P1, P2, P3, P4;
+		CellField->GetCorners(Index, P1, P2, P3, P4);
 
-		if (FVector::Dist(Cell.Centroid, Location) < CellDebugInfoDisplayDistance)
+		if (FVector::Dist((P1 + P2 + P3 + P4) / 4, Location) < CellDebugInfoDisplayDistance)
 		{
 			// Draw Cells
-			DrawDebugLine(GetWorld(), Cell.P1 + zOffset, Cell.P2 + zOffset, FColor(255, 0, 0), false, -1, 0, 0.0f);
-			DrawDebugLine(GetWorld(), Cell.P1 + zOffset, Cell.P3 + zOffset, FColor(255, 0, 0), false, -1, 0, 0.0f);
-			DrawDebugLine(GetWorld(), Cell.P2 + zOffset, Cell.P4 + zOffset, FColor(255, 0, 0), false, -1, 0, 0.0f);
-			DrawDebugLine(GetWorld(), Cell.P3 + zOffset, Cell.P4 + zOffset, FColor(255, 0, 0), false, -1, 0, 0.0f);
+			DrawDebugLine(GetWorld(), P1 + zOffset, P2 + zOffset, FColor(255, 0, 0), false, -1, 0, 0.0f);
+			DrawDebugLine(GetWorld(), P1 + zOffset, P3 + zOffset, FColor(255, 0, 0), false, -1, 0, 0.0f);
+			DrawDebugLine(GetWorld(), P2 + zOffset, P4 + zOffset, FColor(255, 0, 0), false, -1, 0, 0.0f);
+			DrawDebugLine(GetWorld(), P3 + zOffset, P4 + zOffset, FColor(255, 0, 0), false, -1, 0, 0.0f);
 		}
 	}
 }
 
 void ASnowSimulationActor::DoRenderDebugInformation()
 {
+	SNOW_SCOPE(DebugDraw);
+
+	if (!CellField.IsValid()) return;
+
 	const auto Location = GetWorld()->GetFirstPlayerController()->PlayerCameraManager->GetCameraLocation();
 	auto PlayerController = GetWorld()->GetFirstPlayerController();
 	auto Pawn = PlayerController->GetPawn();
+	const FSnowCellField& Field = *CellField;
+
+	// The CPU depth buffer shares the cell grid, so cells map to it by index
+	auto GetSnowHeightMM = [this](int32 Index)
+	{
+		return CpuDepthMeters.IsValidIndex(Index) ? CpuDepthMeters[Index] * 1000.0f : 0.0f; // Convert meters to mm
+	};
 
 	// Draw SWE normal
 	if (DebugVisualizationType == EDebugVisualizationType::SnowHeight)
 	{
-		for (auto& Cell : DebugCells)
-		{
-			// Sample snow height from CPU buffer instead of Cell.SnowMM
-			float SnowHeightMM = 0.0f;
-			if (CpuDepthMeters.Num() > 0)
-			{
-				// Convert world position to grid coordinates
-				const FVector2D GridPos = FVector2D(
-					(Cell.Centroid.X - Landscape->GetActorLocation().X) / (Landscape->GetActorScale().X * CellSize),
-					(Cell.Centroid.Y - Landscape->GetActorLocation().Y) / (Landscape->GetActorScale().Y * CellSize)
-				);
-				
-				const int32 GridX = FMath::Clamp(FMath::RoundToInt(GridPos.X), 0, CellsDimensionX - 1);
-				const int32 GridY = FMath::Clamp(FMath::RoundToInt(GridPos.Y), 0, CellsDimensionY - 1);
-				const int32 Index = GridY * CellsDimensionX + GridX;
-				
-				if (CpuDepthMeters.IsValidIndex(Index))
-				{
-					SnowHeightMM = CpuDepthMeters[Index] * 1000.0f; // Convert meters to mm
-				}
-			}
-			
-			if (SnowHeightMM > 0 && FVector::Dist(Cell.P1, Location) < CellDebugInfoDisplayDistance)
-			{
-				FVector Normal(Cell.Normal);
-				Normal.Normalize();
+		// @TODO get exact position using the height map
+		const FVector zOffset(0, 0, DebugGridZOffset);
 
-				// @TODO get exact position using the height map
-				FVector zOffset(0, 0, DebugGridZOffset);
+		for (int32 Index = 0; Index < Field.Num(); Index++)
+		{
+			const float SnowHeightMM = GetSnowHeightMM(Index);
+			if (SnowHeightMM <= 0) continue;
 
-				DrawDebugLine(GetWorld(), Cell.Centroid + zOffset, Cell.Centroid + FVector(0, 0, SnowHeightMM / 10) + zOffset, FColor(255, 0, 0), false, -1, 0, 0.0f);
+			FVector P1, P2, P3, P4;
+			Field.GetCorners(Index, P1, P2, P3, P4);
+			if (FVector::Dist(P1, Location) < CellDebugInfoDisplayDistance)
+			{
+				const FVector Centroid = (P1 + P2 + P3 + P4) / 4;
+				DrawDebugLine(GetWorld(), Centroid + zOffset, Centroid + FVector(0, 0, SnowHeightMM / 10) + zOffset, FColor(255, 0, 0), false, -1, 0, 0.0f);
 			}
 		}
 	}
 
 	// Render debug strings
-	int Index = 0;
-	for (auto& Cell : DebugCells)
+	for (int32 Index = 0; Index < Field.Num(); Index++)
 	{
-		auto Offset = Cell.Normal;
+		FVector P1, P2, P3, P4;
+		Field.GetCorners(Index, P1, P2, P3, P4);
+
+		auto Offset = FVector::CrossProduct(P2 - P1, P3 - P1);
 		Offset.Normalize();
 
 		// @TODO get position from heightmap
 		Offset *= 10;
 
-		if (FVector::Dist(Cell.P1 + Offset, Location) < CellDebugInfoDisplayDistance)
+		if (FVector::Dist(P1 + Offset, Location) < CellDebugInfoDisplayDistance)
 		{
 			FCollisionQueryParams TraceParams(FName(TEXT("Trace SWE")), true);
 			TraceParams.bTraceComplex = true;
@@ -383,61 +562,40 @@ void ASnowSimulationActor::DoRenderDebugInformation()
 
 			FHitResult HitOut(ForceInit);
 
-			GetWorld()->LineTraceSingleByChannel(HitOut, Location, Cell.P1 + Offset, ECC_WorldStatic, TraceParams);
+			GetWorld()->LineTraceSingleByChannel(HitOut, Location, P1 + Offset, ECC_WorldStatic, TraceParams);
 
 			auto Hit = HitOut.GetActor();
 
 			//Hit any Actor?
 			if (Hit == NULL)
 			{
+				const FVector Centroid = (P1 + P2 + P3 + P4) / 4;
+
 				switch (DebugVisualizationType)
 				{
 				case EDebugVisualizationType::SnowHeight:
-					{
-						// Sample snow height from CPU buffer instead of Cell.SnowMM
-						float SnowHeightMM = 0.0f;
-						if (CpuDepthMeters.Num() > 0)
-						{
-							// Convert world position to grid coordinates
-							const FVector2D GridPos = FVector2D(
-								(Cell.Centroid.X - Landscape->GetActorLocation().X) / (Landscape->GetActorScale().X * CellSize),
-								(Cell.Centroid.Y - Landscape->GetActorLocation().Y) / (Landscape->GetActorScale().Y * CellSize)
-							);
-							
-							const int32 GridX = FMath::Clamp(FMath::RoundToInt(GridPos.X), 0, CellsDimensionX - 1);
-							const int32 GridY = FMath::Clamp(FMath::RoundToInt(GridPos.Y), 0, CellsDimensionY - 1);
-							const int32 CellIndex = GridY * CellsDimensionX + GridX;
-							
-							if (CpuDepthMeters.IsValidIndex(CellIndex))
-							{
-								SnowHeightMM = CpuDepthMeters[CellIndex] * 1000.0f; // Convert meters to mm
-							}
-						}
-						DrawDebugString(GetWorld(), Cell.Centroid, FString::FromInt(static_cast<int>(SnowHeightMM)) + " mm", nullptr, FColor::Purple, 0, true);
-					}
+					DrawDebugString(GetWorld(), Centroid, FString::FromInt(static_cast<int>(GetSnowHeightMM(Index))) + " mm", nullptr, FColor::Purple, 0, true);
 					break;
 				case EDebugVisualizationType::Position:
-					DrawDebugString(GetWorld(), Cell.Centroid, "(" + FString::FromInt(static_cast<int>(Cell.Centroid.X / 100)) + "/" + FString::FromInt(static_cast<int>(Cell.Centroid.Y / 100)) + ")", nullptr, FColor::Purple, 0, true);
+					DrawDebugString(GetWorld(), Centroid, "(" + FString::FromInt(static_cast<int>(Centroid.X / 100)) + "/" + FString::FromInt(static_cast<int>(Centroid.Y / 100)) + ")", nullptr, FColor::Purple, 0, true);
 					break;
 				case EDebugVisualizationType::Altitude:
-					DrawDebugString(GetWorld(), Cell.Centroid, FString::FromInt(static_cast<int>(Cell.Altitude / 100)) + "m", nullptr, FColor::Purple, 0, true);
+					DrawDebugString(GetWorld(), Centroid, FString::FromInt(static_cast<int>(Field.Altitude[Index] / 100)) + "m", nullptr, FColor::Purple, 0, true);
 					break;
 				case EDebugVisualizationType::Index:
-					DrawDebugString(GetWorld(), Cell.Centroid, FString::FromInt(Index), nullptr, FColor::Purple, 0, true);
+					DrawDebugString(GetWorld(), Centroid, FString::FromInt(Index), nullptr, FColor::Purple, 0, true);
 					break;
 				case EDebugVisualizationType::Aspect:
-					DrawDebugString(GetWorld(), Cell.Centroid, FString::FromInt(static_cast<int>(FMath::RadiansToDegrees(Cell.Aspect))), nullptr, FColor::Purple, 0, true);
+					DrawDebugString(GetWorld(), Centroid, FString::FromInt(static_cast<int>(FMath::RadiansToDegrees(Field.Aspect[Index]))), nullptr, FColor::Purple, 0, true);
 					break;
 				case EDebugVisualizationType::Curvature:
-					DrawDebugString(GetWorld(), Cell.Centroid, FString::SanitizeFloat(Cell.Curvature), nullptr, FColor::Purple, 0, true);
+					DrawDebugString(GetWorld(), Centroid, FString::SanitizeFloat(Field.Curvature[Index]), nullptr, FColor::Purple, 0, true);
 					break;
 				default:
 					break;
 				}
 			}
 		}
-
-		Index++;
 	}
 }
 
@@ -468,26 +626,61 @@ void ASnowSimulationActor::Initialize()
 			CellsDimensionY = OverallResolutionY / CellSize - 1; // -1 because we create cells and use 4 vertices
 			NumCells = CellsDimensionX * CellsDimensionY;
 
-			DebugCells.Reserve(CellsDimensionX * CellsDimensionY);
-			LandscapeCells.Reserve(CellsDimensionX * CellsDimensionY);
+			// Update shader
+			SetScalarParameterValue(Landscape, Param_CellsDimensionX, CellsDimensionX);
+			SetScalarParameterValue(Landscape, Param_CellsDimensionY, CellsDimensionY);
+			SetScalarParameterValue(Landscape, Param_ResolutionX, OverallResolutionX);
+			SetScalarParameterValue(Landscape, Param_ResolutionY, OverallResolutionY);
+
+			// A streamed domain samples the landscape page by page (see SampleLandscapeRegion), no full cell field is built
+			if (bStreamDomain)
+			{
+				CellField.Reset();
+				UE_LOG(SimulationLog, Display, TEXT("Cell field: %d cells, streamed in pages of %d cells"), NumCells, StreamPageSize);
+				return;
+			}
 
 			TArray<FVector> CellWorldVertices;
 			CellWorldVertices.SetNumUninitialized(OverallResolutionX * OverallResolutionY);
 
+			// Vertices cut out by the landscape visibility layer (holes)
+			TBitArray<> VertexHoles(false, CellWorldVertices.Num());
+
 			float MinAltitude = 1e6;
 			float MaxAltitude = 0;
 			for (auto Component : LandscapeComponents)
 			{
 				// @TODO use runtime compatible version
 				FLandscapeComponentDataInterface LandscapeData(Component);
+
+				TArray<uint8> HoleWeights;
+				bool bComponentHoles = false;
+#if WITH_EDITOR
+				// One weight per vertex, subsections share their edge vertices so the duplicates have to be removed
+				if (ALandscapeProxy::VisibilityLayer
+					&& LandscapeData.GetWeightmapTextureData(ALandscapeProxy::VisibilityLayer, HoleWeights, /*bUseEditingWeightmap=*/false, /*bRemoveSubsectionDuplicates=*/true))
+				{
+					bComponentHoles = HoleWeights.Num() == FMath::Square(Component->ComponentSizeQuads + 1);
+					UE_CLOG(!bComponentHoles, LogTemp, Warning, TEXT("[Snow] Ignoring holes of %s, visibility weightmap has %d values for %d vertices"),
+						*Component->GetName(), HoleWeights.Num(), FMath::Square(Component->ComponentSizeQuads + 1));
+				}
+#endif
+
 				for (int32 Y = 0; Y < Component->ComponentSizeQuads; Y++) // not +1 because the vertices are stored twice (first and last)
 				{
 					for (int32 X = 0; X < Component->ComponentSizeQuads; X++) // not +1 because the vertices are stored twice (first and last)
 					{
 						auto Vertex = LandscapeData.GetWorldVertex(X, Y);
-						CellWorldVertices[Component->SectionBaseX + X + OverallResolutionX * Y + Component->SectionBaseY * OverallResolutionX] = Vertex;
+						const int32 VertexIndex = Component->SectionBaseX + X + OverallResolutionX * Y + Component->SectionBaseY * OverallResolutionX;
+						CellWorldVertices[VertexIndex] = Vertex;
 						MinAltitude = FMath::Min(MinAltitude, Vertex.Z);
 						MaxAltitude = FMath::Max(MaxAltitude, Vertex.Z);
+
+						// A visibility weight above one half hides the vertex
+						if (bComponentHoles && HoleWeights[X + Y * (Component->ComponentSizeQuads + 1)] > 127)
+						{
+							VertexHoles[VertexIndex] = true;
+						}
 					}
 				}
 			}
@@ -546,119 +739,44 @@ void ASnowSimulationActor::Initialize()
 			}
 			*/
 
-			// Create Cells
-			int Index = 0;
-			for (int32 Y = 0; Y < CellsDimensionY; Y++)
+			// Create Cells: only the cell corners are kept, all other geometry is derived by the cell field
+			const int32 ResolutionX = static_cast<int32>(OverallResolutionX);
+			const int32 CornerStride = CellsDimensionX + 1;
+			TArray<FVector3f> Corners;
+			Corners.SetNumUninitialized(CornerStride * (CellsDimensionY + 1));
+			for (int32 Y = 0; Y <= CellsDimensionY; Y++)
 			{
-				for (int32 X = 0; X < CellsDimensionX; X++)
+				for (int32 X = 0; X <= CellsDimensionX; X++)
 				{
-					auto VertexX = X * CellSize;
-					auto VertexY = Y * CellSize;
-					FVector P0 = CellWorldVertices[VertexY * OverallResolutionX + VertexX];
-					FVector P1 = CellWorldVertices[VertexY * OverallResolutionX + (VertexX + CellSize)];
-					FVector P2 = CellWorldVertices[(VertexY + CellSize) * OverallResolutionX + VertexX];
-					FVector P3 = CellWorldVertices[(VertexY + CellSize) * OverallResolutionX + (VertexX + CellSize)];
-
-					FVector Normal = FVector::CrossProduct(P1 - P0, P2 - P0);
-					FVector Centroid = FVector((P0.X + P1.X + P2.X + P3.X) / 4, (P0.Y + P1.Y + P2.Y + P3.Y) / 4, (P0.Z + P1.Z + P2.Z + P3.Z) / 4);
-
-					float Altitude = Centroid.Z;
-
-					float Area = FMath::Abs(FVector::CrossProduct(P0 - P3, P1 - P3).Size() / 2 + FVector::CrossProduct(P2 - P3, P0 - P3).Size() / 2);
-
-					float AreaXY = FMath::Abs(FVector2D::CrossProduct(FVector2D(P0 - P3), FVector2D(P1 - P3)) / 2
-						+ FVector2D::CrossProduct(FVector2D(P2 - P3), FVector2D(P0 - P3)) / 2);
-
-					FVector P0toP3 = P3 - P0;
-					FVector P0toP3ProjXY = FVector(P0toP3.X, P0toP3.Y, 0);
-					float Inclination = IsAlmostZero(P0toP3.Size()) ? 0 : FMath::Abs(FMath::Acos(FVector::DotProduct(P0toP3, P0toP3ProjXY) / (P0toP3.Size() * P0toP3ProjXY.Size())));
-
-					// @TODO assume constant for the moment, later handle in input data
-					const float CellLatitude = FMath::DegreesToRadians(47);
-
-					// @TODO what is the aspect of the XY plane?
-					
-					
-					FVector2D NormalProjXY = FVector2D(Normal.X, Normal.Y);
-					FVector2D North2D = FVector2D(1, 0);
-					float Dot = FVector2D::DotProduct(NormalProjXY, North2D);
-					float Det = NormalProjXY.X * North2D.Y - NormalProjXY.Y*North2D.X;
-					float Aspect = FMath::Atan2(Det, Dot);
-					Aspect = NormalizeAngle360(Aspect);
-					
-					//float Aspect = IsAlmostZero(NormalProjXY.Size()) ? 0 : FMath::Abs(FMath::Acos(FVector::DotProduct(North, NormalProjXY) / NormalProjXY.Size()));
-
-					// Initial conditions
-					float SnowWaterEquivalent = 0.0f;
-					if (Altitude / 100.0f > 3300.0f)
-					{
-						auto AreaSquareMeters = Area / (100 * 100);
-						float we = (2.5 + Altitude / 100 * 0.001) * AreaSquareMeters;
-
-						SnowWaterEquivalent = we;
-
-						InitialMaxSnow = FMath::Max(SnowWaterEquivalent / AreaSquareMeters, InitialMaxSnow);
-					}
-
-					// Create cells
-					FLandscapeCell Cell(Index, P0, P1, P2, P3, Normal, Area, AreaXY, Centroid, Altitude, Aspect, Inclination, Latitude, SnowWaterEquivalent);
-					LandscapeCells.Add(Cell);
-
-					FDebugCell DebugCell(P0, P1, P2, P3, Centroid, Normal, Altitude, Aspect);
-					DebugCells.Add(DebugCell);
-
-					Index++;
+					Corners[X + Y * CornerStride] = FVector3f(CellWorldVertices[(Y * CellSize) * ResolutionX + X * CellSize]);
 				}
 			}
 
-		
-			// Calculate curvature
-			for (int32 CellIndexY = 0; CellIndexY < CellsDimensionY; ++CellIndexY)
+			// A cell is a hole if the landscape vertex at its center is, holes are excluded from the simulation
+			TBitArray<> CellHoles(false, CellsDimensionX * CellsDimensionY);
+			int32 NumHoleCells = 0;
+			for (int32 Y = 0; Y < CellsDimensionY; Y++)
 			{
-				for (int32 CellIndexX = 0; CellIndexX < CellsDimensionX; ++CellIndexX)
+				for (int32 X = 0; X < CellsDimensionX; X++)
 				{
-					FLandscapeCell& Cell = LandscapeCells[CellIndexX + CellsDimensionX * CellIndexY];
-					FLandscapeCell* Neighbours[8];
-
-					Neighbours[0] = GetCellChecked(CellIndexX, CellIndexY - 1);						// N
-					Neighbours[1] = GetCellChecked(CellIndexX + 1, CellIndexY - 1);					// NE
-					Neighbours[2] = GetCellChecked(CellIndexX + 1, CellIndexY);						// E
-					Neighbours[3] = GetCellChecked(CellIndexX + 1, CellIndexY + 1);					// SE
-
-					Neighbours[4] = GetCellChecked(CellIndexX, CellIndexY + 1);						// S
-					Neighbours[5] = GetCellChecked(CellIndexX - 1, CellIndexY + 1); 				// SW
-					Neighbours[6] = GetCellChecked(CellIndexX - 1, CellIndexY);						// W
-					Neighbours[7] = GetCellChecked(CellIndexX - 1, CellIndexY - 1);					// NW
-
-					if (Neighbours[0] == nullptr || Neighbours[1] == nullptr || Neighbours[2] == nullptr || Neighbours[3] == nullptr
-						|| Neighbours[4] == nullptr || Neighbours[5] == nullptr || Neighbours[6] == nullptr || Neighbours[7] == nullptr) continue;
-
-					float Z1 = Neighbours[1]->Altitude / 100; // NW
-					float Z2 = Neighbours[0]->Altitude / 100; // N
-					float Z3 = Neighbours[7]->Altitude / 100; // NE
-					float Z4 = Neighbours[2]->Altitude / 100; // W
-					float Z5 = Cell.Altitude / 100;
-					float Z6 = Neighbours[6]->Altitude / 100; // E
-					float Z7 = Neighbours[3]->Altitude / 100; // SW	
-					float Z8 = Neighbours[4]->Altitude / 100; // S
-					float Z9 = Neighbours[5]->Altitude / 100; // SE
-
-					float D = ((Z4 + Z6) / 2 - Z5) / (L * L);
-					float E = ((Z2 + Z8) / 2 - Z5) / (L * L);
-					Cell.Curvature = 2 * (D + E);
+					const int32 CenterIndex = (Y * CellSize + CellSize / 2) * ResolutionX + X * CellSize + CellSize / 2;
+					if (VertexHoles[CenterIndex])
+					{
+						CellHoles[X + Y * CellsDimensionX] = true;
+						++NumHoleCells;
+					}
 				}
 			}
 
+			// @TODO assume constant latitude for the moment, later handle in input data
+			CellField = MakeShared<FSnowCellField>();
+			InitialMaxSnow = CellField->Build(CellsDimensionX, CellsDimensionY, MoveTemp(Corners), Latitude, L, MoveTemp(CellHoles));
+
+			UE_LOG(SimulationLog, Display, TEXT("Cell field: %d cells (%d holes), %.1f MB"), CellField->Num(), NumHoleCells, CellField->GetAllocatedSize() / (1024.0 * 1024.0));
 			UE_LOG(SimulationLog, Display, TEXT("Num components: %d"), LandscapeComponents.Num());
 			UE_LOG(SimulationLog, Display, TEXT("Num subsections: %d"), Landscape->NumSubsections);
 			UE_LOG(SimulationLog, Display, TEXT("SubsectionSizeQuads: %d"), Landscape->SubsectionSizeQuads);
 			UE_LOG(SimulationLog, Display, TEXT("ComponentSizeQuads: %d"), Landscape->ComponentSizeQuads);
-
-			// Update shader
-			SetScalarParameterValue(Landscape, Param_CellsDimensionX, CellsDimensionX);
-			SetScalarParameterValue(Landscape, Param_CellsDimensionY, CellsDimensionY);
-			SetScalarParameterValue(Landscape, Param_ResolutionX, OverallResolutionX);
-			SetScalarParameterValue(Landscape, Param_ResolutionY, OverallResolutionY);
 		}
 		else
 		{
@@ -669,6 +787,8 @@ void ASnowSimulationActor::Initialize()
 
 void ASnowSimulationActor::UpdateMaterialTexture()
 {
+	SNOW_SCOPE(MaterialBinding);
+
 	if (!Simulation) return;
 
 	// Prefer USnowSimulation texture path
@@ -996,6 +1116,7 @@ void ASnowSimulationActor::PostEditChangeProperty(FPropertyChangedEvent& Propert
 	FName PropertyName = (PropertyChangedEvent.Property != nullptr) ? PropertyChangedEvent.Property->GetFName() : NAME_None;
 
 	if ((PropertyName == GET_MEMBER_NAME_CHECKED(ASnowSimulationActor, CellSize))) {
+		FlushAsyncStep();
 		Initialize();
 	}
 }
@@ -1091,6 +1212,10 @@ bool ASnowSimulationActor::ValidateMaterialParameters(UMaterialInterface* BaseMa
 
 void ASnowSimulationActor::StepSimulation(float dtSeconds)
 {
+	SNOW_SCOPE(StepSimulation);
+
+	FlushAsyncStep();
+
 	// Accumulate simulated seconds towards weather step size
 	SimulatedSecondsAccumulator += dtSeconds;
 
@@ -1104,81 +1229,130 @@ void ASnowSimulationActor::StepSimulation(float dtSeconds)
 
 	static bool bLoggedWeatherUnits = false;
 
-	for (int32 StepIdx = 0; StepIdx < NumSteps; ++StepIdx)
+	auto AdvanceWeatherStep = [this](FDateTime& Time, int32& Step)
 	{
-		FWeatherForcingData WeatherForcing;
-		if (WeatherProvider)
-		{
-			WeatherForcing = WeatherProvider->GetWeatherForcing(CurrentSimulationTime);
-		}
+		Time += FTimespan(0, 0, 0, 0, FMath::RoundToInt(TimeStepSeconds));
+		Step += FMath::RoundToInt(TimeStepSeconds / 3600.0f);
 
-		if (!bLoggedWeatherUnits)
+		if (bLoopTime && Time >= SimulationEnd)
 		{
-			UE_LOG(LogTemp, Display, TEXT("[Snow] Weather units: T(K)=%.1f, SWdown(W/m²)=%.0f, LWdown(W/m²)=%.0f, Wind(m/s)=%.1f, RH(0-1)=%.2f, PrecipRate(kg/m²/s)=%.6f, SnowFrac(0-1)=%.2f"),
-			   WeatherForcing.Temperature_K, WeatherForcing.SWdown_Wm2, WeatherForcing.LWdown_Wm2,
-			   WeatherForcing.Wind_mps, WeatherForcing.RH_01, WeatherForcing.PrecipRate_kgm2s, WeatherForcing.SnowFrac_01);
-			bLoggedWeatherUnits = true;
+			Time = SimulationStart;
+			Step = 0;
+			return true;
 		}
+		return false;
+	};
 
-		if (Simulation)
+	// Sample the forcing of every step up front so spans of quiescent weather can be fast-forwarded at once
+	TArray<FWeatherForcingData> Forcing;
+	Forcing.SetNum(NumSteps);
+	FDateTime Time = CurrentSimulationTime;
+	int32 Step = CurrentSimulationStep;
+	const bool bConstantForcing = WeatherProvider && WeatherProvider->IsForcingConstant();
+	{
+		SNOW_SCOPE(ForcingFetch);
+		for (int32 StepIdx = 0; StepIdx < NumSteps; ++StepIdx)
 		{
-			// If the simulation derives from USnowSimulation, use its Step/Upload path
-			if (USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation))
+			if (WeatherProvider)
 			{
-				SnowSim->Step(TimeStepSeconds, WeatherForcing, SnowSim->DepthMeters);
-				SnowSim->UploadDepthToTexture();
-				
-				// Sync CPU buffer with simulation data for HUD display
-				UpdateCpuDepthMeters(SnowSim->DepthMeters);
-				
-				// Stats logging for visibility
-				float MinV = FLT_MAX, MaxV = -FLT_MAX; double Sum = 0.0; int32 Count = SnowSim->DepthMeters.Num();
-				for (int32 i = 0; i < Count; ++i) { float v = SnowSim->DepthMeters[i]; MinV = FMath::Min(MinV, v); MaxV = FMath::Max(MaxV, v); Sum += v; }
-				float Mean = (Count > 0) ? static_cast<float>(Sum / Count) : 0.0f;
-				UE_LOG(LogTemp, Display, TEXT("[Snow] DepthTex min=%.4f m, max=%.4f m, mean=%.4f m"), MinV, MaxV, Mean);
-				
-				// Log HUD stats for CPU buffer
-				if (CpuDepthMeters.Num() > 0)
-				{
-					float CpuMinV = FLT_MAX, CpuMaxV = -FLT_MAX;
-					for (int32 i = 0; i < CpuDepthMeters.Num(); ++i) 
-					{ 
-						const float v = CpuDepthMeters[i]; 
-						CpuMinV = FMath::Min(CpuMinV, v); 
-						CpuMaxV = FMath::Max(CpuMaxV, v); 
-					}
-					UE_LOG(LogTemp, Display, TEXT("[Snow][HUD] CPUbuf min/max(mm)=%.1f/%.1f, tex size=%dx%d"), 
-						CpuMinV * 1000.0f, CpuMaxV * 1000.0f, CellsDimensionX, CellsDimensionY);
-				}
+				Forcing[StepIdx] = (bConstantForcing && StepIdx > 0) ? Forcing[0] : WeatherProvider->GetWeatherForcing(Time);
 			}
-			else
+			if (AdvanceWeatherStep(Time, Step))
 			{
-				// Fallback to legacy Simulate API
+				UE_LOG(LogTemp, Display, TEXT("[Snow] Time looped back to start"));
+			}
+		}
+	}
+
+	if (!bLoggedWeatherUnits)
+	{
+		const FWeatherForcingData& WeatherForcing = Forcing[0];
+		UE_LOG(LogTemp, Display, TEXT("[Snow] Weather units: T(K)=%.1f, SWdown(W/m²)=%.0f, LWdown(W/m²)=%.0f, Wind(m/s)=%.1f, RH(0-1)=%.2f, PrecipRate(kg/m²/s)=%.6f, SnowFrac(0-1)=%.2f"),
+		   WeatherForcing.Temperature_K, WeatherForcing.SWdown_Wm2, WeatherForcing.LWdown_Wm2,
+		   WeatherForcing.Wind_mps, WeatherForcing.RH_01, WeatherForcing.PrecipRate_kgm2s, WeatherForcing.SnowFrac_01);
+		bLoggedWeatherUnits = true;
+	}
+
+	if (StreamedDomain.IsInitialized())
+	{
+		StepStreamedDomain(TimeStepSeconds, Forcing);
+	}
+	else if (Simulation)
+	{
+		// If the simulation derives from USnowSimulation, use its Step/Upload path
+		if (USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation))
+		{
+			// Quiescent spans cost a single update, only precipitation and melt are stepped hourly
+			const int32 NumFullSteps = SnowSim->StepSpan(TimeStepSeconds, Forcing, SnowSim->DepthMeters, CVarSnowFastForward.GetValueOnGameThread() != 0);
+			UE_LOG(LogTemp, Verbose, TEXT("[Snow] Advanced %d steps, %d stepped, %d fast-forwarded"), NumSteps, NumFullSteps, NumSteps - NumFullSteps);
+
+			SnowSim->UploadDepthToTexture();
+
+			// Sync CPU buffer with simulation data for HUD display
+			UpdateCpuDepthMeters(SnowSim->DepthMeters);
+
+			// Stats come from the step kernels, no extra pass over the grid
+			ApplyStepStats(SnowSim->EnsureStepStats(SnowSim->DepthMeters), NumSteps);
+		}
+		else
+		{
+			// Fallback to legacy Simulate API, which reads the actor's clock and is stepped hourly
+			for (int32 StepIdx = 0; StepIdx < NumSteps; ++StepIdx)
+			{
+				SNOW_SCOPE(Kernel);
+				SnowStats::AddCellsStepped(NumCells);
 				Simulation->Simulate(this, this->CurrentSimulationStep, Timesteps, SaveMaterialTextures, DebugVisualizationType != EDebugVisualizationType::Nothing, DebugCells);
 				if (Landscape)
 				{
 					SetScalarParameterValue(Landscape, Param_MaxSnow, Simulation->GetMaxSnow());
 				}
+				if (StepIdx + 1 < NumSteps)
+				{
+					AdvanceWeatherStep(CurrentSimulationTime, this->CurrentSimulationStep);
+				}
 			}
 		}
-
-		CurrentSimulationTime += FTimespan(0, 0, 0, 0, FMath::RoundToInt(TimeStepSeconds));
-		this->CurrentSimulationStep += FMath::RoundToInt(TimeStepSeconds / 3600.0f);
-
-		if (bLoopTime && CurrentSimulationTime >= SimulationEnd)
-		{
-			CurrentSimulationTime = SimulationStart;
-			this->CurrentSimulationStep = 0;
-			UE_LOG(LogTemp, Display, TEXT("[Snow] Time looped back to start"));
-		}
 	}
 
+	CurrentSimulationTime = Time;
+	this->CurrentSimulationStep = Step;
+
 	// After steps, update material instance parameters using the current snow map texture
 	UpdateMaterialTexture();
 }
 
+void ASnowSimulationActor::ApplyStepStats(const FSnowStepStats& Stats, int32 NumSteps)
+{
+	LastStepStats = Stats;
+
+	UE_LOG(LogTemp, Display, TEXT("[Snow] Depth min/max/mean = %.4f / %.4f / %.4f m, covered %d/%d cells, SWE %.0f mm (%d steps)"),
+		Stats.MinDepth, Stats.MaxDepth, Stats.GetMeanDepth(), Stats.SnowCoveredCells, Stats.NumCells, Stats.SumSWE_mm, NumSteps);
+
+	// Every material that samples the depth texture normalizes it by MaxSnow
+	const float MaxSnowMM = Stats.MaxDepth * 1000.0f;
+	if (SnowMID)
+	{
+		SnowMID->SetScalarParameterValue(Param_MaxSnow, MaxSnowMM);
+	}
+	if (VHMMaterialInstance)
+	{
+		VHMMaterialInstance->SetScalarParameterValue(Param_MaxSnow, MaxSnowMM);
+	}
+	if (Landscape)
+	{
+		SetScalarParameterValue(Landscape, Param_MaxSnow, MaxSnowMM);
+	}
+}
+
 void ASnowSimulationActor::LogDepthStats()
 {
+	// The published statistics describe CpuDepthMeters, the simulation's own ones may belong to a step in flight
+	if (LastStepStats.IsValidFor(CpuDepthMeters.Num()))
+	{
+		UE_LOG(LogTemp, Display, TEXT("[Snow] DepthTex min=%.4f m, max=%.4f m, mean=%.4f m"), LastStepStats.MinDepth, LastStepStats.MaxDepth, LastStepStats.GetMeanDepth());
+		return;
+	}
+
 	if (CpuDepthMeters.Num() == 0) return;
 	float MinV = FLT_MAX;
 	float MaxV = -FLT_MAX;
@@ -1195,16 +1369,20 @@ void ASnowSimulationActor::LogDepthStats()
 	UE_LOG(LogTemp, Display, TEXT("[Snow] DepthTex min=%.4f m, max=%.4f m, mean=%.4f m"), MinV, MaxV, Mean);
 }
 
-void ASnowSimulationActor::UploadDepthToTexture()
+void ASnowSimulationActor::UploadDepthToTexture(bool bLogStats)
 {
+	SNOW_SCOPE(Upload);
+
 	if (CpuDepthMeters.Num() != CellsDimensionX * CellsDimensionY)
 	{
 		return;
 	}
 
+	const bool bNewTexture = !SnowDepthTexture;
 	if (!SnowDepthTexture)
 	{
 		SnowDepthTexture = UTexture2D::CreateTransient(CellsDimensionX, CellsDimensionY, EPixelFormat::PF_R16F);
+		DepthTextureDirtyTiles.Invalidate();
 		SnowDepthTexture->SRGB = false;
 		SnowDepthTexture->CompressionSettings = TC_HDR;
 		SnowDepthTexture->LODGroup = TEXTUREGROUP_Pixels2D;
@@ -1220,24 +1398,27 @@ void ASnowSimulationActor::UploadDepthToTexture()
 			SnowDepthTexture->GetSizeX(), SnowDepthTexture->GetSizeY());
 	}
 
-	UTexture2D* TextureToUpdate = SnowDepthTexture;
-	// Upload with correct half-float stride using UpdateTextureRegions
-	FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(0, 0, 0, 0, CellsDimensionX, CellsDimensionY);
-	const uint32 SrcBpp = sizeof(FFloat16);
-	const uint32 SrcPitch = CellsDimensionX * sizeof(FFloat16);
-	// Allocate heap buffer; copy half values
-	const int32 Count = CellsDimensionX * CellsDimensionY;
-	FFloat16* HalfData = new FFloat16[Count];
-	for (int32 i = 0; i < Count; ++i)
+	// Only the tiles the simulation changed since the last upload are sent
+	const USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation);
+	if (StreamedDomain.IsInitialized() && !bNewTexture)
 	{
-		HalfData[i] = CpuDepthMeters.IsValidIndex(i) ? CpuDepthMeters[i] : FFloat16(0.0f);
+		// DepthUploadRegions holds the pages StepStreamedDomain just published
 	}
-	auto Cleanup = [](uint8* SrcData, const FUpdateTextureRegion2D* Regions)
+	else if (SnowSim && SnowSim->GridX == CellsDimensionX && SnowSim->GridY == CellsDimensionY)
 	{
-		delete[] reinterpret_cast<FFloat16*>(SrcData);
-		delete Regions;
-	};
-	TextureToUpdate->UpdateTextureRegions(0, 1, Region, SrcPitch, SrcBpp, reinterpret_cast<uint8*>(HalfData), Cleanup);
+		SnowSim->ConsumeDirtyRegions(DepthTextureDirtyTiles, DepthUploadRegions);
+	}
+	else
+	{
+		DepthTextureDirtyTiles.Invalidate();
+		DepthUploadRegions.Reset();
+		FSnowTile& Full = DepthUploadRegions.AddDefaulted_GetRef();
+		Full.X1 = CellsDimensionX;
+		Full.Y1 = CellsDimensionY;
+	}
+
+	// Copied into a persistent staging buffer and from there into the texture on the render thread
+	DepthUploadRing.Upload(SnowDepthTexture, CellsDimensionX, CellsDimensionY, CpuDepthMeters, DepthUploadRegions);
 
 	// Bind for preview and log stats
 	if (Landscape)
@@ -1245,7 +1426,10 @@ void ASnowSimulationActor::UploadDepthToTexture()
 		SetTextureParameterValue(Landscape, Param_SnowDepthTex, SnowDepthTexture, GEngine);
 		UE_LOG(LogTemp, Display, TEXT("[Snow] Landscape SetParam SnowDepthTex=Texture"));
 	}
-	LogDepthStats();
+	if (bLogStats)
+	{
+		LogDepthStats();
+	}
 }
 
 void ASnowSimulationActor::DebugFillDepth(float MaxDepthMeters /*= 0.2f*/)
@@ -1267,9 +1451,13 @@ void ASnowSimulationActor::DebugFillDepth(float MaxDepthMeters /*= 0.2f*/)
 		return;
 	}
 
+	// The worker must not overwrite the debug ramp
+	FlushAsyncStep();
+
 	if (USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation))
 	{
 		// Fill a linear X ramp into the sim's depth buffer and upload
+		SnowSim->ResolveCellState();
 		TArray<float>& H = SnowSim->DepthMeters;
 		const int32 Wd = SnowSim->GridX;
 		const int32 Hg = SnowSim->GridY;
@@ -1282,6 +1470,8 @@ void ASnowSimulationActor::DebugFillDepth(float MaxDepthMeters /*= 0.2f*/)
 					H[y * Wd + x] = (static_cast<float>(x) / static_cast<float>(Wd - 1)) * MaxDepthMeters;
 				}
 			}
+			SnowSim->MarkAllTilesDirty();
+			ApplyStepStats(SnowSim->EnsureStepStats(H), 0);
 			SnowSim->UploadDepthToTexture();
 			UpdateMaterialTexture();
 			UE_LOG(LogTemp, Display, TEXT("[Snow] DebugFillDepth max=%.3f m"), MaxDepthMeters);
@@ -1379,56 +1569,311 @@ void ASnowSimulationActor::PrintStatus()
 		UE_LOG(LogTemp, Display, TEXT("SnowMID Material: Not created"));
 	}
 	
-	// Depth statistics (CPU-side if available)
-	if (CpuDepthMeters.Num() > 0)
+	// Depth statistics, reduced by the step kernels instead of rescanning the field
+	FlushAsyncStep();
+	if (USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation))
 	{
-		float MinV = FLT_MAX, MaxV = -FLT_MAX;
-		double Sum = 0.0;
-		int32 Count = CpuDepthMeters.Num();
-		
-		for (int32 i = 0; i < Count; ++i)
+		if (SnowSim->DepthMeters.Num() > 0)
 		{
-			const float v = CpuDepthMeters[i];
-			MinV = FMath::Min(MinV, v);
-			MaxV = FMath::Max(MaxV, v);
-			Sum += v;
+			const FSnowStepStats& Stats = SnowSim->EnsureStepStats(SnowSim->DepthMeters);
+			UE_LOG(LogTemp, Display, TEXT("Simulation Depth Stats: min=%.4f m, max=%.4f m, mean=%.4f m"), Stats.MinDepth, Stats.MaxDepth, Stats.GetMeanDepth());
+		}
+		else
+		{
+			UE_LOG(LogTemp, Display, TEXT("Simulation Depth Stats: No data available"));
 		}
-		
-		float Mean = (Count > 0) ? static_cast<float>(Sum / Count) : 0.0f;
-		UE_LOG(LogTemp, Display, TEXT("CPU Depth Stats: min=%.4f m, max=%.4f m, mean=%.4f m"), MinV, MaxV, Mean);
+	}
+	else if (LastStepStats.IsValidFor(CpuDepthMeters.Num()))
+	{
+		UE_LOG(LogTemp, Display, TEXT("CPU Depth Stats: min=%.4f m, max=%.4f m, mean=%.4f m"), LastStepStats.MinDepth, LastStepStats.MaxDepth, LastStepStats.GetMeanDepth());
 	}
 	else
 	{
 		UE_LOG(LogTemp, Display, TEXT("CPU Depth Stats: No data available"));
 	}
 	
-	// Simulation-specific depth stats
-	if (USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation))
+	UE_LOG(LogTemp, Display, TEXT("=== END STATUS ==="));
+}
+
+bool ASnowSimulationActor::GetCheckpointState(FSnowCheckpointState& State)
+{
+	// Checkpoint the published front buffer, not a half finished step
+	FlushAsyncStep();
+
+	USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation);
+	if (StreamedDomain.IsInitialized())
 	{
-		if (SnowSim->DepthMeters.Num() > 0)
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Checkpoint: streamed domains are not checkpointed, their pages live in the page file."));
+		return false;
+	}
+	if (!SnowSim || SnowSim->DepthMeters.Num() != SnowSim->GridX * SnowSim->GridY)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Checkpoint: no initialized snow simulation to save."));
+		return false;
+	}
+
+	SnowSim->ResolveCellState();
+	State.GridX = SnowSim->GridX;
+	State.GridY = SnowSim->GridY;
+	State.SimulationTime = CurrentSimulationTime;
+	State.SimulationStep = CurrentSimulationStep;
+	State.Columns[static_cast<uint32>(ESnowCheckpointColumn::DepthMeters)] = SnowSim->DepthMeters;
+	if (CellField.IsValid() && CellField->Num() == SnowSim->DepthMeters.Num())
+	{
+		State.Columns[static_cast<uint32>(ESnowCheckpointColumn::SWE)] = MakeArrayView(CellField->SWE.GetData(), CellField->SWE.Num());
+		State.Columns[static_cast<uint32>(ESnowCheckpointColumn::Albedo)] = MakeArrayView(CellField->Albedo.GetData(), CellField->Albedo.Num());
+		State.Columns[static_cast<uint32>(ESnowCheckpointColumn::Age)] = MakeArrayView(CellField->Age.GetData(), CellField->Age.Num());
+	}
+
+	return true;
+}
+
+bool ASnowSimulationActor::RestoreCheckpoint(const FSnowCheckpointView& Checkpoint)
+{
+	// The worker must not overwrite the restored state
+	FlushAsyncStep();
+
+	USnowSimulation* SnowSim = Cast<USnowSimulation>(Simulation);
+	const FSnowCheckpointHeader& Header = Checkpoint.GetHeader();
+	if (!SnowSim || Header.GridX != SnowSim->GridX || Header.GridY != SnowSim->GridY)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Checkpoint: grid %dx%d does not match the simulation (%dx%d)."),
+			Header.GridX, Header.GridY, SnowSim ? SnowSim->GridX : 0, SnowSim ? SnowSim->GridY : 0);
+		return false;
+	}
+
+	// Deferred updates must land before the columns are replaced, not on top of the restored state
+	SnowSim->ResolveCellState();
+	const int32 Count = Header.GridX * Header.GridY;
+	SnowSim->DepthMeters.SetNumUninitialized(Count, EAllowShrinking::No);
+	if (!Checkpoint.CopyColumn(ESnowCheckpointColumn::DepthMeters, SnowSim->DepthMeters.GetData(), Count))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Checkpoint: missing snow depth."));
+		return false;
+	}
+
+	// Cell columns are optional, a checkpoint written without a cell field keeps the current values
+	if (CellField.IsValid() && CellField->Num() == Count)
+	{
+		Checkpoint.CopyColumn(ESnowCheckpointColumn::SWE, CellField->SWE.GetData(), Count);
+		Checkpoint.CopyColumn(ESnowCheckpointColumn::Albedo, CellField->Albedo.GetData(), Count);
+		Checkpoint.CopyColumn(ESnowCheckpointColumn::Age, CellField->Age.GetData(), Count);
+	}
+
+	CurrentSimulationTime = Checkpoint.GetSimulationTime();
+	CurrentSimulationStep = Header.SimulationStep;
+	SimulatedSecondsAccumulator = 0.0f;
+
+	SnowSim->MarkAllTilesDirty();
+	ApplyStepStats(SnowSim->EnsureStepStats(SnowSim->DepthMeters), 0);
+
+	SnowSim->UploadDepthToTexture();
+	UpdateCpuDepthMeters(SnowSim->DepthMeters);
+	UpdateMaterialTexture();
+
+	UE_LOG(LogTemp, Display, TEXT("[Snow] Restored checkpoint at %s (step %d)"), *CurrentSimulationTime.ToString(), CurrentSimulationStep);
+	return true;
+}
+
+bool ASnowSimulationActor::SaveCheckpoint(const FString& Path)
+{
+	FSnowCheckpointState State;
+	if (!GetCheckpointState(State))
+	{
+		return false;
+	}
+
+	// Written through a 64 bit array, large grids exceed 2 GB
+	TArray64<uint8> Data;
+	FSnowCheckpoint::Write(State, Data);
+	if (!FFileHelper::SaveArrayToFile(Data, *Path))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Checkpoint: could not write %s"), *Path);
+		return false;
+	}
+	return true;
+}
+
+bool ASnowSimulationActor::LoadCheckpoint(const FString& Path)
+{
+	// The columns are copied straight out of the mapping, there is no per cell parsing
+	FSnowCheckpointView Checkpoint;
+	return Checkpoint.OpenFile(Path) && RestoreCheckpoint(Checkpoint);
+}
+
+bool ASnowSimulationActor::SaveCheckpointToSlot(const FString& SlotName, int32 UserIndex)
+{
+	USnowSaveGame* SaveGame = Cast<USnowSaveGame>(UGameplayStatics::CreateSaveGameObject(USnowSaveGame::StaticClass()));
+	FSnowCheckpointState State;
+	if (!SaveGame || !GetCheckpointState(State) || !FSnowCheckpoint::Write(State, SaveGame->Checkpoint))
+	{
+		return false;
+	}
+	SaveGame->SimulationName = GetNameSafe(Simulation);
+	return UGameplayStatics::SaveGameToSlot(SaveGame, SlotName, UserIndex);
+}
+
+bool ASnowSimulationActor::LoadCheckpointFromSlot(const FString& SlotName, int32 UserIndex)
+{
+	const USnowSaveGame* SaveGame = Cast<USnowSaveGame>(UGameplayStatics::LoadGameFromSlot(SlotName, UserIndex));
+	if (!SaveGame)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Checkpoint: save slot %s does not hold a snow checkpoint."), *SlotName);
+		return false;
+	}
+
+	FSnowCheckpointView Checkpoint;
+	return Checkpoint.OpenMemory(SaveGame->Checkpoint) && RestoreCheckpoint(Checkpoint);
+}
+
+void ASnowSimulationActor::InitializeStreamedDomain(USnowSimulation* Template)
+{
+	FSnowStreamedDomain::FSettings Settings;
+	Settings.DomainX = CellsDimensionX;
+	Settings.DomainY = CellsDimensionY;
+	Settings.PageSize = StreamPageSize;
+	Settings.MaxResidentPages = MaxResidentPages;
+	Settings.MaxReplaySteps = MaxStreamReplaySteps;
+	Settings.CellMeters = MetersPerCell;
+	Settings.Latitude = Latitude;
+	Settings.PageFilePath = FPaths::ProjectSavedDir() / TEXT("Snow") / (GetName() + TEXT(".pages"));
+
+	const bool bInitialized = StreamedDomain.Initialize(Template, Settings, [this](const FSnowTile& Region, TArray<FVector3f>& OutCorners, TBitArray<>& OutHoles)
+	{
+		SampleLandscapeRegion(Region, OutCorners, OutHoles);
+	});
+	if (!bInitialized)
+	{
+		UE_LOG(SimulationLog, Warning, TEXT("Could not set up the streamed domain, the simulation will not run."));
+		return;
+	}
+
+	// Page in the cells around the camera right away, the display buffer covers the whole domain at 2 bytes per cell
+	CpuDepthMeters.SetNumZeroed(CellsDimensionX * CellsDimensionY);
+	StepStreamedDomain(TimeStepSeconds, {});
+}
+
+void ASnowSimulationActor::StepStreamedDomain(float DtSeconds, TConstArrayView<FWeatherForcingData> Forcing)
+{
+	const int32 RadiusCells = MetersPerCell > 0.0f ? FMath::CeilToInt(StreamRadiusMeters / MetersPerCell) : 0;
+	StreamedDomain.SetFocus(GetStreamFocusCell(), RadiusCells);
+	StreamedDomain.Step(DtSeconds, Forcing, CVarSnowFastForward.GetValueOnGameThread() != 0);
+
+	// Only the tiles of resident pages that changed are converted and uploaded, evicted pages keep their last published depth
+	StreamedDomain.PublishDepth(CpuDepthMeters, DepthUploadRegions);
+	UploadDepthToTexture(/*bLogStats=*/false);
+
+	ApplyStepStats(StreamedDomain.GetStepStats(), Forcing.Num());
+}
+
+FIntPoint ASnowSimulationActor::GetStreamFocusCell() const
+{
+	if (!Landscape || CellsDimensionX <= 0 || CellsDimensionY <= 0)
+	{
+		return FIntPoint::ZeroValue;
+	}
+
+	FVector Location = GetActorLocation();
+	const APlayerController* Player = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	if (Player && Player->PlayerCameraManager)
+	{
+		Location = Player->PlayerCameraManager->GetCameraLocation();
+	}
+
+	// A cell spans CellSize landscape quads
+	const FVector Local = Location - Landscape->GetActorLocation();
+	const int32 X = FMath::FloorToInt(Local.X / (LandscapeScale.X * CellSize));
+	const int32 Y = FMath::FloorToInt(Local.Y / (LandscapeScale.Y * CellSize));
+	return FIntPoint(FMath::Clamp(X, 0, CellsDimensionX - 1), FMath::Clamp(Y, 0, CellsDimensionY - 1));
+}
+
+void ASnowSimulationActor::SampleLandscapeRegion(const FSnowTile& Region, TArray<FVector3f>& OutCorners, TBitArray<>& OutHoles) const
+{
+	OutCorners.Reset();
+	OutHoles.Reset();
+	if (!Landscape || Landscape->LandscapeComponents.Num() == 0)
+	{
+		return;
+	}
+
+	// Components by section, a region only reads the few it overlaps
+	const int32 ComponentQuads = Landscape->ComponentSizeQuads;
+	TMap<FIntPoint, ULandscapeComponent*> Components;
+	FIntPoint MaxKey = FIntPoint::ZeroValue;
+	for (ULandscapeComponent* Component : Landscape->LandscapeComponents)
+	{
+		const FIntPoint Key(Component->SectionBaseX / ComponentQuads, Component->SectionBaseY / ComponentQuads);
+		Components.Add(Key, Component);
+		MaxKey = MaxKey.ComponentMax(Key);
+	}
+
+	struct FComponentData
+	{
+		TUniquePtr<FLandscapeComponentDataInterface> Data;
+		TArray<uint8> HoleWeights;
+	};
+	TMap<const ULandscapeComponent*, FComponentData> ComponentData;
+
+	// Finds the component of landscape vertex (X, Y), the last vertex row and column belong to the last components
+	auto FindVertex = [&](int32 X, int32 Y, int32& OutLocalX, int32& OutLocalY) -> FComponentData*
+	{
+		ULandscapeComponent* Component = Components.FindRef(FIntPoint(FMath::Min(X / ComponentQuads, MaxKey.X), FMath::Min(Y / ComponentQuads, MaxKey.Y)));
+		if (!Component)
 		{
-			float MinV = FLT_MAX, MaxV = -FLT_MAX;
-			double Sum = 0.0;
-			int32 Count = SnowSim->DepthMeters.Num();
-			
-			for (int32 i = 0; i < Count; ++i)
+			return nullptr;
+		}
+
+		OutLocalX = X - Component->SectionBaseX;
+		OutLocalY = Y - Component->SectionBaseY;
+		FComponentData& Entry = ComponentData.FindOrAdd(Component);
+		if (!Entry.Data)
+		{
+			// @TODO use runtime compatible version
+			Entry.Data = MakeUnique<FLandscapeComponentDataInterface>(Component);
+#if WITH_EDITOR
+			// One weight per vertex, subsections share their edge vertices so the duplicates have to be removed
+			const bool bRead = ALandscapeProxy::VisibilityLayer
+				&& Entry.Data->GetWeightmapTextureData(ALandscapeProxy::VisibilityLayer, Entry.HoleWeights, /*bUseEditingWeightmap=*/false, /*bRemoveSubsectionDuplicates=*/true);
+			const bool bComponentHoles = bRead && Entry.HoleWeights.Num() == FMath::Square(ComponentQuads + 1);
+			UE_CLOG(bRead && !bComponentHoles, LogTemp, Warning, TEXT("[Snow] Ignoring holes of %s, visibility weightmap has %d values for %d vertices"),
+				*Component->GetName(), Entry.HoleWeights.Num(), FMath::Square(ComponentQuads + 1));
+			if (!bComponentHoles)
 			{
-				const float v = SnowSim->DepthMeters[i];
-				MinV = FMath::Min(MinV, v);
-				MaxV = FMath::Max(MaxV, v);
-				Sum += v;
+				Entry.HoleWeights.Reset();
 			}
-			
-			float Mean = (Count > 0) ? static_cast<float>(Sum / Count) : 0.0f;
-			UE_LOG(LogTemp, Display, TEXT("Simulation Depth Stats: min=%.4f m, max=%.4f m, mean=%.4f m"), MinV, MaxV, Mean);
+#endif
 		}
-		else
+		return &Entry;
+	};
+
+	const int32 CornerStride = Region.Width() + 1;
+	OutCorners.SetNumZeroed(CornerStride * (Region.Height() + 1));
+	for (int32 Y = 0; Y <= Region.Height(); Y++)
+	{
+		for (int32 X = 0; X <= Region.Width(); X++)
 		{
-			UE_LOG(LogTemp, Display, TEXT("Simulation Depth Stats: No data available"));
+			int32 LocalX, LocalY;
+			if (FComponentData* Entry = FindVertex((Region.X0 + X) * CellSize, (Region.Y0 + Y) * CellSize, LocalX, LocalY))
+			{
+				OutCorners[X + Y * CornerStride] = FVector3f(Entry->Data->GetWorldVertex(LocalX, LocalY));
+			}
+		}
+	}
+
+	// A cell is a hole if the landscape vertex at its center is
+	OutHoles.Init(false, Region.Num());
+	for (int32 Y = 0; Y < Region.Height(); Y++)
+	{
+		for (int32 X = 0; X < Region.Width(); X++)
+		{
+			int32 LocalX, LocalY;
+			const FComponentData* Entry = FindVertex((Region.X0 + X) * CellSize + CellSize / 2, (Region.Y0 + Y) * CellSize + CellSize / 2, LocalX, LocalY);
+			if (Entry && Entry->HoleWeights.Num() > 0 && Entry->HoleWeights[LocalX + LocalY * (ComponentQuads + 1)] > 127)
+			{
+				OutHoles[X + Y * Region.Width()] = true;
+			}
 		}
 	}
-	
-	UE_LOG(LogTemp, Display, TEXT("=== END STATUS ==="));
 }
 
 void ASnowSimulationActor::UpdateCpuDepthMeters(const TArray<float>& InDepthMeters)
@@ -1439,12 +1884,19 @@ void ASnowSimulationActor::UpdateCpuDepthMeters(const TArray<float>& InDepthMete
 		CpuDepthMeters.SetNum(CellsDimensionX * CellsDimensionY, EAllowShrinking::No);
 	}
 
-	const int32 Count = FMath::Min(CpuDepthMeters.Num(), InDepthMeters.Num());
-	for (int32 i = 0; i < Count; ++i)
 	{
-		CpuDepthMeters[i] = InDepthMeters[i];
+		SNOW_SCOPE(HalfConversion);
+		const int32 Count = FMath::Min(CpuDepthMeters.Num(), InDepthMeters.Num());
+		for (int32 i = 0; i < Count; ++i)
+		{
+			CpuDepthMeters[i] = InDepthMeters[i];
+		}
 	}
 
+	// Written outside the asynchronous flip, both half buffers are converted in full the next time they are stepped
+	CpuDepthTiles.Invalidate();
+	BackCpuDepthTiles.Invalidate();
+
 	UploadDepthToTexture();
 }
 
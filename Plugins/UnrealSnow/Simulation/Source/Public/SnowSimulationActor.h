@@ -7,15 +7,21 @@
 #include "GenericPlatform/GenericPlatformFile.h"
 #include "SimulationWeatherDataProviderBase.h"
 #include "SimulationBase.h"
-#include "Cells/LandscapeCell.h"
+#include "Cells/SnowCellField.h"
 #include "Cells/DebugCell.h"
+#include "Util/DepthUploadRing.h"
+#include "SnowStepStats.h"
+#include "Checkpoint/SnowCheckpoint.h"
+#include "Streaming/SnowStreamedDomain.h"
 // #include "VirtualHeightfieldMesh/VirtualHeightfieldMesh.h" // VirtualHeightfieldMesh not available in UE5.6
 #include "Materials/MaterialInterface.h"
+#include "Tasks/Task.h"
 #include "SnowSimulationActor.generated.h"
 
 // Forward declarations
 class UTexture2D;
 class UMaterialInstanceDynamic;
+class USnowSimulation;
 
 DECLARE_LOG_CATEGORY_EXTERN(SimulationLog, Log, All);
 
@@ -93,6 +99,13 @@ public:
 	/** Wheter to draw the date on the screen or not. */
 	bool DrawDate = true;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation")
+	/** Whether to draw the snow depth statistics of the last step on the screen or not. */
+	bool DrawStepStats = false;
+
+	/** Depth statistics of the last published simulation step. */
+	const FSnowStepStats& GetLastStepStats() const { return LastStepStats; }
+
 	/** Validates that required material parameters are present */
 	bool ValidateMaterialParameters(UMaterialInterface* BaseMat);
 
@@ -129,6 +142,37 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation|Run", meta=(ClampMin="1"))
 	float SimDtSeconds = 3600.0f; // 1 hour per step
 
+	/** Step USnowSimulation based simulations on a worker task; Tick only publishes finished steps (see snow.Sim.AsyncStep). */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation|Run")
+	bool bAsyncStep = true;
+
+	/** Maximum number of worker threads a simulation step may use, 0 uses all task graph workers. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation|Run", meta=(ClampMin="0"))
+	int32 StepWorkerThreads = 0;
+
+	/**
+	* Split the landscape into pages of which only MaxResidentPages are kept in memory, for terrains whose cells do not
+	* fit at once. Pages around the camera are simulated, the others are paged to disk. Requires a USnowSimulation.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation|Streaming")
+	bool bStreamDomain = false;
+
+	/** Edge length of a page in cells. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation|Streaming", meta=(ClampMin="16", EditCondition="bStreamDomain"))
+	int32 StreamPageSize = 256;
+
+	/** Maximum number of pages held in memory. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation|Streaming", meta=(ClampMin="1", EditCondition="bStreamDomain"))
+	int32 MaxResidentPages = 16;
+
+	/** Pages within this distance of the camera are paged in and simulated. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation|Streaming", meta=(ClampMin="0", EditCondition="bStreamDomain"))
+	float StreamRadiusMeters = 2000.0f;
+
+	/** Steps a page that comes back in, or a page advanced in the background, replays per simulation step. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation|Streaming", meta=(ClampMin="1", EditCondition="bStreamDomain"))
+	int32 MaxStreamReplaySteps = 256;
+
 	// Material selection & binding behavior
 	UPROPERTY(EditAnywhere, Category = "Snow|Material")
 	TSoftObjectPtr<UMaterialInterface> SnowSurfaceMaterial; // default to /Game/Materials/M_VHM_Snow
@@ -296,6 +340,9 @@ public:
 	/** Called every frame */
 	virtual void Tick( float DeltaSeconds ) override;
 
+	/** Waits for an in-flight asynchronous step before the actor goes away. */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 #if WITH_EDITOR
 	// Called after a property has changed
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -315,9 +362,28 @@ public:
 	UFUNCTION(CallInEditor, Category = "Debug")
 	void PrintStatus();
 
+	/** Writes the snowpack and the simulation clock to a binary checkpoint file, returns false on failure. */
+	UFUNCTION(BlueprintCallable, Category = "Simulation|Checkpoint")
+	bool SaveCheckpoint(const FString& Path);
+
+	/** Restores the snowpack and the simulation clock from a checkpoint file written by SaveCheckpoint. */
+	UFUNCTION(BlueprintCallable, Category = "Simulation|Checkpoint")
+	bool LoadCheckpoint(const FString& Path);
+
+	/** Saves the checkpoint into a save game slot (see USnowSaveGame). */
+	UFUNCTION(BlueprintCallable, Category = "Simulation|Checkpoint")
+	bool SaveCheckpointToSlot(const FString& SlotName, int32 UserIndex = 0);
+
+	/** Restores the checkpoint stored in a save game slot. */
+	UFUNCTION(BlueprintCallable, Category = "Simulation|Checkpoint")
+	bool LoadCheckpointFromSlot(const FString& SlotName, int32 UserIndex = 0);
+
 	/** Called by simulations to update the CPU depth buffer (meters). */
 	void UpdateCpuDepthMeters(const TArray<float>& InDepthMeters);
 
+	/** Blocks until an in-flight asynchronous step finished and publishes its result. */
+	void FlushAsyncStep();
+
 private:
 	/** Current simulation time the simulation has slept. */
 	float CurrentSleepTime;
@@ -331,16 +397,75 @@ private:
 	/** Accumulates simulated seconds until a weather step (TimeStepSeconds) is executed. */
 	float SimulatedSecondsAccumulator = 0.0f;
 
+	/** Result of a batch of steps computed on a worker, published on the game thread. */
+	struct FAsyncStepResult
+	{
+		int32 NumSteps = 0;
+		FSnowStepStats Stats;
+	};
+
+	/** Depth statistics of the last published step, reduced by the simulation kernels. */
+	FSnowStepStats LastStepStats;
+
+	/** Publishes the statistics of a step to the log, the HUD and the MaxSnow material parameter. */
+	void ApplyStepStats(const FSnowStepStats& Stats, int32 NumSteps = 1);
+
+	/** Half precision back buffer written by the worker, swapped with CpuDepthMeters (front) on publish. */
+	TArray<FFloat16> BackCpuDepthMeters;
+
+	/** Tile versions the front and back half buffers were last written at, swapped along with the buffers. */
+	FSnowDirtyTileTracker CpuDepthTiles;
+	FSnowDirtyTileTracker BackCpuDepthTiles;
+
+	/** Regions of BackCpuDepthMeters the worker converts, kept to avoid reallocating every step. */
+	TArray<FSnowTile> BackCpuDepthRegions;
+
+	/** The in-flight asynchronous step, invalid when no step is running. */
+	UE::Tasks::TTask<FAsyncStepResult> PendingStep;
+
+	/** Returns true if USnowSimulation steps should run on a worker task. */
+	bool IsAsyncStepEnabled() const;
+
+	/** Launches a worker task running NumSteps steps on the simulation and converting them into the back buffer. */
+	void KickAsyncStep(USnowSimulation* SnowSim, int32 NumSteps);
+
+	/** Makes the result of a completed asynchronous step visible (buffers, textures, time). */
+	void PublishAsyncStep(USnowSimulation* SnowSim);
+
+	/** Advances Time and Step by one simulation step, looping back to the start if enabled. */
+	void AdvanceSimulationTime(FDateTime& Time, int32& Step) const;
+
+	/** Points State at the current snowpack, returns false if there is no USnowSimulation to save. */
+	bool GetCheckpointState(FSnowCheckpointState& State);
+
+	/** Copies the columns of a validated checkpoint into the simulation and republishes depth, stats and textures. */
+	bool RestoreCheckpoint(const FSnowCheckpointView& Checkpoint);
+
+	/** Paged simulation domain, only initialized when bStreamDomain is set. */
+	FSnowStreamedDomain StreamedDomain;
+
+	/** Sets up StreamedDomain with Template as the simulation of every page and pages in the cells around the camera. */
+	void InitializeStreamedDomain(USnowSimulation* Template);
+
+	/** Steps the streamed domain around the camera and publishes the pages that changed. */
+	void StepStreamedDomain(float DtSeconds, TConstArrayView<FWeatherForcingData> Forcing);
+
+	/** Samples the landscape corners and holes of a region of cells, the terrain source of the streamed domain. */
+	void SampleLandscapeRegion(const FSnowTile& Region, TArray<FVector3f>& OutCorners, TBitArray<>& OutHoles) const;
+
+	/** Cell under the camera (or the actor without a player), the center of the streamed pages. */
+	FIntPoint GetStreamFocusCell() const;
+
 	/** Minimum and maximum snow water equivalent (SWE) of the landscape. */
 	float MinSWE, MaxSWE;
 
 	/** Max snow from the initial conditions. */
 	float InitialMaxSnow;
 
-	/** Landscape cells. */
-	TArray<FLandscapeCell> LandscapeCells;
+	/** Landscape cells (columnar store shared with the simulation). */
+	TSharedPtr<FSnowCellField> CellField;
 
-	/** Cells for debugging. */
+	/** Debug information captured by legacy simulations. */
 	TArray<FDebugCell> DebugCells;
 
 	/** Slope of the terrain. */
@@ -352,6 +477,13 @@ private:
 	/** GPU texture updated from CPU depth buffer (PF_R16F). */
 	UTexture2D* SnowDepthTexture = nullptr;
 
+	/** Persistent staging buffers for SnowDepthTexture uploads. */
+	FSnowDepthUploadRing DepthUploadRing;
+
+	/** Simulation tiles uploaded to SnowDepthTexture and the regions of the current upload. */
+	FSnowDirtyTileTracker DepthTextureDirtyTiles;
+	TArray<FSnowTile> DepthUploadRegions;
+
 	/** Cached dynamic material instance used to bind snow parameters. */
 	UMaterialInstanceDynamic* SnowMID = nullptr;
 
@@ -424,29 +556,6 @@ private:
 	void LogDepthStats();
 
 	/** Uploads CpuDepthMeters to SnowDepthTexture as PF_R16F via render thread. */
-	void UploadDepthToTexture();
-
-	/**
-	* Returns the cell at the given x and y position or a nullptr if the indices are out of bounds.
-	*
-	* @param X
-	* @param Y
-	* @return the cell at the given x and y position or a nullptr if the indices are out of bounds.
-	*/
-	FLandscapeCell* GetCellChecked(int X, int Y)
-	{
-		return GetCellChecked(X + Y * CellsDimensionX);
-	}
-
-	/**
-	* Returns the cell at the given index or nullptr if the index is out of bounds.
-	*
-	* @param Index the index of the cell
-	* @return the cell at the given index or nullptr if the index is out of bounds
-	*/
-	FLandscapeCell* GetCellChecked(int Index)
-	{
-		return (Index >= 0 && Index < LandscapeCells.Num()) ? &LandscapeCells[Index] : nullptr;
-	}
+	void UploadDepthToTexture(bool bLogStats = true);
 
 };
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Depth statistics of a snow grid, produced by the step kernels as a by-product of writing the cells. */
+struct FSnowStepStats
+{
+	/** Number of cells the statistics cover, 0 if they were never computed. */
+	int32 NumCells = 0;
+
+	/** Number of cells with a positive snow depth. */
+	int32 SnowCoveredCells = 0;
+
+	/** Depth in meters. */
+	float MinDepth = 0.0f;
+	float MaxDepth = 0.0f;
+	double SumDepth = 0.0;
+
+	/** Sum of the snow water equivalent of all cells in mm (kg/m²), SumDepth times the snow density. */
+	double SumSWE_mm = 0.0;
+
+	FORCEINLINE bool IsValidFor(int32 InNumCells) const { return NumCells > 0 && NumCells == InNumCells; }
+
+	FORCEINLINE float GetMeanDepth() const { return NumCells > 0 ? static_cast<float>(SumDepth / NumCells) : 0.0f; }
+
+	/** Folds Count depth values into the statistics, meant to run over a row the kernel has just written. */
+	FORCEINLINE void AccumulateRow(const float* Depth, int32 Count)
+	{
+		float RowMin = NumCells > 0 ? MinDepth : FLT_MAX;
+		float RowMax = NumCells > 0 ? MaxDepth : -FLT_MAX;
+		float RowSum = 0.0f;
+		int32 RowCovered = 0;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const float V = Depth[i];
+			RowMin = FMath::Min(RowMin, V);
+			RowMax = FMath::Max(RowMax, V);
+			RowSum += V;
+			RowCovered += V > 0.0f ? 1 : 0;
+		}
+		if (Count > 0)
+		{
+			MinDepth = RowMin;
+			MaxDepth = RowMax;
+			SumDepth += RowSum;
+			SnowCoveredCells += RowCovered;
+			NumCells += Count;
+		}
+	}
+
+	/** Folds the depth of Count listed cells into the statistics, for kernels visiting an active cell list. */
+	FORCEINLINE void AccumulateCells(const float* Depth, const int32* Cells, int32 Count)
+	{
+		float ListMin = NumCells > 0 ? MinDepth : FLT_MAX;
+		float ListMax = NumCells > 0 ? MaxDepth : -FLT_MAX;
+		float ListSum = 0.0f;
+		int32 ListCovered = 0;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const float V = Depth[Cells[i]];
+			ListMin = FMath::Min(ListMin, V);
+			ListMax = FMath::Max(ListMax, V);
+			ListSum += V;
+			ListCovered += V > 0.0f ? 1 : 0;
+		}
+		if (Count > 0)
+		{
+			MinDepth = ListMin;
+			MaxDepth = ListMax;
+			SumDepth += ListSum;
+			SnowCoveredCells += ListCovered;
+			NumCells += Count;
+		}
+	}
+
+	/** Folds Count cells of the same depth into the statistics, for kernels running on super-cells. */
+	FORCEINLINE void AccumulateUniform(float Depth, int32 Count)
+	{
+		if (Count > 0)
+		{
+			MinDepth = NumCells > 0 ? FMath::Min(MinDepth, Depth) : Depth;
+			MaxDepth = NumCells > 0 ? FMath::Max(MaxDepth, Depth) : Depth;
+			SumDepth += static_cast<double>(Depth) * Count;
+			SnowCoveredCells += Depth > 0.0f ? Count : 0;
+			NumCells += Count;
+		}
+	}
+
+	/** Combines the statistics of two disjoint sets of cells. */
+	static FSnowStepStats Combine(const FSnowStepStats& A, const FSnowStepStats& B)
+	{
+		if (A.NumCells == 0) return B;
+		if (B.NumCells == 0) return A;
+
+		FSnowStepStats Result;
+		Result.NumCells = A.NumCells + B.NumCells;
+		Result.SnowCoveredCells = A.SnowCoveredCells + B.SnowCoveredCells;
+		Result.MinDepth = FMath::Min(A.MinDepth, B.MinDepth);
+		Result.MaxDepth = FMath::Max(A.MaxDepth, B.MaxDepth);
+		Result.SumDepth = A.SumDepth + B.SumDepth;
+		Result.SumSWE_mm = A.SumSWE_mm + B.SumSWE_mm;
+		return Result;
+	}
+
+	/** Statistics of a block of NumCells snow free cells. */
+	static FSnowStepStats SnowFree(int32 InNumCells)
+	{
+		FSnowStepStats Result;
+		Result.NumCells = InNumCells;
+		return Result;
+	}
+};
@@ -0,0 +1,62 @@
+#include "SnowPageFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+FSnowPageFile::~FSnowPageFile()
+{
+	Close();
+}
+
+bool FSnowPageFile::Open(const FString& InPath, int64 InPageBytes)
+{
+	Close();
+	if (InPageBytes <= 0)
+	{
+		return false;
+	}
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(InPath), true);
+	Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*InPath, /*bAppend=*/false, /*bAllowRead=*/true));
+	if (!Handle)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Page file: cannot open %s"), *InPath);
+		return false;
+	}
+
+	Path = InPath;
+	PageBytes = InPageBytes;
+	return true;
+}
+
+void FSnowPageFile::Close()
+{
+	if (!Handle)
+	{
+		return;
+	}
+
+	Handle.Reset();
+	IFileManager::Get().Delete(*Path, /*RequireExists=*/false, /*EvenReadOnly=*/true, /*Quiet=*/true);
+	Path.Reset();
+	PageBytes = 0;
+}
+
+bool FSnowPageFile::Seek(int32 Page, int64 Offset, int64 Bytes)
+{
+	if (!Handle || Page < 0 || Offset < 0 || Bytes < 0 || Offset + Bytes > PageBytes)
+	{
+		return false;
+	}
+	return Handle->Seek(Page * PageBytes + Offset);
+}
+
+bool FSnowPageFile::Write(int32 Page, int64 Offset, const void* Data, int64 Bytes)
+{
+	return Seek(Page, Offset, Bytes) && Handle->Write(static_cast<const uint8*>(Data), Bytes);
+}
+
+bool FSnowPageFile::Read(int32 Page, int64 Offset, void* Data, int64 Bytes)
+{
+	return Seek(Page, Offset, Bytes) && Handle->Read(static_cast<uint8*>(Data), Bytes);
+}
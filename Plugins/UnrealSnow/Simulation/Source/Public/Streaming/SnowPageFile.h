@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+/**
+* Scratch file of fixed size pages. Page N lives at N * PageBytes, so pages are written and read in place without an
+* index and the file only grows to the highest page written. The file is created by Open and deleted by Close.
+*/
+class SIMULATION_API FSnowPageFile
+{
+public:
+	FSnowPageFile() = default;
+	~FSnowPageFile();
+
+	FSnowPageFile(const FSnowPageFile&) = delete;
+	FSnowPageFile& operator=(const FSnowPageFile&) = delete;
+
+	/** Creates (or truncates) the file at InPath, returns false if it cannot be opened for reading and writing. */
+	bool Open(const FString& InPath, int64 InPageBytes);
+
+	/** Closes and deletes the file. */
+	void Close();
+
+	bool IsOpen() const { return Handle.IsValid(); }
+
+	/** Writes Bytes at Offset within Page, the range must fit into the page. */
+	bool Write(int32 Page, int64 Offset, const void* Data, int64 Bytes);
+
+	/** Reads Bytes at Offset within Page into Data. */
+	bool Read(int32 Page, int64 Offset, void* Data, int64 Bytes);
+
+	int64 GetPageBytes() const { return PageBytes; }
+
+private:
+	bool Seek(int32 Page, int64 Offset, int64 Bytes);
+
+	FString Path;
+	int64 PageBytes = 0;
+	TUniquePtr<IFileHandle> Handle;
+};
@@ -0,0 +1,617 @@
+#include "SnowStreamedDomain.h"
+#include "SnowSimulation.h"
+#include "Cells/SnowCellField.h"
+#include "Checkpoint/SnowCheckpoint.h"
+#include "UObject/Package.h"
+
+namespace
+{
+	/** Terrain columns of a page's cell field, SWE holding the initial conditions Build derived from the terrain. */
+	constexpr int32 NumTerrainColumns = 7;
+
+	FSnowCellColumn* GetTerrainColumn(int32 Column, FSnowCellField& Cells)
+	{
+		FSnowCellColumn* Columns[NumTerrainColumns] = { &Cells.Altitude, &Cells.Slope, &Cells.Aspect, &Cells.Area, &Cells.AreaXY, &Cells.Curvature, &Cells.SWE };
+		return Columns[Column];
+	}
+
+	/**
+	* Page file layout: the terrain section (terrain columns, hole mask words and corner lattice), written once when the
+	* page is first built, followed by two copies of the page state, one PageSize x PageSize float column per
+	* checkpoint column each. Stores alternate between the copies so the previous one survives a failed write or read.
+	* Columns hold the page's cells row by row.
+	*/
+	int64 GetColumnBytes(int32 PageSize)
+	{
+		return static_cast<int64>(PageSize) * PageSize * sizeof(float);
+	}
+
+	int64 GetTerrainOffset(int32 Column, int32 PageSize)
+	{
+		return Column * GetColumnBytes(PageSize);
+	}
+
+	int64 GetHolesOffset(int32 PageSize)
+	{
+		return GetTerrainOffset(NumTerrainColumns, PageSize);
+	}
+
+	int64 GetCornersOffset(int32 PageSize)
+	{
+		return GetHolesOffset(PageSize) + FMath::DivideAndRoundUp(PageSize * PageSize, NumBitsPerDWORD) * static_cast<int64>(sizeof(uint32));
+	}
+
+	int64 GetColumnOffset(ESnowCheckpointColumn Column, int32 Copy, int32 PageSize)
+	{
+		const int64 StateOffset = GetCornersOffset(PageSize) + static_cast<int64>(PageSize + 1) * (PageSize + 1) * sizeof(FVector3f);
+		const int64 ColumnIndex = static_cast<int64>(Copy) * static_cast<int64>(ESnowCheckpointColumn::Num) + static_cast<int64>(Column);
+		return StateOffset + ColumnIndex * GetColumnBytes(PageSize);
+	}
+
+	/** The page state columns and where they live for a page simulation. */
+	float* GetStateColumn(ESnowCheckpointColumn Column, USnowSimulation& Simulation, FSnowCellField& Cells)
+	{
+		switch (Column)
+		{
+		case ESnowCheckpointColumn::DepthMeters: return Simulation.DepthMeters.GetData();
+		case ESnowCheckpointColumn::SWE: return Cells.SWE.GetData();
+		case ESnowCheckpointColumn::Albedo: return Cells.Albedo.GetData();
+		case ESnowCheckpointColumn::Age: return Cells.Age.GetData();
+		default: return nullptr;
+		}
+	}
+
+	constexpr ESnowCheckpointColumn PageColumns[] = { ESnowCheckpointColumn::DepthMeters, ESnowCheckpointColumn::SWE, ESnowCheckpointColumn::Albedo, ESnowCheckpointColumn::Age };
+}
+
+FSnowStreamedDomain::~FSnowStreamedDomain()
+{
+	Release();
+}
+
+bool FSnowStreamedDomain::Initialize(USnowSimulation* Template, const FSettings& InSettings, FSnowPageTerrainSource InTerrainSource)
+{
+	Release();
+	if (!Template || !InTerrainSource || InSettings.DomainX <= 0 || InSettings.DomainY <= 0)
+	{
+		return false;
+	}
+
+	Settings = InSettings;
+	Settings.PageSize = FMath::Max(8, Settings.PageSize);
+	Settings.MaxResidentPages = FMath::Max(1, Settings.MaxResidentPages);
+	Settings.MaxReplaySteps = FMath::Max(1, Settings.MaxReplaySteps);
+	TerrainSource = MoveTemp(InTerrainSource);
+
+	const int64 PageBytes = GetColumnOffset(ESnowCheckpointColumn::Num, 1, Settings.PageSize);
+	if (!PageFile.Open(Settings.PageFilePath, PageBytes))
+	{
+		return false;
+	}
+
+	Pages.Initialize(Settings.DomainX, Settings.DomainY, Settings.PageSize);
+	PageStates.SetNum(Pages.NumTiles());
+
+	// Pages start snow free, so the domain statistics cover pages that were never stepped
+	for (int32 PageIndex = 0; PageIndex < PageStates.Num(); ++PageIndex)
+	{
+		PageStates[PageIndex].Stats = FSnowStepStats::SnowFree(Pages.GetTile(PageIndex).Num());
+	}
+
+	// Page simulations keep the template's parameters, their grids are set up when a page comes in
+	Slots.SetNum(FMath::Min(Settings.MaxResidentPages, Pages.NumTiles()));
+	for (FSlot& Slot : Slots)
+	{
+		Slot.Simulation = DuplicateObject<USnowSimulation>(Template, GetTransientPackage());
+		Slot.Simulation->AddToRoot();
+	}
+	ColdSlot.Simulation = DuplicateObject<USnowSimulation>(Template, GetTransientPackage());
+	ColdSlot.Simulation->AddToRoot();
+
+	UE_LOG(LogTemp, Display, TEXT("[Snow] Streamed domain: %dx%d cells in %dx%d pages of %d cells, %d resident, %.1f MB per page on disk"),
+		Settings.DomainX, Settings.DomainY, Pages.TilesX, Pages.TilesY, Settings.PageSize, Slots.Num(), PageBytes / (1024.0 * 1024.0));
+	return true;
+}
+
+void FSnowStreamedDomain::Release()
+{
+	for (FSlot& Slot : Slots)
+	{
+		if (Slot.Simulation)
+		{
+			Slot.Simulation->RemoveFromRoot();
+		}
+	}
+	Slots.Reset();
+	if (ColdSlot.Simulation)
+	{
+		ColdSlot.Simulation->RemoveFromRoot();
+	}
+	ColdSlot = FSlot();
+	PageStates.Reset();
+	FocusPages.Reset();
+	ForcingLog.Reset();
+	DtLog.Reset();
+	TrimmedSteps = 0;
+	PageFile.Close();
+	TerrainSource = nullptr;
+	ForcingFieldProvider = nullptr;
+	UseClock = 0;
+}
+
+void FSnowStreamedDomain::SetForcingFieldProvider(USimulationWeatherDataProviderBase* Provider)
+{
+	ForcingFieldProvider = Provider;
+	for (FSlot& Slot : Slots)
+	{
+		if (Slot.Page != INDEX_NONE)
+		{
+			const FSnowTile Page = Pages.GetTile(Slot.Page);
+			Slot.Simulation->SetForcingFieldProvider(ForcingFieldProvider, FIntPoint(Page.X0, Page.Y0));
+		}
+	}
+}
+
+void FSnowStreamedDomain::SetFocus(const FIntPoint& CenterCell, int32 RadiusCells)
+{
+	FocusPages.Reset();
+	if (!IsInitialized())
+	{
+		return;
+	}
+
+	const int32 MinX = FMath::Clamp((CenterCell.X - RadiusCells) / Settings.PageSize, 0, Pages.TilesX - 1);
+	const int32 MaxX = FMath::Clamp((CenterCell.X + RadiusCells) / Settings.PageSize, 0, Pages.TilesX - 1);
+	const int32 MinY = FMath::Clamp((CenterCell.Y - RadiusCells) / Settings.PageSize, 0, Pages.TilesY - 1);
+	const int32 MaxY = FMath::Clamp((CenterCell.Y + RadiusCells) / Settings.PageSize, 0, Pages.TilesY - 1);
+	for (int32 Y = MinY; Y <= MaxY; ++Y)
+	{
+		for (int32 X = MinX; X <= MaxX; ++X)
+		{
+			FocusPages.Add(X + Y * Pages.TilesX);
+		}
+	}
+
+	// Nearest pages first, the ones beyond the memory budget are dropped
+	auto DistanceSquared = [this, &CenterCell](int32 PageIndex)
+	{
+		const FSnowTile Page = Pages.GetTile(PageIndex);
+		const int64 DX = (Page.X0 + Page.X1) / 2 - CenterCell.X;
+		const int64 DY = (Page.Y0 + Page.Y1) / 2 - CenterCell.Y;
+		return DX * DX + DY * DY;
+	};
+	FocusPages.Sort([&DistanceSquared](int32 A, int32 B) { return DistanceSquared(A) < DistanceSquared(B); });
+	if (FocusPages.Num() > Slots.Num())
+	{
+		FocusPages.SetNum(Slots.Num());
+	}
+}
+
+void FSnowStreamedDomain::Step(float DtSeconds, TConstArrayView<FWeatherForcingData> Forcing, bool bInAllowFastForward)
+{
+	if (!IsInitialized())
+	{
+		return;
+	}
+
+	ForcingLog.Append(Forcing.GetData(), Forcing.Num());
+	for (int32 i = 0; i < Forcing.Num(); ++i)
+	{
+		DtLog.Add(DtSeconds);
+	}
+	bAllowFastForward = bInAllowFastForward;
+
+	TBitArray<> Pinned(false, Pages.NumTiles());
+	for (const int32 PageIndex : FocusPages)
+	{
+		Pinned[PageIndex] = true;
+	}
+
+	++UseClock;
+	for (const int32 PageIndex : FocusPages)
+	{
+		if (PageStates[PageIndex].Slot == INDEX_NONE)
+		{
+			PageIn(PageIndex, AcquireSlot(Pinned));
+		}
+		Slots[PageStates[PageIndex].Slot].LastUse = UseClock;
+	}
+
+	// Pages that came in replay their backlog over several steps, pages that are caught up only take the new steps
+	for (FSlot& Slot : Slots)
+	{
+		if (Slot.Page != INDEX_NONE)
+		{
+			CatchUp(Slot, Forcing.Num() + Settings.MaxReplaySteps);
+		}
+	}
+
+	AdvanceColdPages(Forcing.Num());
+	TrimLog();
+}
+
+int32 FSnowStreamedDomain::AcquireSlot(const TBitArray<>& Pinned)
+{
+	int32 Victim = INDEX_NONE;
+	for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex)
+	{
+		const FSlot& Slot = Slots[SlotIndex];
+		if (Slot.Page == INDEX_NONE)
+		{
+			return SlotIndex;
+		}
+		if (!Pinned[Slot.Page] && (Victim == INDEX_NONE || Slot.LastUse < Slots[Victim].LastUse))
+		{
+			Victim = SlotIndex;
+		}
+	}
+
+	// The focus never holds more pages than there are slots, so some slot is always unpinned
+	check(Victim != INDEX_NONE);
+	PageOut(Victim);
+	return Victim;
+}
+
+void FSnowStreamedDomain::PageIn(int32 PageIndex, int32 SlotIndex)
+{
+	FSlot& Slot = Slots[SlotIndex];
+	Slot.Page = PageIndex;
+	PageStates[PageIndex].Slot = SlotIndex;
+	LoadSlot(Slot);
+}
+
+void FSnowStreamedDomain::PageOut(int32 SlotIndex)
+{
+	FSlot& Slot = Slots[SlotIndex];
+	if (Slot.Page == INDEX_NONE)
+	{
+		return;
+	}
+
+	PageStates[Slot.Page].Slot = INDEX_NONE;
+	StoreSlot(Slot);
+}
+
+void FSnowStreamedDomain::ResetSlot(FSlot& Slot)
+{
+	FPage& State = PageStates[Slot.Page];
+	const FSnowTile Page = Pages.GetTile(Slot.Page);
+
+	// The terrain source is only sampled the first time a page comes in, afterwards its cell field is read back
+	Slot.Cells = State.bTerrainStored ? ReadTerrain(Page) : nullptr;
+	if (!Slot.Cells.IsValid())
+	{
+		Slot.Cells = BuildTerrain(Page);
+		State.bTerrainStored = WriteTerrain(Page, *Slot.Cells);
+	}
+
+	Slot.Simulation->Initialize(Page.Width(), Page.Height(), Settings.CellMeters);
+	Slot.Simulation->SetTerrainMetadata(Slot.Cells);
+	Slot.Simulation->SetForcingFieldProvider(ForcingFieldProvider, FIntPoint(Page.X0, Page.Y0));
+	Slot.PublishedTiles.Invalidate();
+}
+
+void FSnowStreamedDomain::LoadSlot(FSlot& Slot)
+{
+	FPage& State = PageStates[Slot.Page];
+	ResetSlot(Slot);
+	if (State.StoredCopy == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (ReadState(Slot, State.StoredCopy))
+	{
+		Slot.Simulation->MarkAllTilesDirty();
+		return;
+	}
+
+	// The latest copy is unreadable, resume from the previous one while the log still holds the steps since
+	const int32 PreviousCopy = 1 - State.StoredCopy;
+	const int64 PreviousStep = State.CopySteps[PreviousCopy];
+	if (PreviousStep >= TrimmedSteps && ReadState(Slot, PreviousCopy))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Streamed domain: cannot read page %d, resuming it from its previous copy %lld steps behind"), Slot.Page, GetClock() - PreviousStep);
+		State.StoredCopy = PreviousCopy;
+		State.CopySteps[1 - PreviousCopy] = INDEX_NONE;
+		State.StepCursor = static_cast<int32>(PreviousStep - TrimmedSteps);
+		Slot.Simulation->MarkAllTilesDirty();
+		return;
+	}
+
+	// No copy can be replayed, the page starts over from the initial conditions at the oldest logged step
+	UE_LOG(LogTemp, Warning, TEXT("[Snow] Streamed domain: cannot read page %d, restarting it from the initial conditions %d steps behind"), Slot.Page, ForcingLog.Num());
+	ResetSlot(Slot);
+	State.StoredCopy = INDEX_NONE;
+	State.CopySteps[0] = State.CopySteps[1] = INDEX_NONE;
+	State.StepCursor = 0;
+}
+
+void FSnowStreamedDomain::StoreSlot(FSlot& Slot)
+{
+	FPage& State = PageStates[Slot.Page];
+	Slot.Simulation->ResolveCellState();
+
+	// The copy written last stays intact until this one is complete
+	const int32 Copy = State.StoredCopy == 0 ? 1 : 0;
+	if (WriteState(Slot, Copy))
+	{
+		State.StoredCopy = Copy;
+		State.CopySteps[Copy] = TrimmedSteps + State.StepCursor;
+	}
+	else
+	{
+		State.CopySteps[Copy] = INDEX_NONE;
+		const bool bResumable = State.StoredCopy != INDEX_NONE && State.CopySteps[State.StoredCopy] >= TrimmedSteps;
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Streamed domain: cannot write page %d, it resumes from %s when it comes back"),
+			Slot.Page, bResumable ? TEXT("its previous copy") : TEXT("the initial conditions"));
+		if (bResumable)
+		{
+			State.StepCursor = static_cast<int32>(State.CopySteps[State.StoredCopy] - TrimmedSteps);
+		}
+		else
+		{
+			State.StoredCopy = INDEX_NONE;
+			State.CopySteps[0] = State.CopySteps[1] = INDEX_NONE;
+			State.StepCursor = 0;
+		}
+	}
+
+	Slot.Page = INDEX_NONE;
+	Slot.Cells.Reset();
+	Slot.Simulation->SetTerrainMetadata(nullptr);
+}
+
+bool FSnowStreamedDomain::ReadState(FSlot& Slot, int32 Copy)
+{
+	const int32 Count = Slot.Cells->Num();
+	bool bRead = true;
+	for (const ESnowCheckpointColumn Column : PageColumns)
+	{
+		bRead &= PageFile.Read(Slot.Page, GetColumnOffset(Column, Copy, Settings.PageSize), GetStateColumn(Column, *Slot.Simulation, *Slot.Cells), Count * sizeof(float));
+	}
+	return bRead;
+}
+
+bool FSnowStreamedDomain::WriteState(FSlot& Slot, int32 Copy)
+{
+	const int32 Count = Slot.Cells->Num();
+	bool bWritten = true;
+	for (const ESnowCheckpointColumn Column : PageColumns)
+	{
+		bWritten &= PageFile.Write(Slot.Page, GetColumnOffset(Column, Copy, Settings.PageSize), GetStateColumn(Column, *Slot.Simulation, *Slot.Cells), Count * sizeof(float));
+	}
+	return bWritten;
+}
+
+void FSnowStreamedDomain::CatchUp(FSlot& Slot, int32 MaxSteps)
+{
+	FPage& State = PageStates[Slot.Page];
+	const int32 Clock = FMath::Min(ForcingLog.Num(), State.StepCursor + MaxSteps);
+	const TConstArrayView<FWeatherForcingData> Log = ForcingLog;
+	USnowSimulation& Simulation = *Slot.Simulation;
+
+	// Runs with the same step length are one span, so quiescent stretches are fast-forwarded
+	for (int32 Cursor = State.StepCursor; Cursor < Clock;)
+	{
+		int32 RunEnd = Cursor + 1;
+		while (RunEnd < Clock && DtLog[RunEnd] == DtLog[Cursor])
+		{
+			++RunEnd;
+		}
+		Simulation.StepSpan(DtLog[Cursor], Log.Slice(Cursor, RunEnd - Cursor), Simulation.DepthMeters, bAllowFastForward);
+		Cursor = RunEnd;
+	}
+
+	State.StepCursor = Clock;
+	State.Stats = Simulation.EnsureStepStats(Simulation.DepthMeters);
+}
+
+void FSnowStreamedDomain::AdvanceColdPages(int32 NumNewSteps)
+{
+	ColdPages.Reset();
+	for (int32 PageIndex = 0; PageIndex < PageStates.Num(); ++PageIndex)
+	{
+		const FPage& State = PageStates[PageIndex];
+		if (State.Slot == INDEX_NONE && State.StepCursor < ForcingLog.Num())
+		{
+			ColdPages.Add(PageIndex);
+		}
+	}
+	if (ColdPages.Num() == 0)
+	{
+		return;
+	}
+
+	// Every cold page is revisited before the log grows by MaxReplaySteps, and a visit replays up to MaxReplaySteps,
+	// so cold pages never fall more than about twice MaxReplaySteps behind and the log stays bounded
+	const int32 Budget = FMath::Min(ColdPages.Num(), FMath::DivideAndRoundUp(ColdPages.Num() * FMath::Max(1, NumNewSteps), Settings.MaxReplaySteps));
+	ColdPages.Sort([this](int32 A, int32 B) { return PageStates[A].StepCursor < PageStates[B].StepCursor; });
+	for (int32 Index = 0; Index < Budget; ++Index)
+	{
+		ColdSlot.Page = ColdPages[Index];
+		LoadSlot(ColdSlot);
+		CatchUp(ColdSlot, Settings.MaxReplaySteps);
+		StoreSlot(ColdSlot);
+	}
+}
+
+int32 FSnowStreamedDomain::GetOldestStepCursor() const
+{
+	int32 Oldest = ForcingLog.Num();
+	for (const FPage& State : PageStates)
+	{
+		Oldest = FMath::Min(Oldest, State.StepCursor);
+	}
+	return Oldest;
+}
+
+void FSnowStreamedDomain::TrimLog()
+{
+	// The previous copy of a non-resident page stays replayable, a failed read of the latest one falls back to it
+	int32 Oldest = GetOldestStepCursor();
+	for (const FPage& State : PageStates)
+	{
+		if (State.Slot == INDEX_NONE && State.StoredCopy != INDEX_NONE)
+		{
+			const int64 PreviousStep = State.CopySteps[1 - State.StoredCopy];
+			if (PreviousStep >= TrimmedSteps)
+			{
+				Oldest = FMath::Min(Oldest, static_cast<int32>(PreviousStep - TrimmedSteps));
+			}
+		}
+	}
+	if (Oldest <= 0)
+	{
+		return;
+	}
+
+	ForcingLog.RemoveAt(0, Oldest, EAllowShrinking::No);
+	DtLog.RemoveAt(0, Oldest, EAllowShrinking::No);
+	for (FPage& State : PageStates)
+	{
+		State.StepCursor -= Oldest;
+	}
+	TrimmedSteps += Oldest;
+}
+
+TSharedPtr<FSnowCellField> FSnowStreamedDomain::BuildTerrain(const FSnowTile& Page) const
+{
+	FSnowTile Region;
+	Region.X0 = FMath::Max(0, Page.X0 - 1);
+	Region.Y0 = FMath::Max(0, Page.Y0 - 1);
+	Region.X1 = FMath::Min(Settings.DomainX, Page.X1 + 1);
+	Region.Y1 = FMath::Min(Settings.DomainY, Page.Y1 + 1);
+
+	TArray<FVector3f> Corners;
+	TBitArray<> Holes;
+	TerrainSource(Region, Corners, Holes);
+
+	TSharedPtr<FSnowCellField> Cells = MakeShared<FSnowCellField>();
+	if (Corners.Num() != (Region.Width() + 1) * (Region.Height() + 1))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Streamed domain: terrain source returned %d corners for page %d, expected %d"),
+			Corners.Num(), Page.Index, (Region.Width() + 1) * (Region.Height() + 1));
+		Cells->Allocate(Page.Width(), Page.Height());
+		return Cells;
+	}
+
+	// The border cells only give the page's edge cells a full neighbourhood, they are dropped again
+	FSnowCellField Bordered;
+	Bordered.Build(Region.Width(), Region.Height(), MoveTemp(Corners), Settings.Latitude, Settings.CellMeters, MoveTemp(Holes));
+	Cells->CopyRegion(Bordered, Page.X0 - Region.X0, Page.Y0 - Region.Y0, Page.Width(), Page.Height());
+	return Cells;
+}
+
+TSharedPtr<FSnowCellField> FSnowStreamedDomain::ReadTerrain(const FSnowTile& Page)
+{
+	TSharedPtr<FSnowCellField> Cells = MakeShared<FSnowCellField>();
+	Cells->Allocate(Page.Width(), Page.Height());
+	Cells->Latitude = Settings.Latitude;
+
+	const int32 Count = Cells->Num();
+	bool bRead = true;
+	for (int32 Column = 0; Column < NumTerrainColumns; ++Column)
+	{
+		bRead &= PageFile.Read(Page.Index, GetTerrainOffset(Column, Settings.PageSize), GetTerrainColumn(Column, *Cells)->GetData(), Count * sizeof(float));
+	}
+
+	Cells->Holes.Init(false, Count);
+	bRead &= PageFile.Read(Page.Index, GetHolesOffset(Settings.PageSize), Cells->Holes.GetData(), FMath::DivideAndRoundUp(Count, NumBitsPerDWORD) * sizeof(uint32));
+	if (!Cells->Holes.Contains(true))
+	{
+		Cells->Holes.Empty();
+	}
+
+	Cells->Corners.SetNumUninitialized((Page.Width() + 1) * (Page.Height() + 1));
+	bRead &= PageFile.Read(Page.Index, GetCornersOffset(Settings.PageSize), Cells->Corners.GetData(), Cells->Corners.Num() * sizeof(FVector3f));
+
+	if (!bRead)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Snow] Streamed domain: cannot read the terrain of page %d, sampling it again"), Page.Index);
+		return nullptr;
+	}
+	return Cells;
+}
+
+bool FSnowStreamedDomain::WriteTerrain(const FSnowTile& Page, FSnowCellField& Cells)
+{
+	const int32 Count = Cells.Num();
+	if (Count != Page.Num() || Cells.Corners.Num() != (Page.Width() + 1) * (Page.Height() + 1))
+	{
+		return false;
+	}
+
+	bool bWritten = true;
+	for (int32 Column = 0; Column < NumTerrainColumns; ++Column)
+	{
+		bWritten &= PageFile.Write(Page.Index, GetTerrainOffset(Column, Settings.PageSize), GetTerrainColumn(Column, Cells)->GetData(), Count * sizeof(float));
+	}
+
+	// Hole free fields drop their mask, the page file then holds zero words
+	TBitArray<> Holes = Cells.Holes.Num() == Count ? Cells.Holes : TBitArray<>(false, Count);
+	bWritten &= PageFile.Write(Page.Index, GetHolesOffset(Settings.PageSize), Holes.GetData(), FMath::DivideAndRoundUp(Count, NumBitsPerDWORD) * sizeof(uint32));
+	bWritten &= PageFile.Write(Page.Index, GetCornersOffset(Settings.PageSize), Cells.Corners.GetData(), Cells.Corners.Num() * sizeof(FVector3f));
+	return bWritten;
+}
+
+void FSnowStreamedDomain::PublishDepth(TArray<FFloat16>& DomainDepth, TArray<FSnowTile>& OutRegions)
+{
+	OutRegions.Reset();
+	if (!IsInitialized() || DomainDepth.Num() != Settings.DomainX * Settings.DomainY)
+	{
+		return;
+	}
+
+	TArray<FSnowTile> PageRegions;
+	for (FSlot& Slot : Slots)
+	{
+		if (Slot.Page == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FSnowTile Page = Pages.GetTile(Slot.Page);
+		USnowSimulation& Simulation = *Slot.Simulation;
+		Simulation.ResolveCellState();
+		Simulation.ConsumeDirtyRegions(Slot.PublishedTiles, PageRegions);
+		for (const FSnowTile& Region : PageRegions)
+		{
+			for (int32 Y = Region.Y0; Y < Region.Y1; ++Y)
+			{
+				const float* Source = Simulation.DepthMeters.GetData() + Y * Simulation.GridX;
+				FFloat16* Dest = DomainDepth.GetData() + (Page.Y0 + Y) * Settings.DomainX + Page.X0;
+				for (int32 X = Region.X0; X < Region.X1; ++X)
+				{
+					Dest[X] = FFloat16(Source[X]);
+				}
+			}
+
+			FSnowTile& DomainRegion = OutRegions.Add_GetRef(Region);
+			DomainRegion.X0 += Page.X0;
+			DomainRegion.X1 += Page.X0;
+			DomainRegion.Y0 += Page.Y0;
+			DomainRegion.Y1 += Page.Y0;
+		}
+	}
+}
+
+FSnowStepStats FSnowStreamedDomain::GetStepStats() const
+{
+	FSnowStepStats Stats;
+	for (const FPage& State : PageStates)
+	{
+		Stats = FSnowStepStats::Combine(Stats, State.Stats);
+	}
+	return Stats;
+}
+
+int32 FSnowStreamedDomain::NumResident() const
+{
+	int32 Count = 0;
+	for (const FSlot& Slot : Slots)
+	{
+		Count += Slot.Page != INDEX_NONE ? 1 : 0;
+	}
+	return Count;
+}
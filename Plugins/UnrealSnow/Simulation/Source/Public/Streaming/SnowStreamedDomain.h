@@ -0,0 +1,198 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ClimateData.h"
+#include "Util/SnowTiles.h"
+#include "SnowStepStats.h"
+#include "Streaming/SnowPageFile.h"
+
+class USnowSimulation;
+class USimulationWeatherDataProviderBase;
+struct FSnowCellField;
+
+/** Samples the terrain of Region (in domain cells): (W + 1) x (H + 1) world space corners and an optional W x H hole mask. */
+using FSnowPageTerrainSource = TFunction<void(const FSnowTile& Region, TArray<FVector3f>& OutCorners, TBitArray<>& OutHoles)>;
+
+/**
+* Simulation domain split into square pages of which at most MaxResidentPages are held in memory.
+*
+* Every resident page is a page sized copy of the template simulation with its own cell field, built from the terrain
+* source the first time the page comes in and kept in a scratch page file from then on. Pages near the focus are paged
+* in, the least recently used page is written to the page file to make room. Steps run over the resident pages; the
+* forcing of every step is logged, and a page coming back in replays the steps it missed, at most MaxReplaySteps per
+* Step, so quiescent stretches cost one fast-forward. Every Step also advances the non-resident pages furthest behind
+* in a spare slot, enough of them that each one is revisited before the log grows by MaxReplaySteps, so cold pages
+* stay within about twice MaxReplaySteps of the clock and the log only holds the steps the slowest page has not seen
+* yet. Terrain is sampled with a one cell border of the neighbouring pages, so the curvature matches the unpaged grid
+* across page seams.
+*/
+class SIMULATION_API FSnowStreamedDomain
+{
+public:
+	struct FSettings
+	{
+		/** Size of the whole domain in cells. */
+		int32 DomainX = 0;
+		int32 DomainY = 0;
+
+		/** Edge length of a page in cells. */
+		int32 PageSize = 256;
+
+		/** Upper bound of pages in memory, besides the spare slot advancing cold pages. */
+		int32 MaxResidentPages = 16;
+
+		/** Logged steps a page replays per Step beyond the new ones, bounding the cost of a page coming in. */
+		int32 MaxReplaySteps = 256;
+
+		float CellMeters = 1.0f;
+		float Latitude = 0.0f;
+
+		/** Scratch file receiving evicted pages. */
+		FString PageFilePath;
+	};
+
+	FSnowStreamedDomain() = default;
+	~FSnowStreamedDomain();
+
+	FSnowStreamedDomain(const FSnowStreamedDomain&) = delete;
+	FSnowStreamedDomain& operator=(const FSnowStreamedDomain&) = delete;
+
+	/** Sets up the page layout and one duplicate of Template per resident page. Returns false if the page file cannot be created. */
+	bool Initialize(USnowSimulation* Template, const FSettings& InSettings, FSnowPageTerrainSource InTerrainSource);
+
+	/** Releases the page simulations and deletes the page file. */
+	void Release();
+
+	bool IsInitialized() const { return Slots.Num() > 0; }
+
+	/** Page simulations sample Provider per tile at their position in the domain, see USnowSimulation::SetForcingFieldProvider. */
+	void SetForcingFieldProvider(USimulationWeatherDataProviderBase* Provider);
+
+	/** Pages within RadiusCells of CenterCell are paged in by the next Step, nearest first, up to MaxResidentPages. */
+	void SetFocus(const FIntPoint& CenterCell, int32 RadiusCells);
+
+	/**
+	* Advances the domain by one step per entry of Forcing. Pages the focus needs are paged in, all resident pages are
+	* stepped and the coldest non-resident pages are advanced by up to MaxReplaySteps each.
+	*/
+	void Step(float DtSeconds, TConstArrayView<FWeatherForcingData> Forcing, bool bAllowFastForward = true);
+
+	/**
+	* Converts the depth of the resident pages that changed since the last call into DomainDepth (DomainX * DomainY) and
+	* reports the rectangles written. Evicted pages keep the depth they were last published with.
+	*/
+	void PublishDepth(TArray<FFloat16>& DomainDepth, TArray<FSnowTile>& OutRegions);
+
+	/**
+	* Statistics of the whole domain, each page as of the last step applied to it. Pages catching up and cold pages
+	* lag the clock by the steps they have not replayed yet, see GetMaxPageLag.
+	*/
+	FSnowStepStats GetStepStats() const;
+
+	/** Largest number of logged steps a page has not applied yet. */
+	int32 GetMaxPageLag() const { return ForcingLog.Num() - GetOldestStepCursor(); }
+
+	const FSnowTileGrid& GetPages() const { return Pages; }
+
+	int32 NumResident() const;
+
+	/** Number of steps logged since Initialize. */
+	int64 GetClock() const { return TrimmedSteps + ForcingLog.Num(); }
+
+private:
+	struct FSlot
+	{
+		int32 Page = INDEX_NONE;
+		uint64 LastUse = 0;
+		USnowSimulation* Simulation = nullptr;
+		TSharedPtr<FSnowCellField> Cells;
+
+		/** Tiles of the page simulation published to the domain depth. */
+		FSnowDirtyTileTracker PublishedTiles;
+	};
+
+	struct FPage
+	{
+		int32 Slot = INDEX_NONE;
+
+		/** Number of steps of ForcingLog applied to the page. */
+		int32 StepCursor = 0;
+
+		/** Copy of the page state in the page file written last (0 or 1), INDEX_NONE until the page is first stored. */
+		int32 StoredCopy = INDEX_NONE;
+
+		/**
+		* Clock (see GetClock) each copy was written at, INDEX_NONE if it holds nothing. A copy that cannot be read falls
+		* back to the other one if the log still holds the steps since, and to the initial conditions at the oldest
+		* logged step otherwise.
+		*/
+		int64 CopySteps[2] = { INDEX_NONE, INDEX_NONE };
+
+		/** True once the page's cell field has been written to the page file. */
+		bool bTerrainStored = false;
+
+		FSnowStepStats Stats;
+	};
+
+	/** Returns a free slot, evicting the least recently used page that is not pinned if necessary. */
+	int32 AcquireSlot(const TBitArray<>& Pinned);
+
+	void PageIn(int32 PageIndex, int32 SlotIndex);
+	void PageOut(int32 SlotIndex);
+
+	/** Sets up the slot's simulation for its page with the initial conditions of the terrain, read from the page file if stored. */
+	void ResetSlot(FSlot& Slot);
+
+	/** Sets up the slot for its page and reads the page state from the page file if it was stored. */
+	void LoadSlot(FSlot& Slot);
+
+	/** Writes the page state of the slot to the page file and releases the slot's cell field. */
+	void StoreSlot(FSlot& Slot);
+
+	/** Reads or writes copy Copy of the page state of the slot. */
+	bool ReadState(FSlot& Slot, int32 Copy);
+	bool WriteState(FSlot& Slot, int32 Copy);
+
+	/** Replays up to MaxSteps logged steps the page of Slot has not seen yet. */
+	void CatchUp(FSlot& Slot, int32 MaxSteps);
+
+	/**
+	* Advances the non-resident pages furthest behind the clock in ColdSlot, ceil(cold pages * NumNewSteps /
+	* MaxReplaySteps) of them, so the log is trimmed at least as fast as Step extends it.
+	*/
+	void AdvanceColdPages(int32 NumNewSteps);
+
+	/** Smallest StepCursor of all pages. */
+	int32 GetOldestStepCursor() const;
+
+	/** Drops the logged steps every page has applied and no previous copy of a non-resident page needs for a replay. */
+	void TrimLog();
+
+	/** Builds the cell field of Page from the terrain source, sampled with a border of one cell for the curvature. */
+	TSharedPtr<FSnowCellField> BuildTerrain(const FSnowTile& Page) const;
+
+	/** Reads the cell field WriteTerrain stored for Page, returns nullptr if the page file cannot be read. */
+	TSharedPtr<FSnowCellField> ReadTerrain(const FSnowTile& Page);
+
+	/** Stores the terrain columns, initial snow, holes and corners of Page in the page file. */
+	bool WriteTerrain(const FSnowTile& Page, FSnowCellField& Cells);
+
+	FSettings Settings;
+	FSnowPageTerrainSource TerrainSource;
+	FSnowPageFile PageFile;
+	USimulationWeatherDataProviderBase* ForcingFieldProvider = nullptr;
+
+	FSnowTileGrid Pages;
+	TArray<FPage> PageStates;
+	TArray<FSlot> Slots;
+	FSlot ColdSlot;
+	TArray<int32> FocusPages;
+	TArray<int32> ColdPages;
+	uint64 UseClock = 0;
+
+	/** Forcing and step length of the steps not every page has applied yet, and the number of steps dropped before them. */
+	TArray<FWeatherForcingData> ForcingLog;
+	TArray<float> DtLog;
+	int64 TrimmedSteps = 0;
+	bool bAllowFastForward = true;
+};
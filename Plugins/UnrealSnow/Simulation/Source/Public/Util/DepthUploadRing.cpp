@@ -0,0 +1,226 @@
+#include "DepthUploadRing.h"
+#include "Engine/Texture2D.h"
+#include "HAL/IConsoleManager.h"
+#include "RenderingThread.h"
+#include "RHICommandList.h"
+#include "TextureResource.h"
+#include "SnowStats.h"
+
+namespace
+{
+	/** Uploads are issued from the game thread only, so the global counters need no synchronization. */
+	FSnowUploadStats GSnowUploadStats;
+
+	FAutoConsoleCommand CmdSnowUploadStats(
+		TEXT("snow.Sim.UploadStats"),
+		TEXT("Logs the depth texture upload counters. Allocations stop growing once the staging rings are warm."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			const FSnowUploadStats Stats = FSnowDepthUploadRing::GetGlobalStats();
+			UE_LOG(LogTemp, Display, TEXT("[Snow] Depth uploads=%lld (skipped %lld), regions=%lld, texels=%lld, staging allocations=%lld (%.1f MB), fence stalls=%lld"),
+				Stats.Uploads, Stats.SkippedUploads, Stats.Regions, Stats.Texels, Stats.Allocations, Stats.AllocatedBytes / (1024.0 * 1024.0), Stats.FenceStalls);
+		}));
+}
+
+FSnowDepthUploadRing::FSnowDepthUploadRing(int32 InNumSlots)
+	: NumSlots(FMath::Max(1, InNumSlots))
+{
+}
+
+FSnowDepthUploadRing::~FSnowDepthUploadRing()
+{
+	Release();
+}
+
+FSnowUploadStats FSnowDepthUploadRing::GetGlobalStats()
+{
+	return GSnowUploadStats;
+}
+
+void FSnowDepthUploadRing::Flush()
+{
+	for (FSlot& Slot : Slots)
+	{
+		Slot.Fence.Wait();
+	}
+}
+
+void FSnowDepthUploadRing::Release()
+{
+	Flush();
+	GSnowUploadStats.AllocatedBytes -= Stats.AllocatedBytes;
+	Stats.AllocatedBytes = 0;
+	Slots.Empty();
+	NextSlot = 0;
+}
+
+FSnowDepthUploadRing::FSlot& FSnowDepthUploadRing::AcquireSlot(int32 Count)
+{
+	if (Slots.Num() != NumSlots)
+	{
+		Slots.SetNum(NumSlots);
+	}
+
+	FSlot& Slot = Slots[NextSlot];
+	NextSlot = (NextSlot + 1) % NumSlots;
+
+	// The render thread may still be copying out of this buffer
+	if (!Slot.Fence.IsFenceComplete())
+	{
+		++Stats.FenceStalls;
+		++GSnowUploadStats.FenceStalls;
+		Slot.Fence.Wait();
+	}
+
+	if (Slot.Data.Max() < Count)
+	{
+		const int64 GrownBytes = static_cast<int64>(Count - Slot.Data.Max()) * sizeof(FFloat16);
+		++Stats.Allocations;
+		++GSnowUploadStats.Allocations;
+		Stats.AllocatedBytes += GrownBytes;
+		GSnowUploadStats.AllocatedBytes += GrownBytes;
+		Slot.Data.Reserve(Count);
+	}
+	Slot.Data.SetNumUninitialized(Count, EAllowShrinking::No);
+	return Slot;
+}
+
+void FSnowDepthUploadRing::Upload(UTexture2D* Texture, int32 Width, int32 Height, TConstArrayView<float> DepthMeters)
+{
+	FSnowTile Full;
+	Full.X1 = Width;
+	Full.Y1 = Height;
+	UploadRegions(Texture, Width, Height, DepthMeters, MakeArrayView(&Full, 1));
+}
+
+void FSnowDepthUploadRing::Upload(UTexture2D* Texture, int32 Width, int32 Height, TConstArrayView<FFloat16> DepthMeters)
+{
+	FSnowTile Full;
+	Full.X1 = Width;
+	Full.Y1 = Height;
+	UploadRegions(Texture, Width, Height, DepthMeters, MakeArrayView(&Full, 1));
+}
+
+void FSnowDepthUploadRing::Upload(UTexture2D* Texture, int32 Width, int32 Height, TConstArrayView<float> DepthMeters, TConstArrayView<FSnowTile> Regions)
+{
+	UploadRegions(Texture, Width, Height, DepthMeters, Regions);
+}
+
+void FSnowDepthUploadRing::Upload(UTexture2D* Texture, int32 Width, int32 Height, TConstArrayView<FFloat16> DepthMeters, TConstArrayView<FSnowTile> Regions)
+{
+	UploadRegions(Texture, Width, Height, DepthMeters, Regions);
+}
+
+template <typename SourceType>
+void FSnowDepthUploadRing::UploadRegions(UTexture2D* Texture, int32 Width, int32 Height, TConstArrayView<SourceType> Source, TConstArrayView<FSnowTile> Regions)
+{
+	if (!Texture || Width <= 0 || Height <= 0)
+	{
+		return;
+	}
+	if (Regions.Num() == 0)
+	{
+		++Stats.SkippedUploads;
+		++GSnowUploadStats.SkippedUploads;
+		return;
+	}
+
+	FSlot& Slot = AcquireSlot(Width * Height);
+	Slot.Regions.Reset();
+
+	// Only the texels of the regions are converted, the rest of the staging buffer is never read
+	{
+		SNOW_SCOPE(HalfConversion);
+		FFloat16* Dest = Slot.Data.GetData();
+		const int32 SrcCount = Source.Num();
+		for (const FSnowTile& Region : Regions)
+		{
+			FSnowTile& Clipped = Slot.Regions.Add_GetRef(Region);
+			Clipped.X0 = FMath::Clamp(Region.X0, 0, Width);
+			Clipped.Y0 = FMath::Clamp(Region.Y0, 0, Height);
+			Clipped.X1 = FMath::Clamp(Region.X1, Clipped.X0, Width);
+			Clipped.Y1 = FMath::Clamp(Region.Y1, Clipped.Y0, Height);
+
+			for (int32 Y = Clipped.Y0; Y < Clipped.Y1; ++Y)
+			{
+				const int32 RowEnd = Y * Width + Clipped.X1;
+				for (int32 Index = Y * Width + Clipped.X0; Index < RowEnd; ++Index)
+				{
+					Dest[Index] = (Index < SrcCount) ? FFloat16(Source[Index]) : FFloat16(0.0f);
+				}
+			}
+		}
+	}
+
+	Submit(Texture, Width, Height, Slot);
+}
+
+void FSnowDepthUploadRing::Submit(UTexture2D* Texture, int32 Width, int32 Height, FSlot& Slot)
+{
+	FTextureResource* Resource = Texture->GetResource();
+	if (!Resource)
+	{
+		return;
+	}
+
+	++Stats.Uploads;
+	++GSnowUploadStats.Uploads;
+	int64 Texels = 0;
+	for (const FSnowTile& Region : Slot.Regions)
+	{
+		Texels += Region.Num();
+	}
+	Stats.Texels += Texels;
+	GSnowUploadStats.Texels += Texels;
+	Stats.Regions += Slot.Regions.Num();
+	GSnowUploadStats.Regions += Slot.Regions.Num();
+	SnowStats::AddBytesUploaded(Texels * sizeof(FFloat16));
+
+	// The slot is not touched again before its fence completes, so the render thread can read it without a copy
+	const FFloat16* Source = Slot.Data.GetData();
+	const TArray<FSnowTile>* Regions = &Slot.Regions;
+	ENQUEUE_RENDER_COMMAND(SnowDepthUpload)([Resource, Source, Regions, Width, Height](FRHICommandListImmediate& RHICmdList)
+	{
+		FRHITexture* TextureRHI = Resource->GetTexture2DRHI();
+		if (!TextureRHI || TextureRHI->GetSizeX() != static_cast<uint32>(Width) || TextureRHI->GetSizeY() != static_cast<uint32>(Height))
+		{
+			return;
+		}
+
+		const uint32 SourcePitch = Width * sizeof(FFloat16);
+		const uint8* Src = reinterpret_cast<const uint8*>(Source);
+		const bool bFullTexture = Regions->Num() == 1 && (*Regions)[0].Num() == Width * Height;
+		if (!bFullTexture)
+		{
+			// Partial updates must not touch the rest of the mip, so every region gets its own update
+			for (const FSnowTile& Region : *Regions)
+			{
+				if (Region.Num() > 0)
+				{
+					const FUpdateTextureRegion2D UpdateRegion(Region.X0, Region.Y0, Region.X0, Region.Y0, Region.Width(), Region.Height());
+					RHICmdList.UpdateTexture2D(TextureRHI, 0, UpdateRegion, SourcePitch, Src + Region.Y0 * SourcePitch + Region.X0 * sizeof(FFloat16));
+				}
+			}
+			return;
+		}
+
+		uint32 DestStride = 0;
+		uint8* Dest = static_cast<uint8*>(RHICmdList.LockTexture2D(TextureRHI, 0, RLM_WriteOnly, DestStride, false));
+		if (Dest)
+		{
+			if (DestStride == SourcePitch)
+			{
+				FMemory::Memcpy(Dest, Src, static_cast<SIZE_T>(SourcePitch) * Height);
+			}
+			else
+			{
+				for (int32 Row = 0; Row < Height; ++Row)
+				{
+					FMemory::Memcpy(Dest + Row * DestStride, Src + Row * SourcePitch, SourcePitch);
+				}
+			}
+		}
+		RHICmdList.UnlockTexture2D(TextureRHI, 0, false);
+	});
+	Slot.Fence.BeginFence();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderCommandFence.h"
+#include "Util/SnowTiles.h"
+
+class UTexture2D;
+
+/** Allocation and upload counters of depth texture uploads. */
+struct FSnowUploadStats
+{
+	/** Number of uploads enqueued. */
+	int64 Uploads = 0;
+
+	/** Number of texture regions written and their texels, partial uploads write fewer texels than Uploads * W * H. */
+	int64 Regions = 0;
+	int64 Texels = 0;
+
+	/** Number of uploads skipped because no region changed. */
+	int64 SkippedUploads = 0;
+
+	/** Number of times a staging buffer had to grow, stays constant once the ring is warm. */
+	int64 Allocations = 0;
+
+	/** Bytes currently reserved by staging buffers. */
+	int64 AllocatedBytes = 0;
+
+	/** Number of uploads that had to wait for the render thread to release a staging buffer. */
+	int64 FenceStalls = 0;
+};
+
+/**
+* Ring of persistent half-float staging buffers for uploading depth grids to PF_R16F textures.
+*
+* Each upload converts the source into the next staging buffer on the calling thread and enqueues a render command
+* that copies it row by row straight into the locked top mip. A buffer is reused once the render thread is done with
+* it, so after the first NumSlots uploads the step loop does no heap allocations. If the render thread falls more than
+* NumSlots uploads behind, the upload waits for the oldest one.
+*
+* The region overloads only convert and send the given rectangles (see FSnowDirtyTileTracker), each one with its own
+* texture update, and skip the upload altogether if there is no region.
+*/
+class SIMULATION_API FSnowDepthUploadRing
+{
+public:
+	/** Staging buffers in flight, enough for the game thread to run two frames ahead of the render thread. */
+	static constexpr int32 DefaultNumSlots = 3;
+
+	explicit FSnowDepthUploadRing(int32 InNumSlots = DefaultNumSlots);
+	~FSnowDepthUploadRing();
+
+	FSnowDepthUploadRing(const FSnowDepthUploadRing&) = delete;
+	FSnowDepthUploadRing& operator=(const FSnowDepthUploadRing&) = delete;
+
+	/** Uploads Width x Height meters to Texture, missing source values are written as 0. */
+	void Upload(UTexture2D* Texture, int32 Width, int32 Height, TConstArrayView<float> DepthMeters);
+
+	/** Uploads Width x Height half-float meters to Texture, missing source values are written as 0. */
+	void Upload(UTexture2D* Texture, int32 Width, int32 Height, TConstArrayView<FFloat16> DepthMeters);
+
+	/** Uploads the Regions (in texels) of a Width x Height grid of meters to Texture. */
+	void Upload(UTexture2D* Texture, int32 Width, int32 Height, TConstArrayView<float> DepthMeters, TConstArrayView<FSnowTile> Regions);
+
+	/** Uploads the Regions (in texels) of a Width x Height grid of half-float meters to Texture. */
+	void Upload(UTexture2D* Texture, int32 Width, int32 Height, TConstArrayView<FFloat16> DepthMeters, TConstArrayView<FSnowTile> Regions);
+
+	/** Blocks until the render thread has consumed every staging buffer. */
+	void Flush();
+
+	/** Releases the staging buffers, waits for pending uploads first. */
+	void Release();
+
+	const FSnowUploadStats& GetStats() const { return Stats; }
+
+	/** Counters summed over all rings, see the snow.Sim.UploadStats console command. */
+	static FSnowUploadStats GetGlobalStats();
+
+private:
+	struct FSlot
+	{
+		TArray<FFloat16> Data;
+		TArray<FSnowTile> Regions;
+		FRenderCommandFence Fence;
+	};
+
+	TArray<FSlot> Slots;
+	int32 NumSlots = DefaultNumSlots;
+	int32 NextSlot = 0;
+	FSnowUploadStats Stats;
+
+	/** Returns the next free slot with room for Count values. */
+	FSlot& AcquireSlot(int32 Count);
+
+	/** Converts the regions of Source into the next slot and submits it. */
+	template <typename SourceType>
+	void UploadRegions(UTexture2D* Texture, int32 Width, int32 Height, TConstArrayView<SourceType> Source, TConstArrayView<FSnowTile> Regions);
+
+	/** Enqueues the copy of the regions of Slot into the top mip of Texture. */
+	void Submit(UTexture2D* Texture, int32 Width, int32 Height, FSlot& Slot);
+};
@@ -0,0 +1,75 @@
+#include "SnowActiveSet.h"
+
+void FSnowActiveSet::Build(const FSnowTileGrid& Grid, const float* Depth, const TBitArray<>* Holes)
+{
+	const int32 NumCells = Grid.GridX * Grid.GridY;
+	const int32 NumTiles = Grid.NumTiles();
+	Cells.SetNumUninitialized(NumCells, EAllowShrinking::No);
+	TileOffsets.SetNumUninitialized(NumTiles, EAllowShrinking::No);
+	TileCounts.SetNumZeroed(NumTiles, EAllowShrinking::No);
+
+	// A tile's slice holds at most all of its cells
+	int32 Offset = 0;
+	for (int32 TileIndex = 0; TileIndex < NumTiles; ++TileIndex)
+	{
+		TileOffsets[TileIndex] = Offset;
+		Offset += Grid.GetTile(TileIndex).Num();
+	}
+
+	if (Holes && Holes->Num() == NumCells && Holes->Contains(true))
+	{
+		Excluded = *Holes;
+	}
+	else
+	{
+		Excluded.Empty();
+	}
+
+	Grid.ForEachTile([this, &Grid, Depth](const FSnowTile& Tile)
+	{
+		RebuildTile(Grid, Tile, Depth);
+	});
+	bValid = true;
+}
+
+void FSnowActiveSet::RebuildTile(const FSnowTileGrid& Grid, const FSnowTile& Tile, const float* Depth)
+{
+	int32* Out = Cells.GetData() + TileOffsets[Tile.Index];
+	int32 Count = 0;
+	const bool bHasHoles = Excluded.Num() > 0;
+	for (int32 Y = Tile.Y0; Y < Tile.Y1; ++Y)
+	{
+		const int32 RowEnd = Y * Grid.GridX + Tile.X1;
+		for (int32 Index = Y * Grid.GridX + Tile.X0; Index < RowEnd; ++Index)
+		{
+			// Branch-free append, the slot is overwritten again if the cell is inactive
+			Out[Count] = Index;
+			Count += (Depth[Index] > 0.0f && !(bHasHoles && Excluded[Index])) ? 1 : 0;
+		}
+	}
+	TileCounts[Tile.Index] = Count;
+}
+
+void FSnowActiveSet::CompactTile(const FSnowTile& Tile, const float* Depth)
+{
+	int32* TileCells = Cells.GetData() + TileOffsets[Tile.Index];
+	const int32 Num = TileCounts[Tile.Index];
+	int32 Count = 0;
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const int32 Index = TileCells[i];
+		TileCells[Count] = Index;
+		Count += Depth[Index] > 0.0f ? 1 : 0;
+	}
+	TileCounts[Tile.Index] = Count;
+}
+
+int64 FSnowActiveSet::NumActive() const
+{
+	int64 Total = 0;
+	for (const int32 Count : TileCounts)
+	{
+		Total += Count;
+	}
+	return Total;
+}
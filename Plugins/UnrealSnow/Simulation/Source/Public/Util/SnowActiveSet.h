@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SnowTiles.h"
+
+/**
+* Compacted per-tile lists of the cells a step has to visit (cells holding snow).
+*
+* Every tile owns a fixed slice of one flat index array, so the list of a tile can be rebuilt or compacted by the worker
+* running the tile without touching other tiles. Kernels visit the list instead of the tile when few of its cells are
+* active, which makes melt-only steps cost O(active cells) instead of O(grid). Hole cells are never listed.
+*/
+struct SIMULATION_API FSnowActiveSet
+{
+	/** Rebuilds the lists of all tiles from Depth (Grid.GridX * Grid.GridY values), skipping cells set in Holes. */
+	void Build(const FSnowTileGrid& Grid, const float* Depth, const TBitArray<>* Holes = nullptr);
+
+	/** Rebuilds the list of Tile after a dense pass over it, safe to run for different tiles in parallel. */
+	void RebuildTile(const FSnowTileGrid& Grid, const FSnowTile& Tile, const float* Depth);
+
+	/** Drops the cells of the list of Tile that no longer hold snow, safe to run for different tiles in parallel. */
+	void CompactTile(const FSnowTile& Tile, const float* Depth);
+
+	/** Returns true if the lists were built for Grid and have not been invalidated since. */
+	bool IsValidFor(const FSnowTileGrid& Grid) const
+	{
+		return bValid && TileCounts.Num() == Grid.NumTiles() && Cells.Num() == Grid.GridX * Grid.GridY;
+	}
+
+	/** Forgets the lists, call after the depth buffer was written outside the kernels maintaining them. */
+	void Invalidate() { bValid = false; }
+
+	/** Active cell indices (into the grid) of a tile. */
+	FORCEINLINE TArrayView<int32> GetTileCells(int32 TileIndex)
+	{
+		return TArrayView<int32>(Cells.GetData() + TileOffsets[TileIndex], TileCounts[TileIndex]);
+	}
+
+	FORCEINLINE int32 NumTileCells(int32 TileIndex) const { return TileCounts[TileIndex]; }
+
+	/** Total number of active cells, sums the tile counts. */
+	int64 NumActive() const;
+
+private:
+	/** Grid cell indices, the list of tile i occupies [TileOffsets[i], TileOffsets[i] + TileCounts[i]). */
+	TArray<int32> Cells;
+	TArray<int32> TileOffsets;
+	TArray<int32> TileCounts;
+
+	/** Cells never listed, copied from the hole mask of the last Build. */
+	TBitArray<> Excluded;
+
+	bool bValid = false;
+};
@@ -0,0 +1,242 @@
+#include "SnowAdaptiveGrid.h"
+
+void FSnowAdaptiveLeaves::Reset()
+{
+	for (FSnowCellColumn* Column : { &Depth, &Age, &Albedo, &ScatteredDepth, &ScatteredAge, &Factor, &FactorSpread, &Accumulated })
+	{
+		Column->Reset();
+	}
+	Blocks.Reset();
+	bPendingScatter = false;
+}
+
+void FSnowAdaptiveGrid::Build(const FSnowTileGrid& Grid, const FSnowCellField& Cells, const float* Factor, const float* Depth, const FSnowAdaptiveTolerances& InTolerances)
+{
+	Tolerances = InTolerances;
+	TileLeaves.SetNum(Grid.NumTiles());
+
+	Grid.ForEachTile([this, &Grid, &Cells, Factor, Depth](const FSnowTile& Tile)
+	{
+		BuildTile(Grid, Tile, Cells, Factor, Depth);
+	});
+	bValid = true;
+
+	UE_LOG(LogTemp, Log, TEXT("[Snow] Adaptive grid: %lld super-cells for %d cells"), NumLeaves(), Grid.GridX * Grid.GridY);
+}
+
+void FSnowAdaptiveGrid::RebuildTile(const FSnowTileGrid& Grid, const FSnowTile& Tile, const FSnowCellField& Cells, const float* Factor, float* Depth)
+{
+	// The cells hold the depth changes of their super-cell, add what each cell received beyond the mean factor
+	const FSnowAdaptiveLeaves& Leaves = TileLeaves[Tile.Index];
+	for (int32 Leaf = 0; Leaf < Leaves.Num(); ++Leaf)
+	{
+		const float Accumulated = Leaves.Accumulated[Leaf];
+		const float LeafDepth = Leaves.Depth[Leaf];
+		if (Accumulated <= 0.0f || LeafDepth <= 0.0f || Leaves.FactorSpread[Leaf] <= 0.0f)
+		{
+			continue;
+		}
+
+		const FSnowTile& Block = Leaves.Blocks[Leaf];
+		const float LeafFactor = Leaves.Factor[Leaf];
+		for (int32 Y = Block.Y0; Y < Block.Y1; ++Y)
+		{
+			const int32 RowEnd = Y * Grid.GridX + Block.X1;
+			for (int32 Index = Y * Grid.GridX + Block.X0; Index < RowEnd; ++Index)
+			{
+				Depth[Index] = FMath::Max(0.0f, Depth[Index] + (Factor[Index] - LeafFactor) * Accumulated);
+			}
+		}
+	}
+
+	BuildTile(Grid, Tile, Cells, Factor, Depth);
+}
+
+void FSnowAdaptiveGrid::BuildTile(const FSnowTileGrid& Grid, const FSnowTile& Tile, const FSnowCellField& Cells, const float* Factor, const float* Depth)
+{
+	FSnowAdaptiveLeaves& Leaves = TileLeaves[Tile.Index];
+	Leaves.Reset();
+
+	const int32 BlockSize = Tolerances.MaxBlockSize;
+	for (int32 Y0 = Tile.Y0; Y0 < Tile.Y1; Y0 += BlockSize)
+	{
+		for (int32 X0 = Tile.X0; X0 < Tile.X1; X0 += BlockSize)
+		{
+			FSnowTile Block;
+			Block.X0 = X0;
+			Block.Y0 = Y0;
+			Block.X1 = FMath::Min(X0 + BlockSize, Tile.X1);
+			Block.Y1 = FMath::Min(Y0 + BlockSize, Tile.Y1);
+			Subdivide(Block, Grid.GridX, Cells, Factor, Depth, Leaves);
+		}
+	}
+}
+
+void FSnowAdaptiveGrid::Subdivide(const FSnowTile& Block, int32 Stride, const FSnowCellField& Cells, const float* Factor, const float* Depth, FSnowAdaptiveLeaves& Leaves) const
+{
+	const bool bHasAge = Cells.Age.Num() == Cells.Num() && Cells.Albedo.Num() == Cells.Num();
+	const int32 First = Block.Y0 * Stride + Block.X0;
+	const bool bFirstHole = Cells.IsHole(First);
+	const bool bFirstReceives = Factor[First] > 0.0f;
+
+	float MinAltitude = FLT_MAX, MaxAltitude = -FLT_MAX;
+	float MinSlope = FLT_MAX, MaxSlope = -FLT_MAX;
+	float MinCurvature = FLT_MAX, MaxCurvature = -FLT_MAX;
+	float MinDepth = FLT_MAX, MaxDepth = -FLT_MAX;
+	float MinAge = FLT_MAX, MaxAge = -FLT_MAX;
+	float MinFactor = FLT_MAX, MaxFactor = -FLT_MAX;
+	double SumDepth = 0.0, SumAge = 0.0, SumAlbedo = 0.0, SumFactor = 0.0;
+	bool bUniform = true;
+	for (int32 Y = Block.Y0; Y < Block.Y1 && bUniform; ++Y)
+	{
+		const int32 RowEnd = Y * Stride + Block.X1;
+		for (int32 Index = Y * Stride + Block.X0; Index < RowEnd; ++Index)
+		{
+			// Holes and cells without snowfall age differently, they never share a super-cell with other cells
+			if (Cells.IsHole(Index) != bFirstHole || (Factor[Index] > 0.0f) != bFirstReceives)
+			{
+				bUniform = false;
+				break;
+			}
+
+			MinAltitude = FMath::Min(MinAltitude, Cells.Altitude[Index]);
+			MaxAltitude = FMath::Max(MaxAltitude, Cells.Altitude[Index]);
+			MinSlope = FMath::Min(MinSlope, Cells.Slope[Index]);
+			MaxSlope = FMath::Max(MaxSlope, Cells.Slope[Index]);
+			MinCurvature = FMath::Min(MinCurvature, Cells.Curvature[Index]);
+			MaxCurvature = FMath::Max(MaxCurvature, Cells.Curvature[Index]);
+			MinDepth = FMath::Min(MinDepth, Depth[Index]);
+			MaxDepth = FMath::Max(MaxDepth, Depth[Index]);
+			MinFactor = FMath::Min(MinFactor, Factor[Index]);
+			MaxFactor = FMath::Max(MaxFactor, Factor[Index]);
+			SumDepth += Depth[Index];
+			SumFactor += Factor[Index];
+			if (bHasAge)
+			{
+				MinAge = FMath::Min(MinAge, Cells.Age[Index]);
+				MaxAge = FMath::Max(MaxAge, Cells.Age[Index]);
+				SumAge += Cells.Age[Index];
+				SumAlbedo += Cells.Albedo[Index];
+			}
+		}
+	}
+
+	bUniform = bUniform
+		&& MaxAltitude - MinAltitude <= Tolerances.Altitude
+		&& MaxSlope - MinSlope <= Tolerances.Slope
+		&& MaxCurvature - MinCurvature <= Tolerances.Curvature
+		&& MaxDepth - MinDepth <= Tolerances.Depth
+		&& (!bHasAge || MaxAge - MinAge <= Tolerances.Age);
+
+	if (bUniform)
+	{
+		// A single cell is always uniform, its values are exact. The cells keep their depth, only changes are scattered
+		const double InvNum = 1.0 / Block.Num();
+		const float MeanDepth = static_cast<float>(SumDepth * InvNum);
+		Leaves.Blocks.Add(Block);
+		Leaves.Depth.Add(MeanDepth);
+		Leaves.ScatteredDepth.Add(MeanDepth);
+		Leaves.Factor.Add(static_cast<float>(SumFactor * InvNum));
+		Leaves.FactorSpread.Add(MaxFactor - MinFactor);
+		Leaves.Age.Add(bHasAge ? static_cast<float>(SumAge * InvNum) : 0.0f);
+		Leaves.ScatteredAge.Add(Leaves.Age.Last());
+		Leaves.Albedo.Add(bHasAge ? static_cast<float>(SumAlbedo * InvNum) : 0.0f);
+		Leaves.Accumulated.Add(0.0f);
+		return;
+	}
+
+	const int32 MidX = Block.X0 + (Block.Width() + 1) / 2;
+	const int32 MidY = Block.Y0 + (Block.Height() + 1) / 2;
+	const int32 Xs[] = { Block.X0, MidX, Block.X1 };
+	const int32 Ys[] = { Block.Y0, MidY, Block.Y1 };
+	for (int32 QY = 0; QY < 2; ++QY)
+	{
+		for (int32 QX = 0; QX < 2; ++QX)
+		{
+			FSnowTile Quadrant;
+			Quadrant.X0 = Xs[QX];
+			Quadrant.X1 = Xs[QX + 1];
+			Quadrant.Y0 = Ys[QY];
+			Quadrant.Y1 = Ys[QY + 1];
+			if (Quadrant.Num() > 0)
+			{
+				Subdivide(Quadrant, Stride, Cells, Factor, Depth, Leaves);
+			}
+		}
+	}
+}
+
+void FSnowAdaptiveGrid::Scatter(FSnowAdaptiveLeaves& Leaves, int32 Leaf, int32 Stride, float* Depth, float* Age, float* Albedo)
+{
+	const FSnowTile& Block = Leaves.Blocks[Leaf];
+	const float DepthChange = Leaves.Depth[Leaf] - Leaves.ScatteredDepth[Leaf];
+	for (int32 Y = Block.Y0; Y < Block.Y1; ++Y)
+	{
+		const int32 RowStart = Y * Stride + Block.X0;
+		if (Depth && DepthChange != 0.0f)
+		{
+			for (int32 i = 0; i < Block.Width(); ++i)
+			{
+				Depth[RowStart + i] = FMath::Max(0.0f, Depth[RowStart + i] + DepthChange);
+			}
+		}
+		if (Age)
+		{
+			for (int32 i = 0; i < Block.Width(); ++i)
+			{
+				Age[RowStart + i] = Leaves.Age[Leaf];
+				Albedo[RowStart + i] = Leaves.Albedo[Leaf];
+			}
+		}
+	}
+	if (Depth)
+	{
+		Leaves.ScatteredDepth[Leaf] = Leaves.Depth[Leaf];
+	}
+	if (Age)
+	{
+		Leaves.ScatteredAge[Leaf] = Leaves.Age[Leaf];
+	}
+}
+
+void FSnowAdaptiveGrid::ScatterTile(const FSnowTile& Tile, int32 Stride, float* Depth, float* Age, float* Albedo)
+{
+	FSnowAdaptiveLeaves& Leaves = TileLeaves[Tile.Index];
+	if (!Leaves.bPendingScatter)
+	{
+		return;
+	}
+
+	for (int32 Leaf = 0; Leaf < Leaves.Num(); ++Leaf)
+	{
+		const bool bAged = Age && HasAgeChanged(Leaves, Leaf);
+		if (HasDepthChanged(Leaves, Leaf) || bAged)
+		{
+			Scatter(Leaves, Leaf, Stride, Depth, bAged ? Age : nullptr, Albedo);
+		}
+	}
+	Leaves.bPendingScatter = false;
+}
+
+void FSnowAdaptiveGrid::ScatterPending(const FSnowTileGrid& Grid, float* Depth, float* Age, float* Albedo)
+{
+	if (!bValid || TileLeaves.Num() != Grid.NumTiles())
+	{
+		return;
+	}
+
+	Grid.ForEachTile([this, &Grid, Depth, Age, Albedo](const FSnowTile& Tile)
+	{
+		ScatterTile(Tile, Grid.GridX, Depth, Age, Albedo);
+	});
+}
+
+int64 FSnowAdaptiveGrid::NumLeaves() const
+{
+	int64 Total = 0;
+	for (const FSnowAdaptiveLeaves& Leaves : TileLeaves)
+	{
+		Total += Leaves.Num();
+	}
+	return Total;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SnowTiles.h"
+#include "Cells/SnowCellField.h"
+
+/** Limits within which a block of cells counts as uniform and is simulated as one super-cell. */
+struct FSnowAdaptiveTolerances
+{
+	/** Largest edge length of a super-cell in cells. */
+	int32 MaxBlockSize = 16;
+
+	/** Largest spread of the cell altitudes in cm. */
+	float Altitude = 100.0f;
+
+	/** Largest spread of the cell slopes in radians. */
+	float Slope = 0.02f;
+
+	/** Largest spread of the cell curvatures. */
+	float Curvature = 0.0002f;
+
+	/** Largest spread of the snow depth in meters, also the error a super-cell may accumulate before it is refined. */
+	float Depth = 0.005f;
+
+	/** Largest spread of the snow age in days. */
+	float Age = 1.0f;
+
+	bool operator==(const FSnowAdaptiveTolerances& Other) const = default;
+};
+
+/** The super-cells of one tile as columns, every block covers the cells [X0, X1) x [Y0, Y1) of the grid. */
+struct FSnowAdaptiveLeaves
+{
+	TArray<FSnowTile> Blocks;
+
+	/** Snow state of the block, the mean of its cells. */
+	FSnowCellColumn Depth;
+	FSnowCellColumn Age;
+	FSnowCellColumn Albedo;
+
+	/** Depth and age of the block when they were last written to its cells. */
+	FSnowCellColumn ScatteredDepth;
+	FSnowCellColumn ScatteredAge;
+
+	/** Mean redistribution factor of the block and the spread of its cells around it. */
+	FSnowCellColumn Factor;
+	FSnowCellColumn FactorSpread;
+
+	/** Accumulation (before redistribution) received since the block was merged, in meters. */
+	FSnowCellColumn Accumulated;
+
+	/** True if a block of the tile may have changed since its cells were last written, see FSnowAdaptiveGrid::ScatterTile. */
+	bool bPendingScatter = false;
+
+	FORCEINLINE int32 Num() const { return Blocks.Num(); }
+
+	void Reset();
+};
+
+/**
+* Adaptive quadtree over the tiles of a simulation grid.
+*
+* Every tile is split into blocks of at most MaxBlockSize cells that are subdivided into quadrants until their terrain
+* (altitude, slope, curvature, holes) and snow state (depth, age) are uniform within the tolerances. Each resulting leaf
+* is a super-cell the step kernels run on once instead of once per cell. Its depth change is added to every cell it
+* covers and its age written to them only when the cells are needed (an upload, a readback or a rebuild of the tile),
+* so steps cost O(super-cells) while the per-cell depth buffer and SnowMapTexture keep their resolution and the cells
+* keep their differences from the mean.
+*
+* The cells of a super-cell receive slightly different snowfall (their redistribution factors differ within the
+* tolerance). The error this leaves is bounded by FactorSpread * Accumulated; once it exceeds the depth tolerance the
+* tile is rebuilt from the corrected per-cell depth, which splits the blocks that diverged. Rebuilding a tile also merges
+* blocks that became uniform again.
+*/
+struct SIMULATION_API FSnowAdaptiveGrid
+{
+	/**
+	* Builds the super-cells of every tile of Grid from the per-cell state.
+	*
+	* @param Cells		terrain and snow age of the grid cells
+	* @param Factor		redistribution factor per cell
+	* @param Depth		snow depth per cell in meters
+	*/
+	void Build(const FSnowTileGrid& Grid, const FSnowCellField& Cells, const float* Factor, const float* Depth, const FSnowAdaptiveTolerances& InTolerances);
+
+	/**
+	* Adds the snowfall each cell of Tile received beyond the mean of its super-cell to Depth, then rebuilds the
+	* super-cells of the tile. The depth changes of the super-cells must have been scattered. Safe to run for different
+	* tiles in parallel.
+	*/
+	void RebuildTile(const FSnowTileGrid& Grid, const FSnowTile& Tile, const FSnowCellField& Cells, const float* Factor, float* Depth);
+
+	/** Returns true if the super-cells were built for Grid with InTolerances and have not been invalidated since. */
+	bool IsValidFor(const FSnowTileGrid& Grid, const FSnowAdaptiveTolerances& InTolerances) const
+	{
+		return bValid && TileLeaves.Num() == Grid.NumTiles() && Tolerances == InTolerances;
+	}
+
+	/** Forgets the super-cells, call after the per-cell state was written outside the kernels maintaining them. */
+	void Invalidate() { bValid = false; }
+
+	FORCEINLINE FSnowAdaptiveLeaves& GetTileLeaves(int32 TileIndex) { return TileLeaves[TileIndex]; }
+
+	/** Returns true if the snowfall difference within Leaf may exceed the depth tolerance. */
+	FORCEINLINE bool NeedsRefinement(const FSnowAdaptiveLeaves& Leaves, int32 Leaf) const
+	{
+		return Leaves.FactorSpread[Leaf] * Leaves.Accumulated[Leaf] > Tolerances.Depth;
+	}
+
+	/** Returns true if the depth of Leaf changed since it was last scattered. */
+	FORCEINLINE static bool HasDepthChanged(const FSnowAdaptiveLeaves& Leaves, int32 Leaf)
+	{
+		return Leaves.Depth[Leaf] != Leaves.ScatteredDepth[Leaf];
+	}
+
+	/** Returns true if the age of Leaf changed since it was last scattered. */
+	FORCEINLINE static bool HasAgeChanged(const FSnowAdaptiveLeaves& Leaves, int32 Leaf)
+	{
+		return Leaves.Age[Leaf] != Leaves.ScatteredAge[Leaf];
+	}
+
+	/**
+	* Adds the depth change of Leaf since it was last scattered to all cells it covers (clamped at zero) and writes its
+	* age and albedo to them. Columns passed as nullptr are skipped, Albedo goes with Age.
+	*/
+	static void Scatter(FSnowAdaptiveLeaves& Leaves, int32 Leaf, int32 Stride, float* Depth, float* Age, float* Albedo);
+
+	/** Scatters the leaves of Tile that changed since they were last scattered if the tile is pending, see Scatter. */
+	void ScatterTile(const FSnowTile& Tile, int32 Stride, float* Depth, float* Age, float* Albedo);
+
+	/** Scatters every pending tile of Grid, a no-op if the super-cells are not valid for Grid. */
+	void ScatterPending(const FSnowTileGrid& Grid, float* Depth, float* Age, float* Albedo);
+
+	/** Total number of super-cells. */
+	int64 NumLeaves() const;
+
+private:
+	/** Adds Block as a super-cell of Leaves if it is uniform, otherwise recurses into its quadrants. */
+	void Subdivide(const FSnowTile& Block, int32 Stride, const FSnowCellField& Cells, const float* Factor, const float* Depth, FSnowAdaptiveLeaves& Leaves) const;
+
+	void BuildTile(const FSnowTileGrid& Grid, const FSnowTile& Tile, const FSnowCellField& Cells, const float* Factor, const float* Depth);
+
+	TArray<FSnowAdaptiveLeaves> TileLeaves;
+	FSnowAdaptiveTolerances Tolerances;
+	bool bValid = false;
+};
@@ -0,0 +1,116 @@
+#include "SnowTiles.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarSnowParallelTiles(
+	TEXT("snow.Sim.ParallelTiles"),
+	1,
+	TEXT("1 = run snow simulation tile kernels on the task graph, 0 = run all tiles on the calling thread.\n")
+	TEXT("Results are identical either way; use 0 to profile or debug a single thread."),
+	ECVF_Default);
+
+bool FSnowTileGrid::IsParallelEnabled()
+{
+	return CVarSnowParallelTiles.GetValueOnAnyThread() != 0;
+}
+
+void FSnowDirtyTileTracker::Consume(const FSnowTileGrid& Grid, const FSnowTileVersions& Versions, TArray<FSnowTile>& OutRegions)
+{
+	OutRegions.Reset();
+
+	const int32 NumTiles = Grid.NumTiles();
+	if (Versions.Num() != NumTiles)
+	{
+		// Versions do not describe this grid, report everything
+		Seen.Reset();
+		if (NumTiles > 0)
+		{
+			FSnowTile& Region = OutRegions.AddDefaulted_GetRef();
+			Region.X1 = Grid.GridX;
+			Region.Y1 = Grid.GridY;
+		}
+		return;
+	}
+
+	if (Seen.Num() != NumTiles)
+	{
+		Seen.Init(0, NumTiles);
+	}
+
+	Dirty.Init(false, NumTiles);
+	int32 NumDirty = 0;
+	for (int32 TileIndex = 0; TileIndex < NumTiles; ++TileIndex)
+	{
+		if (Versions.Versions[TileIndex] != Seen[TileIndex])
+		{
+			Seen[TileIndex] = Versions.Versions[TileIndex];
+			Dirty[TileIndex] = true;
+			++NumDirty;
+		}
+	}
+
+	if (NumDirty == 0)
+	{
+		return;
+	}
+	if (NumDirty == NumTiles)
+	{
+		FSnowTile& Region = OutRegions.AddDefaulted_GetRef();
+		Region.X1 = Grid.GridX;
+		Region.Y1 = Grid.GridY;
+		return;
+	}
+
+	for (int32 TileY = 0; TileY < Grid.TilesY; ++TileY)
+	{
+		int32 TileX = 0;
+		while (TileX < Grid.TilesX)
+		{
+			if (!Dirty[TileY * Grid.TilesX + TileX])
+			{
+				++TileX;
+				continue;
+			}
+
+			// Span of consecutive dirty tiles
+			const int32 SpanBegin = TileX;
+			while (TileX < Grid.TilesX && Dirty[TileY * Grid.TilesX + TileX])
+			{
+				++TileX;
+			}
+			const FSnowTile First = Grid.GetTile(TileY * Grid.TilesX + SpanBegin);
+			const FSnowTile Last = Grid.GetTile(TileY * Grid.TilesX + TileX - 1);
+
+			// Extend the rectangle ending at the previous tile row if it covers exactly the same columns
+			FSnowTile* Above = OutRegions.FindByPredicate([&First, &Last](const FSnowTile& Region)
+			{
+				return Region.Y1 == First.Y0 && Region.X0 == First.X0 && Region.X1 == Last.X1;
+			});
+			if (Above)
+			{
+				Above->Y1 = First.Y1;
+			}
+			else
+			{
+				FSnowTile& Region = OutRegions.AddDefaulted_GetRef();
+				Region.X0 = First.X0;
+				Region.Y0 = First.Y0;
+				Region.X1 = Last.X1;
+				Region.Y1 = Last.Y1;
+			}
+		}
+	}
+
+	if (OutRegions.Num() > MaxRegions)
+	{
+		FSnowTile Bounds = OutRegions[0];
+		for (const FSnowTile& Region : OutRegions)
+		{
+			Bounds.X0 = FMath::Min(Bounds.X0, Region.X0);
+			Bounds.Y0 = FMath::Min(Bounds.Y0, Region.Y0);
+			Bounds.X1 = FMath::Max(Bounds.X1, Region.X1);
+			Bounds.Y1 = FMath::Max(Bounds.Y1, Region.Y1);
+		}
+		OutRegions.Reset();
+		OutRegions.Add(Bounds);
+	}
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include <type_traits>
+
+/** Default tile edge length in cells. 64 x 64 floats are 16 KB per column, so a few columns of a tile stay in L2. */
+constexpr int32 SnowDefaultTileSize = 64;
+
+/** Largest partial result ReduceTiles keeps per tile in the grid's persistent buffer. */
+constexpr int32 SnowMaxTilePartialBytes = 64;
+
+/** A rectangular block of cells [X0, X1) x [Y0, Y1) of the simulation grid. */
+struct FSnowTile
+{
+	/** Index of the tile in row-major tile order. */
+	int32 Index = 0;
+
+	int32 X0 = 0;
+	int32 Y0 = 0;
+	int32 X1 = 0;
+	int32 Y1 = 0;
+
+	FORCEINLINE int32 Width() const { return X1 - X0; }
+	FORCEINLINE int32 Height() const { return Y1 - Y0; }
+	FORCEINLINE int32 Num() const { return Width() * Height(); }
+};
+
+/**
+* Splits a GridX x GridY cell grid into square tiles and schedules kernels over them.
+*
+* The tile layout depends only on the grid and tile size, never on the number of worker threads. Reductions produce one
+* partial per tile and combine the partials in tile order on the calling thread, so their results are bit-identical
+* whatever the thread count or scheduling order. The partials live in a buffer sized by Initialize, so reductions do
+* not allocate; a grid runs one reduction at a time.
+*/
+struct SIMULATION_API FSnowTileGrid
+{
+	int32 GridX = 0;
+	int32 GridY = 0;
+	int32 TileSize = SnowDefaultTileSize;
+	int32 TilesX = 0;
+	int32 TilesY = 0;
+
+	/** Upper bound of worker threads a kernel may occupy, 0 lets ParallelFor use every task graph worker. */
+	int32 MaxWorkers = 0;
+
+	void Initialize(int32 InGridX, int32 InGridY, int32 InTileSize = SnowDefaultTileSize)
+	{
+		GridX = FMath::Max(0, InGridX);
+		GridY = FMath::Max(0, InGridY);
+		TileSize = FMath::Max(1, InTileSize);
+		TilesX = FMath::DivideAndRoundUp(GridX, TileSize);
+		TilesY = FMath::DivideAndRoundUp(GridY, TileSize);
+		PartialsBuffer.SetNumUninitialized(NumTiles() * SnowMaxTilePartialBytes);
+	}
+
+	FORCEINLINE int32 NumTiles() const { return TilesX * TilesY; }
+
+	FORCEINLINE FSnowTile GetTile(int32 TileIndex) const
+	{
+		FSnowTile Tile;
+		Tile.Index = TileIndex;
+		Tile.X0 = (TileIndex % TilesX) * TileSize;
+		Tile.Y0 = (TileIndex / TilesX) * TileSize;
+		Tile.X1 = FMath::Min(Tile.X0 + TileSize, GridX);
+		Tile.Y1 = FMath::Min(Tile.Y0 + TileSize, GridY);
+		return Tile;
+	}
+
+	/** Returns true if tiles should be distributed over the task graph (see snow.Sim.ParallelTiles). */
+	static bool IsParallelEnabled();
+
+	/** Runs Body once per tile. Tiles are independent, so Body must only touch cells inside the tile it is given. */
+	template <typename FuncType>
+	void ForEachTile(FuncType&& Body) const
+	{
+		const int32 Num = NumTiles();
+		const EParallelForFlags Flags = (IsParallelEnabled() && Num > 1) ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread;
+		if (MaxWorkers > 0 && MaxWorkers < Num)
+		{
+			// Interleave the tiles over a fixed number of buckets so at most MaxWorkers threads run at once
+			const int32 NumBuckets = MaxWorkers;
+			ParallelFor(NumBuckets, [this, &Body, Num, NumBuckets](int32 Bucket)
+			{
+				for (int32 TileIndex = Bucket; TileIndex < Num; TileIndex += NumBuckets)
+				{
+					Body(GetTile(TileIndex));
+				}
+			}, Flags);
+			return;
+		}
+
+		ParallelFor(Num, [this, &Body](int32 TileIndex)
+		{
+			Body(GetTile(TileIndex));
+		}, Flags);
+	}
+
+	/** Runs Body(CellIndex) for every cell, tile by tile and row by row within a tile. */
+	template <typename FuncType>
+	void ForEachCell(FuncType&& Body) const
+	{
+		ForEachTile([this, &Body](const FSnowTile& Tile)
+		{
+			for (int32 Y = Tile.Y0; Y < Tile.Y1; ++Y)
+			{
+				const int32 RowEnd = Y * GridX + Tile.X1;
+				for (int32 Index = Y * GridX + Tile.X0; Index < RowEnd; ++Index)
+				{
+					Body(Index);
+				}
+			}
+		});
+	}
+
+	/**
+	* Deterministic reduction: TileBody returns the partial result of one tile, the partials are then folded with Combine
+	* in tile order starting from Identity.
+	*/
+	template <typename T, typename TileFuncType, typename CombineFuncType>
+	T ReduceTiles(T Identity, TileFuncType&& TileBody, CombineFuncType&& Combine) const
+	{
+		static_assert(sizeof(T) <= SnowMaxTilePartialBytes && alignof(T) <= 16 && std::is_trivially_destructible_v<T>,
+			"Tile partials must fit the persistent partials buffer");
+		const int32 Num = NumTiles();
+		check(PartialsBuffer.Num() >= Num * SnowMaxTilePartialBytes);
+		uint8* Partials = PartialsBuffer.GetData();
+		ForEachTile([Partials, &TileBody](const FSnowTile& Tile)
+		{
+			new (Partials + Tile.Index * SnowMaxTilePartialBytes) T(TileBody(Tile));
+		});
+
+		T Result = Identity;
+		for (int32 TileIndex = 0; TileIndex < Num; ++TileIndex)
+		{
+			Result = Combine(Result, *reinterpret_cast<const T*>(Partials + TileIndex * SnowMaxTilePartialBytes));
+		}
+		return Result;
+	}
+
+private:
+	/** One SnowMaxTilePartialBytes slot per tile for the partials of ReduceTiles. */
+	mutable TArray<uint8, TAlignedHeapAllocator<16>> PartialsBuffer;
+};
+
+/**
+* Change counter per tile. Kernels bump the counter of every tile they modify, consumers such as texture uploaders
+* compare the counters against the ones they have seen to find the tiles that changed since their last visit.
+*/
+struct FSnowTileVersions
+{
+	TArray<uint32> Versions;
+
+	/** Counters start at 1 so a consumer that has not seen anything yet treats every tile as changed. */
+	void Reset(int32 NumTiles) { Versions.Init(1, NumTiles); }
+
+	/** Only the worker that owns the tile may mark it, counters of different tiles never share a lock. */
+	FORCEINLINE void Mark(int32 TileIndex) { ++Versions[TileIndex]; }
+
+	void MarkAll()
+	{
+		for (uint32& Version : Versions)
+		{
+			++Version;
+		}
+	}
+
+	FORCEINLINE int32 Num() const { return Versions.Num(); }
+};
+
+/** Remembers the tile versions a consumer has seen and turns the changed tiles into a few merged rectangles. */
+struct SIMULATION_API FSnowDirtyTileTracker
+{
+	/** Above this many rectangles the regions are collapsed into their bounding box. */
+	static constexpr int32 MaxRegions = 16;
+
+	/**
+	* Collects the tiles of Grid whose version changed since the last call as rectangles in cells. Runs of dirty tiles
+	* in a tile row are merged into spans, and spans with the same extent in consecutive rows are merged into one
+	* rectangle. OutRegions is empty if nothing changed.
+	*/
+	void Consume(const FSnowTileGrid& Grid, const FSnowTileVersions& Versions, TArray<FSnowTile>& OutRegions);
+
+	/** Forgets every version seen, the next Consume reports the whole grid. */
+	void Invalidate() { Seen.Reset(); }
+
+private:
+	TArray<uint32> Seen;
+	TBitArray<> Dirty;
+};
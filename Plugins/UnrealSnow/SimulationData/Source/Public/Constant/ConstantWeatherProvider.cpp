@@ -1,5 +1,6 @@
 #include "ConstantWeatherProvider.h"
 #include "ClimateData.h"
+#include "SnowStats.h"
 
 UConstantWeatherProvider::UConstantWeatherProvider()
 {
@@ -7,8 +8,12 @@ UConstantWeatherProvider::UConstantWeatherProvider()
 
 void UConstantWeatherProvider::Initialize(FDateTime StartTime, FDateTime EndTime)
 {
+	SNOW_SCOPE(ProviderInitialize);
+
 	UE_LOG(LogTemp, Display, TEXT("[Weather] Constant provider initialized: T=%.1f°C, RH=%.1f%%, Wind=%.1f m/s, SW=%.0f W/m², LW=%.0f W/m², Precip=%.2f mm/h, SnowFrac=%.2f"),
 		   Temperature_C, RH_Percent, Wind_mps, SWdown_Wm2, LWdown_Wm2, Precipitation_mmph, SnowFraction);
+
+	BuildClimateTimeline(StartTime, EndTime);
 }
 
 TResourceArray<FClimateData>* UConstantWeatherProvider::CreateRawClimateDataResourceArray(FDateTime StartTime, FDateTime EndTime)
@@ -50,4 +50,6 @@ public:
 	virtual TResourceArray<FClimateData>* CreateRawClimateDataResourceArray(FDateTime StartTime, FDateTime EndTime) override;
 
 	virtual FWeatherForcingData GetWeatherForcing(FDateTime Time, int32 GridX = 0, int32 GridY = 0) override;
+
+	virtual bool IsForcingConstant() const override { return true; }
 };
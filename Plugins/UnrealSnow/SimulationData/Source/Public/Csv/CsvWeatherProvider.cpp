@@ -1,7 +1,7 @@
 #include "CsvWeatherProvider.h"
-#include "Misc/FileHelper.h"
+#include "WeatherCsvParser.h"
 #include "Misc/DateTime.h"
-#include "Internationalization/Regex.h"
+#include "SnowStats.h"
 
 UCsvWeatherProvider::UCsvWeatherProvider()
 {
@@ -9,26 +9,46 @@ UCsvWeatherProvider::UCsvWeatherProvider()
 
 void UCsvWeatherProvider::Initialize(FDateTime StartTime, FDateTime EndTime)
 {
+	SNOW_SCOPE(ProviderInitialize);
+
 	WeatherRecords.Empty();
+	ForcingCache.Close();
+	StepOrigin = StartTime;
+	RecordStep = FTimespan::FromHours(1);
+	SetUpStepCursor(ForcingCursor);
 
 	if (!LoadCsvData())
 	{
 		UE_LOG(LogTemp, Warning, TEXT("[Weather] Failed to load CSV data from %s"), *CsvFilePath.FilePath);
+		BuildClimateTimeline(StartTime, EndTime);
 		return;
 	}
 
+	// Cursors step through the records at their own spacing unless asked for another step length
+	const int32 NumRecords = GetNumRecords();
+	if (ForcingCache.IsOpen() && ForcingCache.GetStepLength() > FTimespan::Zero())
+	{
+		RecordStep = ForcingCache.GetStepLength();
+	}
+	else if (NumRecords > 1 && GetRecordTime(1) > GetRecordTime(0))
+	{
+		RecordStep = GetRecordTime(1) - GetRecordTime(0);
+	}
+	SetUpStepCursor(ForcingCursor);
+
 	UE_LOG(LogTemp, Display, TEXT("[Weather] CSV provider initialized with %d records from %s"),
-		   WeatherRecords.Num(), *CsvFilePath.FilePath);
+		   NumRecords, *CsvFilePath.FilePath);
 
 	// Log statistics
-	if (WeatherRecords.Num() > 0)
+	if (NumRecords > 0)
 	{
 		float MinTemp = FLT_MAX, MaxTemp = -FLT_MAX;
 		float MinPrecip = FLT_MAX, MaxPrecip = -FLT_MAX;
 		float MinSW = FLT_MAX, MaxSW = -FLT_MAX;
 
-		for (const auto& Record : WeatherRecords)
+		for (int32 i = 0; i < NumRecords; ++i)
 		{
+			const FWeatherForcingData Record = GetRecord(i);
 			MinTemp = FMath::Min(MinTemp, Record.Temperature_K);
 			MaxTemp = FMath::Max(MaxTemp, Record.Temperature_K);
 			MinPrecip = FMath::Min(MinPrecip, Record.PrecipRate_kgm2s);
@@ -46,85 +66,48 @@ void UCsvWeatherProvider::Initialize(FDateTime StartTime, FDateTime EndTime)
 			   MinPrecip, MaxPrecip, MeanPrecip,
 			   MinSW, MaxSW, MeanSW);
 	}
+
+	BuildClimateTimeline(StartTime, EndTime);
 }
 
 bool UCsvWeatherProvider::LoadCsvData()
 {
-	if (CsvFilePath.FilePath.IsEmpty())
+	if (!bUseForcingCache)
 	{
-		return false;
+		return FWeatherCsvParser::ParseFile(CsvFilePath.FilePath, WeatherRecords) && WeatherRecords.Num() > 0;
 	}
 
-	FString FileContent;
-	if (!FFileHelper::LoadFileToString(FileContent, *CsvFilePath.FilePath))
+	int64 SourceSize = 0;
+	uint64 SourceHash = 0;
+	if (CsvFilePath.FilePath.IsEmpty() || !FWeatherForcingCache::HashFile(CsvFilePath.FilePath, SourceSize, SourceHash))
 	{
 		return false;
 	}
 
-	TArray<FString> Lines;
-	FileContent.ParseIntoArray(Lines, TEXT("\n"), true);
-
-	if (Lines.Num() < 2) // Need at least header + one data line
+	const FString CachePath = FWeatherForcingCache::GetCachePath(CsvFilePath.FilePath);
+	const FWeatherForcingCache::EPrecision Precision = bHalfPrecisionCache ? FWeatherForcingCache::EPrecision::Float16 : FWeatherForcingCache::EPrecision::Float32;
+	if (ForcingCache.Open(CachePath, SourceSize, SourceHash) && ForcingCache.GetPrecision() == Precision)
 	{
-		return false;
+		UE_LOG(LogTemp, Display, TEXT("[Weather] Mapped forcing cache %s (%d bytes per record)"), *CachePath, ForcingCache.GetRecordSize());
+		return true;
 	}
+	ForcingCache.Close();
 
-	// Skip header line
-	for (int32 i = 1; i < Lines.Num(); ++i)
-	{
-		FWeatherForcingData Record;
-		if (ParseCsvLine(Lines[i], Record))
-		{
-			WeatherRecords.Add(Record);
-		}
-	}
-
-	// Sort by timestamp
-	WeatherRecords.Sort([](const FWeatherForcingData& A, const FWeatherForcingData& B) {
-		return A.Timestamp < B.Timestamp;
-	});
-
-	return WeatherRecords.Num() > 0;
-}
-
-bool UCsvWeatherProvider::ParseCsvLine(const FString& Line, FWeatherForcingData& OutData)
-{
-	if (Line.IsEmpty())
+	if (!FWeatherCsvParser::ParseFile(CsvFilePath.FilePath, WeatherRecords) || WeatherRecords.Num() == 0)
 	{
 		return false;
 	}
 
-	TArray<FString> Columns;
-	Line.ParseIntoArray(Columns, TEXT(","), true);
-
-	if (Columns.Num() < 8) // Minimum required columns
+	// Read the records back from the cache, so the first load sees the same (possibly quantized) values as later ones
+	if (FWeatherForcingCache::Write(CachePath, SourceSize, SourceHash, WeatherRecords, Precision) && ForcingCache.Open(CachePath, SourceSize, SourceHash))
 	{
-		return false;
+		UE_LOG(LogTemp, Display, TEXT("[Weather] Wrote forcing cache %s (%d bytes per record)"), *CachePath, ForcingCache.GetRecordSize());
+		WeatherRecords.Empty();
 	}
-
-	// Parse timestamp
-	FDateTime Timestamp;
-	if (!FDateTime::ParseIso8601(*Columns[0], Timestamp))
+	else
 	{
-		return false;
+		UE_LOG(LogTemp, Warning, TEXT("[Weather] Could not write forcing cache %s, keeping the parsed records"), *CachePath);
 	}
-
-	// Parse weather data
-	float TempC = FCString::Atof(*Columns[1]);
-	float RH_pct = FCString::Atof(*Columns[2]);
-	float Wind_mps = FCString::Atof(*Columns[3]);
-	float SWdown_Wm2 = FCString::Atof(*Columns[4]);
-	float LWdown_Wm2 = FCString::Atof(*Columns[5]);
-	float Precip_mmph = FCString::Atof(*Columns[6]);
-	float SnowFrac = FCString::Atof(*Columns[7]);
-
-	// Convert units
-	float TempK = TempC + 273.15f;
-	float RH_01 = FMath::Clamp(RH_pct / 100.0f, 0.0f, 1.0f);
-	// 1 mm precipitation = 1 kg/m²; convert mm/h to kg/m²/s by dividing by 3600
-	float Precip_kgm2s = Precip_mmph / 3600.0f;
-
-	OutData = FWeatherForcingData(Timestamp, TempK, SWdown_Wm2, LWdown_Wm2, Wind_mps, RH_01, Precip_kgm2s, SnowFrac);
 	return true;
 }
 
@@ -133,10 +116,13 @@ TResourceArray<FClimateData>* UCsvWeatherProvider::CreateRawClimateDataResourceA
 	auto* ResourceArray = new TResourceArray<FClimateData>();
 
 	// Create dummy climate data for compatibility with existing system
-	if (WeatherRecords.Num() > 0)
+	const int32 NumRecords = GetNumRecords();
+	if (NumRecords > 0)
 	{
-		for (const auto& Record : WeatherRecords)
+		ResourceArray->Reserve(NumRecords);
+		for (int32 i = 0; i < NumRecords; ++i)
 		{
+			const FWeatherForcingData Record = GetRecord(i);
 			float TempC = Record.Temperature_K - 273.15f;
 			float Precip_m = Record.PrecipRate_kgm2s * 3600.0f / 1000.0f; // Convert back to m/h
 			ResourceArray->Add(FClimateData(Precip_m, TempC));
@@ -148,114 +134,30 @@ TResourceArray<FClimateData>* UCsvWeatherProvider::CreateRawClimateDataResourceA
 
 FWeatherForcingData UCsvWeatherProvider::GetWeatherForcing(FDateTime Time, int32 GridX, int32 GridY)
 {
-	if (WeatherRecords.Num() == 0)
-	{
-		return FWeatherForcingData();
-	}
-
-	if (WeatherRecords.Num() == 1)
+	// Worker threads (e.g. FillForcingField) seek with their own cursor instead of moving the shared one
+	if (!IsInGameThread())
 	{
-		return WeatherRecords[0];
+		FWeatherForcingCursor Cursor;
+		return Sample(Cursor, Time.GetTicks());
 	}
-
-	// Find bracketing records
-	int32 Index1, Index2;
-	float Alpha;
-	FindBracketingRecords(Time, Index1, Index2, Alpha);
-
-	if (Index1 == INDEX_NONE || Index2 == INDEX_NONE)
-	{
-		// Extrapolate using the closest record
-		int32 ClosestIndex = (Time < WeatherRecords[0].Timestamp) ? 0 : WeatherRecords.Num() - 1;
-		return WeatherRecords[ClosestIndex];
-	}
-
-	// Interpolate between bracketing records
-	return InterpolateRecords(WeatherRecords[Index1], WeatherRecords[Index2], Alpha);
+	return Sample(ForcingCursor, Time.GetTicks());
 }
 
-void UCsvWeatherProvider::FindBracketingRecords(FDateTime Time, int32& OutIndex1, int32& OutIndex2, float& OutAlpha)
+void UCsvWeatherProvider::SetUpStepCursor(FWeatherForcingCursor& Cursor, FTimespan StepLength) const
 {
-	OutIndex1 = INDEX_NONE;
-	OutIndex2 = INDEX_NONE;
-	OutAlpha = 0.0f;
-
-	if (WeatherRecords.Num() < 2)
-	{
-		return;
-	}
-
-	// Binary search for the right insertion point
-	int32 Left = 0;
-	int32 Right = WeatherRecords.Num() - 1;
-
-	while (Left <= Right)
-	{
-		int32 Mid = Left + (Right - Left) / 2;
-
-		if (WeatherRecords[Mid].Timestamp < Time)
-		{
-			Left = Mid + 1;
-		}
-		else if (WeatherRecords[Mid].Timestamp > Time)
-		{
-			Right = Mid - 1;
-		}
-		else
-		{
-			// Exact match
-			OutIndex1 = Mid;
-			OutIndex2 = Mid;
-			OutAlpha = 0.0f;
-			return;
-		}
-	}
-
-	// Left is now the insertion point
-	if (Left == 0)
-	{
-		// Before first record
-		OutIndex1 = 0;
-		OutIndex2 = 0;
-		OutAlpha = 0.0f;
-	}
-	else if (Left >= WeatherRecords.Num())
-	{
-		// After last record
-		OutIndex1 = WeatherRecords.Num() - 1;
-		OutIndex2 = WeatherRecords.Num() - 1;
-		OutAlpha = 0.0f;
-	}
-	else
-	{
-		// Between two records
-		OutIndex1 = Left - 1;
-		OutIndex2 = Left;
-
-		FTimespan TimeSpan = WeatherRecords[OutIndex2].Timestamp - WeatherRecords[OutIndex1].Timestamp;
-		FTimespan TargetSpan = Time - WeatherRecords[OutIndex1].Timestamp;
+	Cursor.Reset();
+	Cursor.SetSteps(StepOrigin, StepLength > FTimespan::Zero() ? StepLength : RecordStep);
+}
 
-		if (TimeSpan.GetTotalSeconds() > 0)
-		{
-			OutAlpha = TargetSpan.GetTotalSeconds() / TimeSpan.GetTotalSeconds();
-		}
-		else
-		{
-			OutAlpha = 0.0f;
-		}
-	}
+FWeatherForcingData UCsvWeatherProvider::GetWeatherForcingAtStep(FWeatherForcingCursor& Cursor, int64 Step)
+{
+	return Sample(Cursor, Cursor.GetStepTicks(Step));
 }
 
-FWeatherForcingData UCsvWeatherProvider::InterpolateRecords(const FWeatherForcingData& Record1, const FWeatherForcingData& Record2, float Alpha)
+FWeatherForcingData UCsvWeatherProvider::Sample(FWeatherForcingCursor& Cursor, int64 Ticks) const
 {
-	return FWeatherForcingData(
-		Record1.Timestamp + (Record2.Timestamp - Record1.Timestamp) * Alpha,
-		FMath::Lerp(Record1.Temperature_K, Record2.Temperature_K, Alpha),
-		FMath::Lerp(Record1.SWdown_Wm2, Record2.SWdown_Wm2, Alpha),
-		FMath::Lerp(Record1.LWdown_Wm2, Record2.LWdown_Wm2, Alpha),
-		FMath::Lerp(Record1.Wind_mps, Record2.Wind_mps, Alpha),
-		FMath::Lerp(Record1.RH_01, Record2.RH_01, Alpha),
-		FMath::Lerp(Record1.PrecipRate_kgm2s, Record2.PrecipRate_kgm2s, Alpha),
-		FMath::Lerp(Record1.SnowFrac_01, Record2.SnowFrac_01, Alpha)
-	);
+	// Times outside the records get the closest record
+	return Cursor.Sample(Ticks, GetNumRecords(),
+		[this](int32 Index) { return GetRecordTime(Index).GetTicks(); },
+		[this](int32 Index) { return GetRecord(Index); });
 }
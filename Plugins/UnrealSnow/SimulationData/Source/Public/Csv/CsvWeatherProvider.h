@@ -1,6 +1,8 @@
 #pragma once
 
 #include "SimulationWeatherDataProviderBase.h"
+#include "WeatherForcingCache.h"
+#include "WeatherForcingCursor.h"
 #include "CsvWeatherProvider.generated.h"
 
 /**
@@ -23,6 +25,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data")
 	FString TimeFormat = TEXT("yyyy-MM-dd HH:mm");
 
+	/** Keep a columnar binary copy of the CSV next to it and map that instead of parsing the text on later loads */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data")
+	bool bUseForcingCache = true;
+
+	/** Store the cache columns as float16, 22 instead of 36 bytes per record */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data", meta = (EditCondition = "bUseForcingCache"))
+	bool bHalfPrecisionCache = false;
+
 	/** Whether the CSV contains uniform data for the entire grid */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Data")
 	bool bUniformGrid = true;
@@ -40,19 +50,38 @@ public:
 
 	virtual FWeatherForcingData GetWeatherForcing(FDateTime Time, int32 GridX = 0, int32 GridY = 0) override;
 
+	/** Steps default to the spacing of the records. */
+	virtual void SetUpStepCursor(FWeatherForcingCursor& Cursor, FTimespan StepLength = FTimespan::Zero()) const override;
+
+	/**
+	* Walks the records with Cursor, which must have been set up with SetUpStepCursor or FWeatherForcingCursor::SetSteps.
+	* Safe from any thread as long as every thread uses its own cursor.
+	*/
+	virtual FWeatherForcingData GetWeatherForcingAtStep(FWeatherForcingCursor& Cursor, int64 Step) override;
+
 private:
-	/** Parsed weather records */
+	/** Parsed weather records, empty while the records are read from ForcingCache */
 	TArray<FWeatherForcingData> WeatherRecords;
 
-	/** Load and parse the CSV file */
+	/** Mapped binary copy of the CSV */
+	FWeatherForcingCache ForcingCache;
+
+	int32 GetNumRecords() const { return ForcingCache.IsOpen() ? ForcingCache.Num() : WeatherRecords.Num(); }
+
+	FWeatherForcingData GetRecord(int32 Index) const { return ForcingCache.IsOpen() ? ForcingCache.GetRecord(Index) : WeatherRecords[Index]; }
+
+	FDateTime GetRecordTime(int32 Index) const { return ForcingCache.IsOpen() ? ForcingCache.GetTimestamp(Index) : WeatherRecords[Index].Timestamp; }
+
+	/** Map the forcing cache of the CSV file, or parse the CSV with FWeatherCsvParser and write the cache */
 	bool LoadCsvData();
 
-	/** Parse a single CSV line into weather data */
-	bool ParseCsvLine(const FString& Line, FWeatherForcingData& OutData);
+	/** Interpolated record at Ticks, read through Cursor */
+	FWeatherForcingData Sample(FWeatherForcingCursor& Cursor, int64 Ticks) const;
 
-	/** Find weather data records bracketing the given time */
-	void FindBracketingRecords(FDateTime Time, int32& OutIndex1, int32& OutIndex2, float& OutAlpha);
+	/** Cursor of GetWeatherForcing on the game thread, which queries increasing times */
+	FWeatherForcingCursor ForcingCursor;
 
-	/** Interpolate between two weather records */
-	FWeatherForcingData InterpolateRecords(const FWeatherForcingData& Record1, const FWeatherForcingData& Record2, float Alpha);
+	/** Start time of Initialize and spacing of the records, the steps of SetUpStepCursor */
+	FDateTime StepOrigin;
+	FTimespan RecordStep = FTimespan::FromHours(1);
 };
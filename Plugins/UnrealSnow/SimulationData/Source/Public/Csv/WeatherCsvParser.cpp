@@ -0,0 +1,372 @@
+#include "WeatherCsvParser.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+
+namespace WeatherCsv
+{
+	/** Columns read from every line, further columns (e.g. i, j) are ignored. */
+	constexpr int32 NumColumns = 8;
+
+	/** Bodies smaller than this are parsed as one chunk, a task is not worth it. */
+	constexpr int64 MinChunkBytes = 1 << 20;
+
+	/** Powers of ten that are exact in a double. */
+	constexpr double ExactPowersOfTen[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	FORCEINLINE bool IsDigit(ANSICHAR C)
+	{
+		return C >= '0' && C <= '9';
+	}
+
+	FORCEINLINE bool IsBlank(ANSICHAR C)
+	{
+		return C == ' ' || C == '\t' || C == '\r' || C == '"';
+	}
+
+	FORCEINLINE void Trim(const ANSICHAR*& Begin, const ANSICHAR*& End)
+	{
+		while (Begin < End && IsBlank(*Begin))
+		{
+			++Begin;
+		}
+		while (End > Begin && IsBlank(End[-1]))
+		{
+			--End;
+		}
+	}
+
+	/** Reads Count digits at P into OutValue, returns false if one of them is not a digit. */
+	FORCEINLINE bool ReadDigits(const ANSICHAR* P, int32 Count, int32& OutValue)
+	{
+		int32 Value = 0;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			if (!IsDigit(P[i]))
+			{
+				return false;
+			}
+			Value = Value * 10 + (P[i] - '0');
+		}
+		OutValue = Value;
+		return true;
+	}
+
+	FORCEINLINE const ANSICHAR* FindLineEnd(const ANSICHAR* P, const ANSICHAR* End)
+	{
+		while (P < End && *P != '\n')
+		{
+			++P;
+		}
+		return P;
+	}
+}
+
+bool FWeatherCsvParser::ParseTimestamp(const ANSICHAR* Begin, const ANSICHAR* End, FDateTime& OutTime)
+{
+	using namespace WeatherCsv;
+	Trim(Begin, End);
+	const int64 Length = End - Begin;
+
+	// yyyy-MM-dd[T| ]HH:mm[:ss][Z]
+	int32 Year, Month, Day, Hour, Minute, Second = 0;
+	if (Length >= 16 && Begin[4] == '-' && Begin[7] == '-' && (Begin[10] == 'T' || Begin[10] == ' ') && Begin[13] == ':'
+		&& ReadDigits(Begin, 4, Year) && ReadDigits(Begin + 5, 2, Month) && ReadDigits(Begin + 8, 2, Day)
+		&& ReadDigits(Begin + 11, 2, Hour) && ReadDigits(Begin + 14, 2, Minute))
+	{
+		const ANSICHAR* P = Begin + 16;
+		bool bFixedFormat = true;
+		if (P < End && *P == ':')
+		{
+			bFixedFormat = End - P >= 3 && ReadDigits(P + 1, 2, Second);
+			P += 3;
+		}
+		if (bFixedFormat && P < End && *P == 'Z')
+		{
+			++P;
+		}
+		if (bFixedFormat && P == End && FDateTime::Validate(Year, Month, Day, Hour, Minute, Second, 0))
+		{
+			OutTime = FDateTime(Year, Month, Day, Hour, Minute, Second);
+			return true;
+		}
+	}
+
+	// Fractional seconds, time zone offsets and the other ISO 8601 forms
+	TCHAR Buffer[64];
+	if (Length <= 0 || Length >= UE_ARRAY_COUNT(Buffer))
+	{
+		return false;
+	}
+	for (int64 i = 0; i < Length; ++i)
+	{
+		Buffer[i] = static_cast<TCHAR>(Begin[i]);
+	}
+	Buffer[Length] = TEXT('\0');
+	return FDateTime::ParseIso8601(Buffer, OutTime);
+}
+
+float FWeatherCsvParser::ParseFloat(const ANSICHAR* Begin, const ANSICHAR* End)
+{
+	using namespace WeatherCsv;
+	Trim(Begin, End);
+	const ANSICHAR* P = Begin;
+
+	bool bNegative = false;
+	if (P < End && (*P == '-' || *P == '+'))
+	{
+		bNegative = *P == '-';
+		++P;
+	}
+
+	// Up to 19 significant digits fit the mantissa, further integer digits only scale it
+	uint64 Mantissa = 0;
+	int32 NumDigits = 0;
+	int32 Exponent = 0;
+	for (; P < End && IsDigit(*P); ++P)
+	{
+		if (NumDigits < 19)
+		{
+			Mantissa = Mantissa * 10 + (*P - '0');
+			NumDigits += Mantissa > 0 ? 1 : 0;
+		}
+		else
+		{
+			++Exponent;
+		}
+	}
+	if (P < End && *P == '.')
+	{
+		for (++P; P < End && IsDigit(*P); ++P)
+		{
+			if (NumDigits < 19)
+			{
+				Mantissa = Mantissa * 10 + (*P - '0');
+				NumDigits += Mantissa > 0 ? 1 : 0;
+				--Exponent;
+			}
+		}
+	}
+	if (P < End && (*P == 'e' || *P == 'E'))
+	{
+		++P;
+		bool bNegativeExponent = false;
+		if (P < End && (*P == '-' || *P == '+'))
+		{
+			bNegativeExponent = *P == '-';
+			++P;
+		}
+		int32 ExplicitExponent = 0;
+		for (; P < End && IsDigit(*P); ++P)
+		{
+			ExplicitExponent = FMath::Min(ExplicitExponent * 10 + (*P - '0'), 1000);
+		}
+		Exponent += bNegativeExponent ? -ExplicitExponent : ExplicitExponent;
+	}
+
+	double Value = static_cast<double>(Mantissa);
+	if (Exponent != 0 && Mantissa != 0)
+	{
+		const int32 AbsExponent = FMath::Abs(Exponent);
+		const double Scale = AbsExponent < UE_ARRAY_COUNT(ExactPowersOfTen) ? ExactPowersOfTen[AbsExponent] : FMath::Pow(10.0, static_cast<double>(AbsExponent));
+		Value = Exponent < 0 ? Value / Scale : Value * Scale;
+	}
+	return static_cast<float>(bNegative ? -Value : Value);
+}
+
+int32 FWeatherCsvParser::ParseLines(const ANSICHAR* Begin, const ANSICHAR* End, TArray<FWeatherForcingData>& OutRecords)
+{
+	using namespace WeatherCsv;
+	int32 NumSkipped = 0;
+	const ANSICHAR* FieldBegin[NumColumns];
+	const ANSICHAR* FieldEnd[NumColumns];
+
+	for (const ANSICHAR* Line = Begin; Line < End;)
+	{
+		const ANSICHAR* LineEnd = FindLineEnd(Line, End);
+		const ANSICHAR* Next = LineEnd < End ? LineEnd + 1 : End;
+
+		// Split into the first NumColumns fields in place
+		int32 NumFields = 0;
+		bool bBlank = true;
+		const ANSICHAR* Field = Line;
+		for (const ANSICHAR* P = Line; P <= LineEnd && NumFields < NumColumns; ++P)
+		{
+			if (P == LineEnd || *P == ',')
+			{
+				FieldBegin[NumFields] = Field;
+				FieldEnd[NumFields] = P;
+				++NumFields;
+				Field = P + 1;
+			}
+			else if (!IsBlank(*P))
+			{
+				bBlank = false;
+			}
+		}
+		Line = Next;
+
+		if (bBlank)
+		{
+			continue;
+		}
+
+		FDateTime Timestamp;
+		if (NumFields < NumColumns || !ParseTimestamp(FieldBegin[0], FieldEnd[0], Timestamp))
+		{
+			++NumSkipped;
+			continue;
+		}
+
+		const float TempC = ParseFloat(FieldBegin[1], FieldEnd[1]);
+		const float RH_pct = ParseFloat(FieldBegin[2], FieldEnd[2]);
+		const float Wind_mps = ParseFloat(FieldBegin[3], FieldEnd[3]);
+		const float SWdown_Wm2 = ParseFloat(FieldBegin[4], FieldEnd[4]);
+		const float LWdown_Wm2 = ParseFloat(FieldBegin[5], FieldEnd[5]);
+		const float Precip_mmph = ParseFloat(FieldBegin[6], FieldEnd[6]);
+		const float SnowFrac = ParseFloat(FieldBegin[7], FieldEnd[7]);
+
+		// Convert units, 1 mm precipitation = 1 kg/m² so mm/h / 3600 = kg/m²/s
+		const float TempK = TempC + 273.15f;
+		const float RH_01 = FMath::Clamp(RH_pct / 100.0f, 0.0f, 1.0f);
+		const float Precip_kgm2s = Precip_mmph / 3600.0f;
+		OutRecords.Emplace(Timestamp, TempK, SWdown_Wm2, LWdown_Wm2, Wind_mps, RH_01, Precip_kgm2s, SnowFrac);
+	}
+	return NumSkipped;
+}
+
+FWeatherCsvParser::FResult FWeatherCsvParser::ParseBuffer(const ANSICHAR* Data, int64 Size, TArray<FWeatherForcingData>& OutRecords)
+{
+	using namespace WeatherCsv;
+	const double StartSeconds = FPlatformTime::Seconds();
+	FResult Result;
+	Result.NumBytes = Size;
+
+	const ANSICHAR* Begin = Data;
+	const ANSICHAR* End = Data + Size;
+
+	// UTF-8 byte order mark and header line
+	if (Size >= 3 && static_cast<uint8>(Data[0]) == 0xEF && static_cast<uint8>(Data[1]) == 0xBB && static_cast<uint8>(Data[2]) == 0xBF)
+	{
+		Begin += 3;
+	}
+	Begin = FindLineEnd(Begin, End);
+	Begin = Begin < End ? Begin + 1 : End;
+
+	// Line aligned chunks, each parsed into its own array so the records keep the file order
+	const int64 BodySize = End - Begin;
+	const int32 MaxChunks = FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads()) * 4;
+	const int32 NumChunks = static_cast<int32>(FMath::Clamp<int64>(BodySize / MinChunkBytes, 1, MaxChunks));
+	TArray<const ANSICHAR*, TInlineAllocator<64>> Bounds;
+	Bounds.SetNumUninitialized(NumChunks + 1);
+	Bounds[0] = Begin;
+	Bounds[NumChunks] = End;
+	for (int32 Chunk = 1; Chunk < NumChunks; ++Chunk)
+	{
+		const ANSICHAR* Split = FMath::Max(Begin + BodySize * Chunk / NumChunks, Bounds[Chunk - 1]);
+		Split = FindLineEnd(Split, End);
+		Bounds[Chunk] = Split < End ? Split + 1 : End;
+	}
+
+	TArray<TArray<FWeatherForcingData>, TInlineAllocator<64>> ChunkRecords;
+	TArray<int32, TInlineAllocator<64>> ChunkSkipped;
+	ChunkRecords.SetNum(NumChunks);
+	ChunkSkipped.SetNumZeroed(NumChunks);
+	ParallelFor(NumChunks, [&Bounds, &ChunkRecords, &ChunkSkipped](int32 Chunk)
+	{
+		// Data lines are rarely shorter than 48 bytes
+		ChunkRecords[Chunk].Reserve(static_cast<int32>((Bounds[Chunk + 1] - Bounds[Chunk]) / 48));
+		ChunkSkipped[Chunk] = ParseLines(Bounds[Chunk], Bounds[Chunk + 1], ChunkRecords[Chunk]);
+	}, NumChunks > 1 ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	int32 NumRecords = 0;
+	for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+	{
+		NumRecords += ChunkRecords[Chunk].Num();
+		Result.NumSkipped += ChunkSkipped[Chunk];
+	}
+	OutRecords.Reserve(OutRecords.Num() + NumRecords);
+	for (TArray<FWeatherForcingData>& Records : ChunkRecords)
+	{
+		OutRecords.Append(MoveTemp(Records));
+	}
+
+	Result.NumRecords = NumRecords;
+	Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+	return Result;
+}
+
+bool FWeatherCsvParser::ParseFile(const FString& Path, TArray<FWeatherForcingData>& OutRecords, FResult* OutResult)
+{
+	OutRecords.Reset();
+	if (Path.IsEmpty())
+	{
+		return false;
+	}
+
+	// Map the file, fall back to reading it in one block where mapping is not supported
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*Path));
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile ? MappedFile->MapRegion() : nullptr);
+	TArray<uint8> Loaded;
+	const uint8* Bytes = nullptr;
+	int64 Size = 0;
+	if (MappedRegion)
+	{
+		Bytes = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(Loaded, *Path, FILEREAD_Silent))
+	{
+		Bytes = Loaded.GetData();
+		Size = Loaded.Num();
+	}
+	else
+	{
+		return false;
+	}
+
+	FResult Result;
+	const bool bUtf16 = Size >= 2 && ((Bytes[0] == 0xFF && Bytes[1] == 0xFE) || (Bytes[0] == 0xFE && Bytes[1] == 0xFF));
+	if (bUtf16)
+	{
+		// The tokenizer works on 8-bit text, UTF-16 files are converted once
+		FString Text;
+		FFileHelper::BufferToString(Text, Bytes, static_cast<int32>(Size));
+		const FTCHARToUTF8 Utf8(*Text);
+		Result = ParseBuffer(Utf8.Get(), Utf8.Length(), OutRecords);
+	}
+	else
+	{
+		Result = ParseBuffer(reinterpret_cast<const ANSICHAR*>(Bytes), Size, OutRecords);
+	}
+
+	// Files are usually written in time order, only sort if they are not
+	bool bSorted = true;
+	for (int32 i = 1; i < OutRecords.Num() && bSorted; ++i)
+	{
+		bSorted = !(OutRecords[i].Timestamp < OutRecords[i - 1].Timestamp);
+	}
+	if (!bSorted)
+	{
+		OutRecords.StableSort([](const FWeatherForcingData& A, const FWeatherForcingData& B)
+		{
+			return A.Timestamp < B.Timestamp;
+		});
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("[Weather] Parsed %s: %d records (%d lines skipped), %.1f MB in %.3f s (%.0f MB/s)"),
+		*Path, Result.NumRecords, Result.NumSkipped, Result.NumBytes / (1024.0 * 1024.0), Result.Seconds,
+		Result.Seconds > 0.0 ? Result.NumBytes / (1024.0 * 1024.0) / Result.Seconds : 0.0);
+
+	if (OutResult)
+	{
+		*OutResult = Result;
+	}
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ClimateData.h"
+
+/**
+* Parser for forcing CSV files shared by the CSV based providers. Expected columns after one header line:
+*
+*	time, T2m_C, RH_pct, Wind_mps, SWdown_Wm2, LWdown_Wm2, Precip_mmph, SnowFrac_0_1
+*
+* The file is memory mapped (or read in one block where mapping is unavailable) and tokenized in place without
+* allocating per line or field. Timestamps of the form yyyy-MM-dd[T| ]HH:mm[:ss][Z] take a fixed-format fast path,
+* anything else falls back to FDateTime::ParseIso8601. Large files are split into line aligned chunks parsed in
+* parallel; the records keep their file order and are only sorted if the file is not already in time order.
+*/
+struct SIMULATIONDATA_API FWeatherCsvParser
+{
+	/** Line count statistics of a parse. */
+	struct FResult
+	{
+		int32 NumRecords = 0;
+
+		/** Data lines dropped because they had too few columns or an unreadable timestamp. */
+		int32 NumSkipped = 0;
+
+		int64 NumBytes = 0;
+		double Seconds = 0.0;
+	};
+
+	/** Parses the file at Path into OutRecords (converted to forcing units, sorted by time). Returns false if it cannot be read. */
+	static bool ParseFile(const FString& Path, TArray<FWeatherForcingData>& OutRecords, FResult* OutResult = nullptr);
+
+	/** Parses Size bytes of UTF-8 CSV text, including the header line, and appends the records to OutRecords. */
+	static FResult ParseBuffer(const ANSICHAR* Data, int64 Size, TArray<FWeatherForcingData>& OutRecords);
+
+	/** Parses a timestamp, the fixed format without allocating, other ISO 8601 forms through FDateTime::ParseIso8601. */
+	static bool ParseTimestamp(const ANSICHAR* Begin, const ANSICHAR* End, FDateTime& OutTime);
+
+	/** Parses a decimal float with optional sign, fraction and exponent; like Atof an empty or invalid field is 0. */
+	static float ParseFloat(const ANSICHAR* Begin, const ANSICHAR* End);
+
+private:
+	/** Parses the complete lines in [Begin, End) into OutRecords, returns the number of lines skipped. */
+	static int32 ParseLines(const ANSICHAR* Begin, const ANSICHAR* End, TArray<FWeatherForcingData>& OutRecords);
+};
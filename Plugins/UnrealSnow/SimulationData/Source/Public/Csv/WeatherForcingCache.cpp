@@ -0,0 +1,266 @@
+#include "WeatherForcingCache.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+
+namespace WeatherForcingCache
+{
+	constexpr uint32 Magic = 0x46574E53; // "SNWF"
+	constexpr uint32 Version = 1;
+
+	/** CityHash takes 32 bit lengths, larger files are hashed in blocks. */
+	constexpr int64 HashBlockSize = 1 << 30;
+
+	static_assert(sizeof(FWeatherForcingCache::FHeader) % sizeof(int64) == 0, "Step column must stay 8 byte aligned");
+
+	struct FColumnInfo
+	{
+		float Scale;
+		float Offset;
+		const char* Units;
+	};
+
+	/** Encoding of the float16 columns and the unit of every column, float32 columns are stored unscaled. */
+	constexpr FColumnInfo ColumnInfos[FWeatherForcingCache::NumColumns] = {
+		{ 1.0f, 273.15f, "K" },
+		{ 1.0f, 0.0f, "W/m2" },
+		{ 1.0f, 0.0f, "W/m2" },
+		{ 1.0f, 0.0f, "m/s" },
+		{ 1.0f, 0.0f, "1" },
+		{ 1.0f / 3600.0f, 0.0f, "kg/m2/s" },
+		{ 1.0f, 0.0f, "1" }
+	};
+
+	FORCEINLINE float GetMember(const FWeatherForcingData& Record, int32 Column)
+	{
+		switch (Column)
+		{
+		case FWeatherForcingCache::Temperature: return Record.Temperature_K;
+		case FWeatherForcingCache::SWdown: return Record.SWdown_Wm2;
+		case FWeatherForcingCache::LWdown: return Record.LWdown_Wm2;
+		case FWeatherForcingCache::Wind: return Record.Wind_mps;
+		case FWeatherForcingCache::RH: return Record.RH_01;
+		case FWeatherForcingCache::Precip: return Record.PrecipRate_kgm2s;
+		default: return Record.SnowFrac_01;
+		}
+	}
+
+	FORCEINLINE int32 GetElementSize(FWeatherForcingCache::EPrecision Precision)
+	{
+		return Precision == FWeatherForcingCache::EPrecision::Float16 ? sizeof(FFloat16) : sizeof(float);
+	}
+}
+
+FWeatherForcingCache::FWeatherForcingCache() = default;
+
+FWeatherForcingCache::~FWeatherForcingCache()
+{
+	Close();
+}
+
+FString FWeatherForcingCache::GetCachePath(const FString& SourcePath)
+{
+	return SourcePath + TEXT(".snowforcing");
+}
+
+bool FWeatherForcingCache::HashFile(const FString& Path, int64& OutSize, uint64& OutHash)
+{
+	using namespace WeatherForcingCache;
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IMappedFileHandle> Mapped(PlatformFile.OpenMapped(*Path));
+	TUniquePtr<IMappedFileRegion> Region(Mapped ? Mapped->MapRegion() : nullptr);
+	TArray<uint8> Data;
+	const uint8* Bytes = nullptr;
+	int64 Size = 0;
+	if (Region)
+	{
+		Bytes = Region->GetMappedPtr();
+		Size = Region->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(Data, *Path, FILEREAD_Silent))
+	{
+		Bytes = Data.GetData();
+		Size = Data.Num();
+	}
+	else
+	{
+		return false;
+	}
+
+	uint64 Hash = CityHash64(reinterpret_cast<const char*>(&Size), sizeof(Size));
+	for (int64 Offset = 0; Offset < Size; Offset += HashBlockSize)
+	{
+		const uint32 Length = static_cast<uint32>(FMath::Min(HashBlockSize, Size - Offset));
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Bytes + Offset), Length, Hash);
+	}
+	OutSize = Size;
+	OutHash = Hash;
+	return true;
+}
+
+bool FWeatherForcingCache::Write(const FString& Path, int64 SourceSize, uint64 SourceHash, TConstArrayView<FWeatherForcingData> Records, EPrecision Precision)
+{
+	using namespace WeatherForcingCache;
+	const int32 NumRecords = Records.Num();
+	if (NumRecords == 0)
+	{
+		return false;
+	}
+
+	// The step is the largest common divisor of all offsets from the first record, hourly data gets hour steps
+	const int64 OriginTicks = Records[0].Timestamp.GetTicks();
+	int64 StepTicks = 0;
+	for (int32 i = 1; i < NumRecords; ++i)
+	{
+		int64 A = Records[i].Timestamp.GetTicks() - OriginTicks;
+		int64 B = StepTicks;
+		while (B != 0)
+		{
+			const int64 R = A % B;
+			A = B;
+			B = R;
+		}
+		StepTicks = FMath::Abs(A);
+	}
+	if (StepTicks == 0)
+	{
+		StepTicks = ETimespan::TicksPerHour;
+	}
+
+	FHeader Header;
+	Header.Magic = Magic;
+	Header.Version = Version;
+	Header.SourceSize = SourceSize;
+	Header.SourceHash = SourceHash;
+	Header.NumRecords = NumRecords;
+	Header.OriginTicks = OriginTicks;
+	Header.StepTicks = StepTicks;
+	Header.Precision = Precision;
+	Header.NumStoredColumns = NumColumns;
+	for (int32 Column = 0; Column < NumColumns; ++Column)
+	{
+		const bool bFloat16 = Precision == EPrecision::Float16;
+		Header.Scale[Column] = bFloat16 ? ColumnInfos[Column].Scale : 1.0f;
+		Header.Offset[Column] = bFloat16 ? ColumnInfos[Column].Offset : 0.0f;
+		FCStringAnsi::Strncpy(Header.Units[Column], ColumnInfos[Column].Units, UE_ARRAY_COUNT(Header.Units[Column]));
+	}
+
+	const int32 ElementSize = GetElementSize(Precision);
+	TArray64<uint8> Data;
+	Data.SetNumUninitialized(sizeof(FHeader) + static_cast<int64>(NumRecords) * (sizeof(int64) + NumColumns * ElementSize));
+	FMemory::Memcpy(Data.GetData(), &Header, sizeof(FHeader));
+
+	int64* OutSteps = reinterpret_cast<int64*>(Data.GetData() + sizeof(FHeader));
+	for (int32 i = 0; i < NumRecords; ++i)
+	{
+		OutSteps[i] = (Records[i].Timestamp.GetTicks() - OriginTicks) / StepTicks;
+	}
+
+	uint8* OutColumn = reinterpret_cast<uint8*>(OutSteps + NumRecords);
+	for (int32 Column = 0; Column < NumColumns; ++Column)
+	{
+		if (Precision == EPrecision::Float16)
+		{
+			FFloat16* Out = reinterpret_cast<FFloat16*>(OutColumn);
+			const float InvScale = 1.0f / Header.Scale[Column];
+			for (int32 i = 0; i < NumRecords; ++i)
+			{
+				Out[i] = FFloat16((GetMember(Records[i], Column) - Header.Offset[Column]) * InvScale);
+			}
+		}
+		else
+		{
+			float* Out = reinterpret_cast<float*>(OutColumn);
+			for (int32 i = 0; i < NumRecords; ++i)
+			{
+				Out[i] = GetMember(Records[i], Column);
+			}
+		}
+		OutColumn += static_cast<int64>(NumRecords) * ElementSize;
+	}
+
+	return FFileHelper::SaveArrayToFile(Data, *Path);
+}
+
+bool FWeatherForcingCache::Open(const FString& Path, int64 SourceSize, uint64 SourceHash)
+{
+	using namespace WeatherForcingCache;
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Path))
+	{
+		return false;
+	}
+
+	const uint8* Bytes = nullptr;
+	int64 Size = 0;
+	MappedFile.Reset(PlatformFile.OpenMapped(*Path));
+	MappedRegion.Reset(MappedFile ? MappedFile->MapRegion() : nullptr);
+	if (MappedRegion)
+	{
+		Bytes = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(Loaded, *Path, FILEREAD_Silent))
+	{
+		Bytes = Loaded.GetData();
+		Size = Loaded.Num();
+	}
+
+	const FHeader* Candidate = reinterpret_cast<const FHeader*>(Bytes);
+	const bool bValid = Size >= static_cast<int64>(sizeof(FHeader))
+		&& Candidate->Magic == Magic
+		&& Candidate->Version == Version
+		&& Candidate->SourceSize == SourceSize
+		&& Candidate->SourceHash == SourceHash
+		&& (Candidate->Precision == EPrecision::Float32 || Candidate->Precision == EPrecision::Float16)
+		&& Candidate->NumStoredColumns == NumColumns
+		&& Candidate->StepTicks > 0
+		&& Candidate->NumRecords > 0 && Candidate->NumRecords <= MAX_int32
+		&& Size == static_cast<int64>(sizeof(FHeader)) + Candidate->NumRecords * (sizeof(int64) + NumColumns * GetElementSize(Candidate->Precision));
+	if (!bValid)
+	{
+		Close();
+		return false;
+	}
+
+	Header = Candidate;
+	Steps = reinterpret_cast<const int64*>(Bytes + sizeof(FHeader));
+	const uint8* Column = reinterpret_cast<const uint8*>(Steps + Header->NumRecords);
+	for (int32 i = 0; i < NumColumns; ++i)
+	{
+		Columns[i] = Column;
+		Column += Header->NumRecords * GetElementSize(Header->Precision);
+	}
+	return true;
+}
+
+void FWeatherForcingCache::Close()
+{
+	Header = nullptr;
+	Steps = nullptr;
+	FMemory::Memzero(Columns);
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	Loaded.Empty();
+}
+
+FWeatherForcingData FWeatherForcingCache::GetRecord(int32 Index) const
+{
+	return FWeatherForcingData(
+		GetTimestamp(Index),
+		GetValue(Temperature, Index),
+		GetValue(SWdown, Index),
+		GetValue(LWdown, Index),
+		GetValue(Wind, Index),
+		GetValue(RH, Index),
+		GetValue(Precip, Index),
+		GetValue(SnowFrac, Index));
+}
+
+int32 FWeatherForcingCache::GetRecordSize() const
+{
+	return Header ? sizeof(int64) + NumColumns * WeatherForcingCache::GetElementSize(Header->Precision) : 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ClimateData.h"
+#include "Math/Float16.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+* Columnar binary copy of a forcing time series, written next to its source file so later loads map it instead of
+* parsing text. Layout (little endian):
+*
+*	FHeader
+*	int64 Step[NumRecords]				Timestamp = OriginTicks + Step * StepTicks
+*	T Column[NumColumns][NumRecords]	T is float or FFloat16, Value = Stored * Scale + Offset
+*
+* The header records the size and hash of the source file and the unit of every column; a cache whose source changed,
+* or that was written by another version, is not opened. Float16 columns store temperature in °C and precipitation
+* in mm/h, which keeps their resolution within what the forcing files carry.
+*/
+class SIMULATIONDATA_API FWeatherForcingCache
+{
+public:
+	enum class EPrecision : uint32
+	{
+		Float32,
+		Float16
+	};
+
+	/** Columns in the order of the FWeatherForcingData members. */
+	enum EColumn
+	{
+		Temperature,
+		SWdown,
+		LWdown,
+		Wind,
+		RH,
+		Precip,
+		SnowFrac,
+		NumColumns
+	};
+
+	struct FHeader
+	{
+		uint32 Magic = 0;
+		uint32 Version = 0;
+		int64 SourceSize = 0;
+		uint64 SourceHash = 0;
+		int64 NumRecords = 0;
+		int64 OriginTicks = 0;
+		int64 StepTicks = 0;
+		EPrecision Precision = EPrecision::Float32;
+		uint32 NumStoredColumns = 0;
+		float Scale[NumColumns] = {};
+		float Offset[NumColumns] = {};
+
+		/** Unit of the decoded values of every column, null terminated. */
+		ANSICHAR Units[NumColumns][16] = {};
+	};
+
+	FWeatherForcingCache();
+	~FWeatherForcingCache();
+
+	/** Path of the cache belonging to SourcePath. */
+	static FString GetCachePath(const FString& SourcePath);
+
+	/** Size and hash of the file at Path, identifying the source a cache was written for. */
+	static bool HashFile(const FString& Path, int64& OutSize, uint64& OutHash);
+
+	/** Writes Records (sorted by time) to Path. */
+	static bool Write(const FString& Path, int64 SourceSize, uint64 SourceHash, TConstArrayView<FWeatherForcingData> Records, EPrecision Precision);
+
+	/** Maps the cache at Path if it was written for the given source, returns false otherwise. */
+	bool Open(const FString& Path, int64 SourceSize, uint64 SourceHash);
+
+	void Close();
+
+	FORCEINLINE bool IsOpen() const { return Header != nullptr; }
+
+	FORCEINLINE EPrecision GetPrecision() const { return Header ? Header->Precision : EPrecision::Float32; }
+
+	FORCEINLINE int32 Num() const { return Header ? static_cast<int32>(Header->NumRecords) : 0; }
+
+	/** Spacing of the record timestamps, every timestamp is a multiple of it after the first. */
+	FORCEINLINE FTimespan GetStepLength() const { return FTimespan(Header ? Header->StepTicks : 0); }
+
+	FORCEINLINE FDateTime GetTimestamp(int32 Index) const
+	{
+		return FDateTime(Header->OriginTicks + Steps[Index] * Header->StepTicks);
+	}
+
+	FORCEINLINE float GetValue(EColumn Column, int32 Index) const
+	{
+		const float Stored = Header->Precision == EPrecision::Float16
+			? reinterpret_cast<const FFloat16*>(Columns[Column])[Index].GetFloat()
+			: reinterpret_cast<const float*>(Columns[Column])[Index];
+		return Stored * Header->Scale[Column] + Header->Offset[Column];
+	}
+
+	/** Decodes the record at Index. */
+	FWeatherForcingData GetRecord(int32 Index) const;
+
+	/** Bytes per record in the cache, against sizeof(FWeatherForcingData) in memory. */
+	int32 GetRecordSize() const;
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	/** File contents where mapping is unavailable. */
+	TArray<uint8> Loaded;
+
+	const FHeader* Header = nullptr;
+	const int64* Steps = nullptr;
+	const uint8* Columns[NumColumns] = {};
+};
@@ -1,6 +1,8 @@
 #include "MeteoSwissWeatherDataProvider.h"
 #include "SimulationData.h"
 #include "SimulationWeatherDataProviderBase.h"
+#include "SnowStats.h"
+#include "Misc/StringBuilder.h"
 
 TResourceArray<FClimateData>* UMeteoSwissWeatherDataProvider::CreateRawClimateDataResourceArray(FDateTime StartTime, FDateTime EndTime)
 {
@@ -17,25 +19,120 @@ TResourceArray<FClimateData>* UMeteoSwissWeatherDataProvider::CreateRawClimateDa
 
 void UMeteoSwissWeatherDataProvider::Initialize(FDateTime StartTime, FDateTime EndTime)
 {
-	auto CurrentTime = StartTime;
-	auto SimulationTime = EndTime - StartTime;
-	auto SimulationHours = SimulationTime.GetTotalHours();
+	SNOW_SCOPE(ProviderInitialize);
 
-	FString ContextString;
-	for (int Hour = 0; Hour < SimulationHours; ++Hour)
+	ClimateData.Reset();
+
+	const bool bTemperatureValid = TemperatureData && TemperatureData->GetRowStruct() && TemperatureData->GetRowStruct()->IsChildOf(FTemperatureData::StaticStruct());
+	const bool bPrecipitationValid = PrecipitationData && PrecipitationData->GetRowStruct() && PrecipitationData->GetRowStruct()->IsChildOf(FPrecipitationData::StaticStruct());
+	if (!bTemperatureValid || !bPrecipitationValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Weather] MeteoSwiss provider needs a FTemperatureData and a FPrecipitationData table"));
+		BuildClimateTimeline(StartTime, EndTime);
+		return;
+	}
+
+	// Row keys are yyyyMMddHH, hour 0 is the hour containing StartTime
+	const FDateTime FirstHour(StartTime.GetYear(), StartTime.GetMonth(), StartTime.GetDay(), StartTime.GetHour());
+	const int32 NumHours = FMath::Max(0, FMath::CeilToInt((EndTime - StartTime).GetTotalHours()));
+
+	TArray<float> Temperature;
+	TArray<float> Precipitation;
+	TBitArray<> HasTemperature;
+	TBitArray<> HasPrecipitation;
+	const int32 NumTemperatureHours = GatherHours(TemperatureData, FirstHour, NumHours, Temperature, HasTemperature,
+		[](const uint8* Row) { return reinterpret_cast<const FTemperatureData*>(Row)->Temperature; });
+	const int32 NumPrecipitationHours = GatherHours(PrecipitationData, FirstHour, NumHours, Precipitation, HasPrecipitation,
+		[](const uint8* Row) { return reinterpret_cast<const FPrecipitationData*>(Row)->Precipitation; });
+
+	// Missing temperatures are interpolated between the closest measured hours, missing precipitation is none
+	int32 Previous = INDEX_NONE;
+	for (int32 Hour = 0; Hour <= NumHours; ++Hour)
+	{
+		if (Hour < NumHours && !HasTemperature[Hour])
+		{
+			continue;
+		}
+		const int32 Next = Hour < NumHours ? Hour : INDEX_NONE;
+		for (int32 Missing = Previous + 1; Missing < Hour; ++Missing)
+		{
+			if (Previous == INDEX_NONE || Next == INDEX_NONE)
+			{
+				Temperature[Missing] = Previous != INDEX_NONE ? Temperature[Previous] : (Next != INDEX_NONE ? Temperature[Next] : 0.0f);
+			}
+			else
+			{
+				Temperature[Missing] = FMath::Lerp(Temperature[Previous], Temperature[Next], static_cast<float>(Missing - Previous) / (Next - Previous));
+			}
+		}
+		Previous = Hour;
+	}
+
+	if (NumTemperatureHours < NumHours || NumPrecipitationHours < NumHours)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Weather] MeteoSwiss data is missing %d temperature and %d precipitation hours of %d, temperature interpolated, precipitation set to 0"),
+			NumHours - NumTemperatureHours, NumHours - NumPrecipitationHours, NumHours);
+	}
+
+	ClimateData.SetNumUninitialized(NumHours);
+	for (int32 Hour = 0; Hour < NumHours; ++Hour)
 	{
-		auto YearString = FString::FromInt(CurrentTime.GetYear());
-		auto MonthString = FString::Printf(TEXT("%02d"), CurrentTime.GetMonth());
-		auto DayString = FString::Printf(TEXT("%02d"), CurrentTime.GetDay());
-		auto HourString = FString::Printf(TEXT("%02d"), CurrentTime.GetHour());
-		auto RowKey = YearString + MonthString + DayString + HourString;
-
-		FTemperatureData* Temperature = TemperatureData->FindRow<FTemperatureData>(FName(*RowKey), ContextString);
-		FPrecipitationData* Precipitation = PrecipitationData->FindRow<FPrecipitationData>(FName(*RowKey), ContextString);
-		
-		ClimateData.Push(FClimateData(Precipitation->Precipitation, Temperature->Temperature));
-		CurrentTime += FTimespan(1, 0, 0);
+		ClimateData[Hour] = FClimateData(Precipitation[Hour], Temperature[Hour]);
+	}
+
+	BuildClimateTimeline(StartTime, EndTime);
+}
+
+int32 UMeteoSwissWeatherDataProvider::GatherHours(const UDataTable* Table, const FDateTime& FirstHour, int32 NumHours, TArray<float>& OutValues, TBitArray<>& OutPresent, TFunctionRef<float(const uint8*)> ValueOf)
+{
+	OutValues.SetNumZeroed(NumHours);
+	OutPresent.Init(false, NumHours);
+
+	int32 NumFound = 0;
+	TStringBuilder<32> Key;
+	for (const TPair<FName, uint8*>& Row : Table->GetRowMap())
+	{
+		Key.Reset();
+		Row.Key.AppendString(Key);
+
+		// yyyyMMddHH
+		constexpr int32 KeyLength = 10;
+		int32 Digits[KeyLength];
+		bool bValidKey = Key.Len() == KeyLength;
+		for (int32 i = 0; bValidKey && i < KeyLength; ++i)
+		{
+			bValidKey = FChar::IsDigit(Key.GetData()[i]);
+			Digits[i] = Key.GetData()[i] - TEXT('0');
+		}
+		if (!bValidKey)
+		{
+			continue;
+		}
+		const int32 Year = Digits[0] * 1000 + Digits[1] * 100 + Digits[2] * 10 + Digits[3];
+		const int32 Month = Digits[4] * 10 + Digits[5];
+		const int32 Day = Digits[6] * 10 + Digits[7];
+		const int32 HourOfDay = Digits[8] * 10 + Digits[9];
+		if (!FDateTime::Validate(Year, Month, Day, HourOfDay, 0, 0, 0))
+		{
+			continue;
+		}
+
+		const FDateTime Time(Year, Month, Day, HourOfDay);
+		if (Time < FirstHour)
+		{
+			continue;
+		}
+		const int64 Hour = (Time - FirstHour).GetTicks() / ETimespan::TicksPerHour;
+		if (Hour >= NumHours)
+		{
+			continue;
+		}
+
+		NumFound += OutPresent[Hour] ? 0 : 1;
+		OutPresent[Hour] = true;
+		OutValues[Hour] = ValueOf(Row.Value);
 	}
+	return NumFound;
 }
 
 float UMeteoSwissWeatherDataProvider::GetMeasurementAltitude()
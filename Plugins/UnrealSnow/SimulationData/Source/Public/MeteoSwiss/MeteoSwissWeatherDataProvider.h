@@ -40,7 +40,8 @@ public:
 };
 
 /**
-* 
+* Provider for one MeteoSwiss station, reading hourly temperature and precipitation from DataTables keyed yyyyMMddHH.
+* Each table is walked once into an hour indexed array; hours missing from the tables are filled explicitly.
 */
 UCLASS(Blueprintable, BlueprintType)
 class SIMULATIONDATA_API UMeteoSwissWeatherDataProvider : public USimulationWeatherDataProviderBase
@@ -50,6 +51,12 @@ class SIMULATIONDATA_API UMeteoSwissWeatherDataProvider : public USimulationWeat
 private:
 	TArray<FClimateData> ClimateData;
 
+	/**
+	* Writes the value of every row of Table within [FirstHour, FirstHour + NumHours) to OutValues at its hour and marks
+	* the hour in OutPresent. Rows whose key is not a valid hour are ignored. Returns the number of hours found.
+	*/
+	static int32 GatherHours(const UDataTable* Table, const FDateTime& FirstHour, int32 NumHours, TArray<float>& OutValues, TBitArray<>& OutPresent, TFunctionRef<float(const uint8*)> ValueOf);
+
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Climate)
 	UDataTable* TemperatureData;
@@ -1,6 +1,89 @@
 
 #include "SimulationWeatherDataProviderBase.h"
 #include "SimulationData.h"
+#include "Misc/ScopeLock.h"
+
+void USimulationWeatherDataProviderBase::FillForcingField(FDateTime Time, const FIntRect& Rect, const FWeatherForcingField& OutField)
+{
+	const int32 Count = FMath::Max(0, Rect.Width()) * FMath::Max(0, Rect.Height());
+	if (Count == 0)
+	{
+		return;
+	}
+
+	const FWeatherForcingData Forcing = GetWeatherForcing(Time, Rect.Min.X, Rect.Min.Y);
+	auto Fill = [Count](float* Column, float Value)
+	{
+		if (Column)
+		{
+			for (int32 i = 0; i < Count; ++i)
+			{
+				Column[i] = Value;
+			}
+		}
+	};
+	Fill(OutField.Temperature_K, Forcing.Temperature_K);
+	Fill(OutField.PrecipRate_kgm2s, Forcing.PrecipRate_kgm2s);
+	Fill(OutField.SnowFrac_01, Forcing.SnowFrac_01);
+}
+
+void USimulationWeatherDataProviderBase::SetUpStepCursor(FWeatherForcingCursor& Cursor, FTimespan StepLength) const
+{
+	Cursor.Reset();
+	Cursor.SetSteps(ForcingStartTime, StepLength > FTimespan::Zero() ? StepLength : FTimespan::FromHours(1));
+}
+
+FWeatherForcingData USimulationWeatherDataProviderBase::GetWeatherForcingAtStep(FWeatherForcingCursor& Cursor, int64 Step)
+{
+	return GetWeatherForcing(FDateTime(Cursor.GetStepTicks(Step)));
+}
+
+TConstArrayView<FClimateData> USimulationWeatherDataProviderBase::GetClimateTimeline()
+{
+	if (OnDemandClimateSteps > 0)
+	{
+		// Consumers that need every step at once (GPU uploads) get the full timeline generated once
+		FScopeLock Lock(&ClimateTimelineLock);
+		if (ClimateTimeline.Num() == 0)
+		{
+			TUniquePtr<TResourceArray<FClimateData>> ClimateData(CreateRawClimateDataResourceArray(OnDemandStartTime, OnDemandEndTime));
+			if (ClimateData.IsValid())
+			{
+				ClimateTimeline.Append(ClimateData->GetData(), ClimateData->Num());
+			}
+		}
+	}
+	return ClimateTimeline;
+}
+
+void USimulationWeatherDataProviderBase::SetOnDemandClimateTimeline(FDateTime StartTime, FDateTime EndTime, int32 NumSteps)
+{
+	FScopeLock Lock(&ClimateTimelineLock);
+	ClimateTimeline.Empty();
+	ForcingStartTime = StartTime;
+	OnDemandStartTime = StartTime;
+	OnDemandEndTime = EndTime;
+	OnDemandClimateSteps = FMath::Max(0, NumSteps);
+
+	UE_LOG(LogTemp, Display, TEXT("[Weather] Climate timeline: %d steps x %d stations, generated on demand"),
+		GetNumClimateSteps(), GetNumClimateStations());
+}
+
+void USimulationWeatherDataProviderBase::BuildClimateTimeline(FDateTime StartTime, FDateTime EndTime)
+{
+	ClimateTimeline.Reset();
+	ForcingStartTime = StartTime;
+	OnDemandClimateSteps = 0;
+
+	TUniquePtr<TResourceArray<FClimateData>> ClimateData(CreateRawClimateDataResourceArray(StartTime, EndTime));
+	if (ClimateData.IsValid())
+	{
+		ClimateTimeline.Append(ClimateData->GetData(), ClimateData->Num());
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("[Weather] Climate timeline: %d steps x %d stations (%.1f KB)"),
+		GetNumClimateSteps(), GetNumClimateStations(), ClimateTimeline.GetAllocatedSize() / 1024.0);
+}
 
 
 
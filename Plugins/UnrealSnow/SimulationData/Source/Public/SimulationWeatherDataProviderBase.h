@@ -4,12 +4,25 @@
 
 #include "RHIResources.h"
 #include "ClimateData.h"
+#include "WeatherForcingCursor.h"
+#include "HAL/CriticalSection.h"
 #include "SimulationWeatherDataProviderBase.generated.h"
 
 struct FWeatherForcingData;
 
 class ASnowSimulationActor;
 
+/**
+* Forcing of a rectangle of grid cells as columns of Rect.Area() values, cell (X, Y) of the rect at
+* [(Y - Rect.Min.Y) * Rect.Width() + X - Rect.Min.X]. Columns left nullptr are not written.
+*/
+struct FWeatherForcingField
+{
+	float* Temperature_K = nullptr;
+	float* PrecipRate_kgm2s = nullptr;
+	float* SnowFrac_01 = nullptr;
+};
+
 // @TODO simplify API because most weather data sources only provide monthly or daily average values.
 // @TODO use stochastic downscaling for hourly weather data
 // @TODO extend ActorComponent?
@@ -29,11 +42,110 @@ public:
 	/** Returns the altitude at which the measurements were taken. */
 	virtual float GetMeasurementAltitude() PURE_VIRTUAL(USimulationWeatherDataProviderBase::GetMeasurementAltitude, return 0.0f;);
 
-	/** Creates a resource array containing all weather data. Caller is responsible of deleting the resource. */
+	/**
+	* Creates a resource array containing all weather data. Caller is responsible of deleting the resource.
+	* Only used to build the climate timeline, simulations should read GetClimateTimeline instead.
+	*/
 	virtual TResourceArray<FClimateData>* CreateRawClimateDataResourceArray(FDateTime StartTime, FDateTime EndTime) PURE_VIRTUAL(USimulationWeatherDataProviderBase::CreateRawClimateDataResourceArray, return nullptr;);
 
 	/** Get comprehensive weather forcing data for a specific time and location */
 	virtual FWeatherForcingData GetWeatherForcing(FDateTime Time, int32 GridX = 0, int32 GridY = 0) { return FWeatherForcingData(); }
+
+	/**
+	* Writes the forcing of the grid cells in Rect (Max exclusive) at Time to OutField, the batched form of
+	* GetWeatherForcing. Safe to call from worker threads once the provider is initialized. The default samples
+	* GetWeatherForcing once and fills the whole rect with it, providers with spatially varying forcing override it.
+	*/
+	virtual void FillForcingField(FDateTime Time, const FIntRect& Rect, const FWeatherForcingField& OutField);
+
+	/**
+	* Called once before FillForcingField is called for Time from worker threads, never concurrently with it, so
+	* providers can convert the forcing of Time once instead of per rect. Does nothing by default.
+	*/
+	virtual void PrepareForcingField(FDateTime Time) {}
+
+	/**
+	* Sets up Cursor for GetWeatherForcingAtStep: step 0 is the start time passed to Initialize and steps are StepLength
+	* apart, the native spacing of the provider (an hour by default) if StepLength is zero.
+	*/
+	virtual void SetUpStepCursor(FWeatherForcingCursor& Cursor, FTimespan StepLength = FTimespan::Zero()) const;
+
+	/**
+	* Forcing at a step index of Cursor, for loops over increasing steps. The default samples GetWeatherForcing at the
+	* time of the step, providers with a time series override it to walk the series with the cursor.
+	*/
+	virtual FWeatherForcingData GetWeatherForcingAtStep(FWeatherForcingCursor& Cursor, int64 Step);
+
+	/** Returns true if FillForcingField varies over the grid, so simulations should fill a field per tile instead of using one GetWeatherForcing sample. */
+	virtual bool HasSpatialForcing() const { return false; }
+
+	/** Returns true if GetWeatherForcing returns the same conditions at every time, so callers may sample it once. */
+	virtual bool IsForcingConstant() const { return false; }
+
+	/** Number of stations per timeline step, the timeline holds the stations of a step next to each other. */
+	virtual int32 GetNumClimateStations() const { return 1; }
+
+	/**
+	* The climate data of the whole simulation period. The view stays valid until the next Initialize. Providers that
+	* generate their data on demand build the full timeline on the first call, under a lock so concurrent callers
+	* build it once.
+	*/
+	TConstArrayView<FClimateData> GetClimateTimeline();
+
+	/** Number of steps (hours) of the climate timeline. */
+	int32 GetNumClimateSteps() const
+	{
+		return OnDemandClimateSteps > 0 ? OnDemandClimateSteps : ClimateTimeline.Num() / FMath::Max(1, GetNumClimateStations());
+	}
+
+	/**
+	* Climate data of a station at a timeline step, steps outside the timeline are clamped. On demand providers copy it
+	* out of their cache, so it is returned by value.
+	*/
+	FORCEINLINE FClimateData GetClimateData(int32 Step, int32 Station = 0) const
+	{
+		const int32 NumSteps = GetNumClimateSteps();
+		if (NumSteps == 0)
+		{
+			return FClimateData();
+		}
+		const int32 NumStations = FMath::Max(1, GetNumClimateStations());
+		Step = FMath::Clamp(Step, 0, NumSteps - 1);
+		Station = FMath::Clamp(Station, 0, NumStations - 1);
+		if (OnDemandClimateSteps > 0)
+		{
+			return ReadClimateStep(Step, Station);
+		}
+		return ClimateTimeline[Step * NumStations + Station];
+	}
+
+protected:
+	/** Builds the climate timeline from CreateRawClimateDataResourceArray, called once at the end of Initialize. */
+	void BuildClimateTimeline(FDateTime StartTime, FDateTime EndTime);
+
+	/**
+	* Called instead of BuildClimateTimeline by providers that generate their data on demand: GetClimateData reads
+	* ReadClimateStep, and the full timeline is only built if GetClimateTimeline is called.
+	*/
+	void SetOnDemandClimateTimeline(FDateTime StartTime, FDateTime EndTime, int32 NumSteps);
+
+	/** Copy of a station at a timeline step for on demand providers, default data if the step cannot be read. Safe to call from any thread. */
+	virtual FClimateData ReadClimateStep(int32 Step, int32 Station) const { return FClimateData(); }
+
+private:
+	/** Immutable after Initialize (or after the first GetClimateTimeline of on demand providers), [Step * NumStations + Station]. */
+	TArray<FClimateData> ClimateTimeline;
+
+	/** Guards the lazy build of ClimateTimeline for on demand providers. */
+	FCriticalSection ClimateTimelineLock;
+
+	/** Start time of the last Initialize, step 0 of SetUpStepCursor. */
+	FDateTime ForcingStartTime;
+
+	/** Period and number of steps of on demand providers, 0 steps if the timeline is built at Initialize. */
+	FDateTime OnDemandStartTime;
+	FDateTime OnDemandEndTime;
+	int32 OnDemandClimateSteps = 0;
 };
 
 
@@ -0,0 +1,20 @@
+#include "SnowStats.h"
+
+DEFINE_STAT(STAT_SnowBeginPlay);
+DEFINE_STAT(STAT_SnowTick);
+DEFINE_STAT(STAT_SnowStepSimulation);
+DEFINE_STAT(STAT_SnowProviderInitialize);
+DEFINE_STAT(STAT_SnowForcingFetch);
+DEFINE_STAT(STAT_SnowKernel);
+DEFINE_STAT(STAT_SnowStats);
+DEFINE_STAT(STAT_SnowHalfConversion);
+DEFINE_STAT(STAT_SnowUpload);
+DEFINE_STAT(STAT_SnowMaterialBinding);
+DEFINE_STAT(STAT_SnowDebugDraw);
+
+DEFINE_STAT(STAT_SnowCellsStepped);
+DEFINE_STAT(STAT_SnowBytesUploaded);
+
+UE_TRACE_CHANNEL_DEFINE(SnowSimChannel);
+
+CSV_DEFINE_CATEGORY_MODULE(SIMULATIONDATA_API, SnowSim, true);
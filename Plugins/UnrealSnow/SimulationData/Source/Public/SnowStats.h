@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Trace/Trace.h"
+
+/**
+* Profiling hooks of the snow pipeline, shared by the weather providers and the simulation:
+*
+*	stat Snow						per-phase timings and counters
+*	-trace=cpu,SnowSim				Insights scopes, the SnowSim channel can be toggled on its own
+*	csvprofile start				SnowSim category of the CSV profiler
+*/
+DECLARE_STATS_GROUP(TEXT("Snow"), STATGROUP_Snow, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("BeginPlay"), STAT_SnowBeginPlay, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tick"), STAT_SnowTick, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("StepSimulation"), STAT_SnowStepSimulation, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Provider initialize"), STAT_SnowProviderInitialize, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Forcing fetch"), STAT_SnowForcingFetch, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Kernel"), STAT_SnowKernel, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Stats"), STAT_SnowStats, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Half conversion"), STAT_SnowHalfConversion, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Upload"), STAT_SnowUpload, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Material binding"), STAT_SnowMaterialBinding, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Debug draw"), STAT_SnowDebugDraw, STATGROUP_Snow, SIMULATIONDATA_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cells stepped"), STAT_SnowCellsStepped, STATGROUP_Snow, SIMULATIONDATA_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes uploaded"), STAT_SnowBytesUploaded, STATGROUP_Snow, SIMULATIONDATA_API);
+
+UE_TRACE_CHANNEL_EXTERN(SnowSimChannel, SIMULATIONDATA_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SIMULATIONDATA_API, SnowSim);
+
+/** Times the enclosing scope as STAT_Snow<Phase> in stat Snow, as Snow::<Phase> in Insights and in the CSV profiler. */
+#define SNOW_SCOPE(Phase) \
+	SCOPE_CYCLE_COUNTER(STAT_Snow##Phase); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Snow::" #Phase, SnowSimChannel); \
+	CSV_SCOPED_TIMING_STAT(SnowSim, Phase)
+
+namespace SnowStats
+{
+	/** Counts cells run through a step kernel, a super-cell of the adaptive grid counting once. Safe to call from worker threads. */
+	FORCEINLINE void AddCellsStepped(int64 NumCells)
+	{
+		INC_DWORD_STAT_BY(STAT_SnowCellsStepped, NumCells);
+		CSV_CUSTOM_STAT(SnowSim, CellsStepped, static_cast<int32>(NumCells), ECsvCustomStatOp::Accumulate);
+	}
+
+	/** Counts bytes handed to the RHI for texture updates. */
+	FORCEINLINE void AddBytesUploaded(int64 NumBytes)
+	{
+		INC_DWORD_STAT_BY(STAT_SnowBytesUploaded, NumBytes);
+		CSV_CUSTOM_STAT(SnowSim, BytesUploaded, static_cast<int32>(NumBytes), ECsvCustomStatOp::Accumulate);
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+* Counter-based random numbers. The n-th value of a generator is a pure function of its key and n, the key is hashed
+* from a seed and any number of coordinates (stream, hour, station, ...). Generators for different coordinates are
+* independent and can be created on any thread in any order; they never touch the global FMath random state.
+*
+* Keys are chained through the SplitMix64 finalizer, values are the SplitMix64 sequence started at the key.
+*/
+struct FSnowRandom
+{
+	explicit FSnowRandom(uint64 InKey) : Key(InKey) {}
+
+	/** Generator for the coordinates Keys of Seed. */
+	template <typename... KeyTypes>
+	static FSnowRandom Make(int32 Seed, KeyTypes... Keys)
+	{
+		uint64 Hash = Mix(static_cast<uint64>(static_cast<uint32>(Seed)) + Gamma);
+		((Hash = Mix(Hash ^ (static_cast<uint64>(Keys) + Gamma))), ...);
+		return FSnowRandom(Hash);
+	}
+
+	FORCEINLINE uint64 NextUInt64()
+	{
+		return Mix(Key + Gamma * ++Counter);
+	}
+
+	/** Uniform in [0, 1). */
+	FORCEINLINE float FRand()
+	{
+		return static_cast<float>(NextUInt64() >> 40) * (1.0f / 16777216.0f);
+	}
+
+	/** Uniform in [Min, Max). */
+	FORCEINLINE float FRandRange(float Min, float Max)
+	{
+		return Min + (Max - Min) * FRand();
+	}
+
+	/** Uniform in [0, N), N > 0. */
+	FORCEINLINE uint32 RandHelper(uint32 N)
+	{
+		return static_cast<uint32>(((NextUInt64() >> 32) * N) >> 32);
+	}
+
+	/** Fills OutPermutation with a shuffle of 0-255 repeated twice, the layout simplex noise expects. */
+	void MakePermutation(uint8 (&OutPermutation)[512])
+	{
+		for (int32 i = 0; i < 256; ++i)
+		{
+			OutPermutation[i] = static_cast<uint8>(i);
+		}
+		for (int32 i = 255; i > 0; --i)
+		{
+			Swap(OutPermutation[i], OutPermutation[RandHelper(i + 1)]);
+		}
+		FMemory::Memcpy(OutPermutation + 256, OutPermutation, 256);
+	}
+
+	static FORCEINLINE uint64 Mix(uint64 Z)
+	{
+		Z = (Z ^ (Z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		Z = (Z ^ (Z >> 27)) * 0x94d049bb133111ebull;
+		return Z ^ (Z >> 31);
+	}
+
+private:
+	static constexpr uint64 Gamma = 0x9e3779b97f4a7c15ull;
+
+	uint64 Key = 0;
+	uint64 Counter = 0;
+};
@@ -2,7 +2,21 @@
 #include "SimulationData.h"
 #include "SimulationWeatherDataProviderBase.h"
 #include "SimplexNoiseBPLibrary.h"
+#include "SnowRandom.h"
 #include "Math/UnrealMathUtility.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
+#include "SnowStats.h"
+
+/** Independent random streams of the generator, draws are keyed by stream, hour and station. */
+enum class EStochasticStream : uint32
+{
+	Markov,
+	Rainfall,
+	Temperature,
+	PrecipitationNoise,
+	TemperatureNoise
+};
 
 UStochasticWeatherDataProvider::UStochasticWeatherDataProvider()
 {
@@ -11,126 +25,275 @@ UStochasticWeatherDataProvider::UStochasticWeatherDataProvider()
 
 void UStochasticWeatherDataProvider::Initialize(FDateTime StartTime, FDateTime EndTime)
 {
+	SNOW_SCOPE(ProviderInitialize);
+
+	// A prefetch reads the generator inputs reset below
+	CancelPrefetch();
+
 	// Initial state
-	State = (FMath::FRand() < P_I_W) ? WeatherState::WET : WeatherState::DRY;
+	State = (FSnowRandom::Make(Seed, EStochasticStream::Markov, -1).FRand() < P_I_W) ? WeatherState::WET : WeatherState::DRY;
 
 	// Generate Temperature Noise which is assumed to be constant
 	const float TemperatureNoiseScale = 0.01f;
-	auto TemperatureNoise = std::vector<std::vector<float>>(Resolution, std::vector<float>(Resolution));
-	for (int32 Y = 0; Y < Resolution; ++Y)
+	uint8 TemperaturePermutation[512];
+	FSnowRandom::Make(Seed, EStochasticStream::TemperatureNoise).MakePermutation(TemperaturePermutation);
+	TemperatureNoise.SetNumUninitialized(Resolution * Resolution);
+	USimplexNoiseBPLibrary::SimplexNoiseGrid2D(Resolution, Resolution, TemperatureNoiseScale, TemperaturePermutation, TemperatureNoise.GetData());
+	for (float& Noise : TemperatureNoise)
 	{
-		for (int32 X = 0; X < Resolution; ++X)
-		{
-			float Noise = USimplexNoiseBPLibrary::SimplexNoiseScaled2D(X * TemperatureNoiseScale, Y * TemperatureNoiseScale, 2.0f);
-			TemperatureNoise[X][Y] = Noise;
-		}
+		Noise *= 2.0f;
 	}
 
-	// Generate precipitation
 	StartTimeRef = StartTime;
 	auto TimeSpan = EndTime - StartTime;
-	TotalHours =  static_cast<int32>(TimeSpan.GetTotalHours());
-	FDateTime CurrentTime = StartTime;
+	TotalHours = FMath::Max(static_cast<int32>(TimeSpan.GetTotalHours()), 0);
 
-	ClimateData = std::vector<std::vector<FClimateData>>(TotalHours, std::vector<FClimateData>(Resolution * Resolution));
+	// Hours are generated on demand chunk by chunk, only the Markov state at the start of every chunk is kept
+	FScopeLock Lock(&CacheLock);
+	ChunkSize = FMath::Max(1, ChunkHours);
+	ChunkStartStates.SetNumUninitialized(FMath::DivideAndRoundUp(TotalHours, ChunkSize));
+	for (int32 Hour = 0; Hour < TotalHours; ++Hour)
+	{
+		if (Hour % ChunkSize == 0)
+		{
+			ChunkStartStates[Hour / ChunkSize] = State;
+		}
+		State = NextState(State, Hour);
+	}
+	ChunkSlots.Init(INDEX_NONE, ChunkStartStates.Num());
+	Chunks.Reset();
+	UseClock = 0;
+	PreparedHour.Reset();
 
-	auto Measurement = std::vector<std::vector<float>>(Resolution, std::vector<float>(Resolution));
+	SetOnDemandClimateTimeline(StartTime, EndTime, TotalHours);
+}
 
-	for (int32 Hour = 0; Hour < TotalHours; ++Hour)
+WeatherState UStochasticWeatherDataProvider::NextState(WeatherState Current, int32 Hour) const
+{
+	const float Transition = FSnowRandom::Make(Seed, EStochasticStream::Markov, Hour).FRand();
+	switch (Current)
+	{
+	case WeatherState::WET:
+		return (Transition < P_WW) ? WeatherState::WET : WeatherState::DRY;
+	case WeatherState::DRY:
+		return (Transition < P_WD) ? WeatherState::WET : WeatherState::DRY;
+	default:
+		return WeatherState::DRY;
+	}
+}
+
+void UStochasticWeatherDataProvider::GenerateHour(int32 Hour, WeatherState HourState, const FDateTime& Time, FClimateData* OutStations) const
+{
+	// Precipitation noise, one field per wet hour shared by all stations
+	const float PrecipitationNoiseScale = 0.01f;
+	TArray<float> Measurement;
+	if (HourState == WeatherState::WET)
 	{
-		for (int32 Y = 0; Y < Resolution; ++Y)
+		uint8 PrecipitationPermutation[512];
+		FSnowRandom::Make(Seed, EStochasticStream::PrecipitationNoise, Hour).MakePermutation(PrecipitationPermutation);
+		Measurement.SetNumUninitialized(Resolution * Resolution);
+		USimplexNoiseBPLibrary::SimplexNoiseGrid2D(Resolution, Resolution, PrecipitationNoiseScale, PrecipitationPermutation, Measurement.GetData());
+		for (float& Noise : Measurement)
 		{
-			for (int32 X = 0; X < Resolution; ++X)
-			{
-				float Precipitation = 0.0f;
-
-				// Precipitation
-				if (State == WeatherState::WET)
-				{
-					// Generate Precipitation noise for each station
-					const float PrecipitationNoiseScale = 0.01;
-					for (int32 NoiseY = 0; NoiseY < Resolution; ++NoiseY)
-					{
-						for (int32 NoiseX = 0; NoiseX < Resolution; ++NoiseX)
-						{
-							float Noise = FMath::Max(USimplexNoiseBPLibrary::SimplexNoiseScaled2D(NoiseX * PrecipitationNoiseScale, NoiseY * PrecipitationNoiseScale, 0.9f) + 0.2f, 0.0f);
-							Measurement[NoiseX][NoiseY] = Noise;
-						}
-					}
-
-					// @TODO paper?
-					const float RainFallMM = 2.5f * FMath::Exp(2.5f * FMath::FRand()) / 24.0f;
-					Precipitation = RainFallMM * Measurement[X][Y];
-				}
-
-				// @TODO paper?
-				// Temperature
-				float SeasonalOffset = -FMath::Cos(CurrentTime.GetDayOfYear() * 2 * PI / 365.0f) * 9 + FMath::FRandRange(-0.5f, 0.5f);
-				const float BaseTemperature = 10;
-				const float OvercastTemperatureOffset = State == WeatherState::WET ? -8 : 0;
-				const float T = BaseTemperature + SeasonalOffset + OvercastTemperatureOffset + TemperatureNoise[X][Y];
-
-				ClimateData[Hour][X + Y * Resolution] = FClimateData(Precipitation, T);
-			}
+			Noise = FMath::Max(Noise * 0.9f + 0.2f, 0.0f);
 		}
+	}
+
+	// @TODO paper?
+	const float SeasonalTemperature = -FMath::Cos(Time.GetDayOfYear() * 2 * PI / 365.0f) * 9;
+	const float BaseTemperature = 10;
+	const float OvercastTemperatureOffset = HourState == WeatherState::WET ? -8 : 0;
 
-		// Next state
-		WeatherState NextState;
-		switch (State)
+	for (int32 Station = 0; Station < Resolution * Resolution; ++Station)
+	{
+		float Precipitation = 0.0f;
+		if (HourState == WeatherState::WET)
 		{
-		case WeatherState::WET:
-			NextState = (FMath::FRand() < P_WW) ? WeatherState::WET : WeatherState::DRY;
-			break;
-		case WeatherState::DRY:
-			NextState = (FMath::FRand() < P_WD) ? WeatherState::WET : WeatherState::DRY;
-			break;
-		default:
-			NextState = WeatherState::DRY;
-			break;
+			// @TODO paper?
+			const float RainFallMM = 2.5f * FMath::Exp(2.5f * FSnowRandom::Make(Seed, EStochasticStream::Rainfall, Hour, Station).FRand()) / 24.0f;
+			Precipitation = RainFallMM * Measurement[Station];
 		}
 
-		State = NextState;
+		// Temperature
+		const float SeasonalOffset = SeasonalTemperature + FSnowRandom::Make(Seed, EStochasticStream::Temperature, Hour, Station).FRandRange(-0.5f, 0.5f);
+		const float T = BaseTemperature + SeasonalOffset + OvercastTemperatureOffset + TemperatureNoise[Station];
 
-		CurrentTime += FTimespan(1, 0, 0);
-		USimplexNoiseBPLibrary::SetNoiseSeed(FMath::Rand());
+		OutStations[Station] = FClimateData(Precipitation, T);
 	}
 }
 
-TResourceArray<FClimateData>* UStochasticWeatherDataProvider::CreateRawClimateDataResourceArray(FDateTime StartTime, FDateTime EndTime)
+void UStochasticWeatherDataProvider::GenerateChunk(int32 Chunk, FClimateData* OutStations) const
 {
-	auto TimeSpan = EndTime - StartTime;
-	int32 TotalHoursLocal = static_cast<int>(TimeSpan.GetTotalHours());
+	const int32 FirstHour = Chunk * ChunkSize;
+	const int32 NumHours = FMath::Min(ChunkSize, TotalHours - FirstHour);
 
-	TResourceArray<FClimateData>* ClimateResourceArray = new TResourceArray<FClimateData>();
-	ClimateResourceArray->Reserve(TotalHoursLocal * Resolution * Resolution);
+	TArray<WeatherState, TInlineAllocator<168>> HourStates;
+	HourStates.SetNumUninitialized(NumHours);
+	WeatherState HourState = ChunkStartStates[Chunk];
+	for (int32 i = 0; i < NumHours; ++i)
+	{
+		HourStates[i] = HourState;
+		HourState = NextState(HourState, FirstHour + i);
+	}
 
-	for (int32 Hour = 0; Hour < TotalHoursLocal; ++Hour)
+	const int32 NumStations = Resolution * Resolution;
+	ParallelFor(NumHours, [this, &HourStates, OutStations, FirstHour, NumStations](int32 i)
 	{
-		for (int32 ClimateIndex = 0; ClimateIndex < Resolution * Resolution; ++ClimateIndex)
+		const int32 Hour = FirstHour + i;
+		GenerateHour(Hour, HourStates[i], StartTimeRef + FTimespan::FromHours(Hour), OutStations + i * NumStations);
+	});
+}
+
+int32 UStochasticWeatherDataProvider::AcquireChunkSlot(int32 Chunk) const
+{
+	int32 SlotIndex;
+	if (Chunks.Num() < FMath::Max(1, MaxCachedChunks))
+	{
+		SlotIndex = Chunks.AddDefaulted();
+	}
+	else
+	{
+		// Reuse the least recently read chunk
+		SlotIndex = 0;
+		for (int32 i = 1; i < Chunks.Num(); ++i)
 		{
-			ClimateResourceArray->Add(ClimateData[Hour][ClimateIndex]);
+			SlotIndex = Chunks[i].LastUse < Chunks[SlotIndex].LastUse ? i : SlotIndex;
 		}
+		ChunkSlots[Chunks[SlotIndex].Chunk] = INDEX_NONE;
 	}
 
+	FChunk& Slot = Chunks[SlotIndex];
+	Slot.Chunk = Chunk;
+	Slot.LastUse = ++UseClock;
+	ChunkSlots[Chunk] = SlotIndex;
+	return SlotIndex;
+}
+
+const FClimateData* UStochasticWeatherDataProvider::FindHour(int32 Hour) const
+{
+	const int32 Chunk = Hour / ChunkSize;
+	AdoptPrefetch(/*bWait=*/PrefetchChunk == Chunk);
+
+	int32 SlotIndex = ChunkSlots[Chunk];
+	if (SlotIndex == INDEX_NONE)
+	{
+		SlotIndex = AcquireChunkSlot(Chunk);
+		FChunk& Slot = Chunks[SlotIndex];
+		Slot.Data.SetNumUninitialized(ChunkSize * Resolution * Resolution, EAllowShrinking::No);
+		GenerateChunk(Chunk, Slot.Data.GetData());
+	}
+
+	FChunk& Slot = Chunks[SlotIndex];
+	Slot.LastUse = ++UseClock;
+
+	// Readers walk the timeline forward, have the next chunk ready before they get there
+	const int32 HourInChunk = Hour - Chunk * ChunkSize;
+	if (HourInChunk >= ChunkSize - ChunkSize / 4)
+	{
+		Prefetch(Chunk + 1);
+	}
+	return Slot.Data.GetData() + HourInChunk * Resolution * Resolution;
+}
+
+void UStochasticWeatherDataProvider::Prefetch(int32 Chunk) const
+{
+	// A single cached chunk would be evicted by the chunk prefetched after it
+	if (MaxCachedChunks < 2 || !ChunkSlots.IsValidIndex(Chunk) || ChunkSlots[Chunk] != INDEX_NONE || PrefetchChunk != INDEX_NONE)
+	{
+		return;
+	}
+
+	PrefetchChunk = Chunk;
+	PrefetchData.SetNumUninitialized(ChunkSize * Resolution * Resolution, EAllowShrinking::No);
+	PrefetchTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, Chunk, OutStations = PrefetchData.GetData()]()
+	{
+		GenerateChunk(Chunk, OutStations);
+	});
+}
+
+void UStochasticWeatherDataProvider::AdoptPrefetch(bool bWait) const
+{
+	if (PrefetchChunk == INDEX_NONE || (!bWait && !PrefetchTask.IsCompleted()))
+	{
+		return;
+	}
+
+	PrefetchTask.Wait();
+	FChunk& Slot = Chunks[AcquireChunkSlot(PrefetchChunk)];
+
+	// The evicted chunk's buffer becomes the next prefetch buffer
+	Swap(Slot.Data, PrefetchData);
+	PrefetchChunk = INDEX_NONE;
+	PrefetchTask = {};
+}
+
+void UStochasticWeatherDataProvider::CancelPrefetch()
+{
+	FScopeLock Lock(&CacheLock);
+	if (PrefetchTask.IsValid())
+	{
+		PrefetchTask.Wait();
+		PrefetchTask = {};
+	}
+	PrefetchChunk = INDEX_NONE;
+}
+
+void UStochasticWeatherDataProvider::BeginDestroy()
+{
+	CancelPrefetch();
+	Super::BeginDestroy();
+}
+
+FClimateData UStochasticWeatherDataProvider::ReadClimateStep(int32 Step, int32 Station) const
+{
+	if (Step < 0 || Step >= TotalHours || Station < 0 || Station >= Resolution * Resolution)
+	{
+		return FClimateData();
+	}
+
+	// Copied under the lock, the chunk may be evicted by the next read
+	FScopeLock Lock(&CacheLock);
+	return FindHour(Step)[Station];
+}
+
+TResourceArray<FClimateData>* UStochasticWeatherDataProvider::CreateRawClimateDataResourceArray(FDateTime StartTime, FDateTime EndTime)
+{
+	auto TimeSpan = EndTime - StartTime;
+	const int32 TotalHoursLocal = FMath::Clamp(static_cast<int32>(TimeSpan.GetTotalHours()), 0, TotalHours);
+	const int32 NumStations = Resolution * Resolution;
+
+	// Chunks are generated straight into the array, bypassing the chunk cache
+	TResourceArray<FClimateData>* ClimateResourceArray = new TResourceArray<FClimateData>();
+	const int32 NumChunks = FMath::DivideAndRoundUp(TotalHoursLocal, ChunkSize);
+	ClimateResourceArray->SetNumUninitialized(NumChunks * ChunkSize * NumStations);
+	for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+	{
+		GenerateChunk(Chunk, ClimateResourceArray->GetData() + Chunk * ChunkSize * NumStations);
+	}
+	ClimateResourceArray->SetNum(TotalHoursLocal * NumStations);
+
 	return ClimateResourceArray;
 }
 
 FWeatherForcingData UStochasticWeatherDataProvider::GetWeatherForcing(FDateTime Time, int32 GridX, int32 GridY)
 {
-	if (TotalHours <= 0 || Resolution <= 0 || ClimateData.empty())
+	if (TotalHours <= 0 || Resolution <= 0 || ChunkStartStates.Num() == 0)
 	{
 		return FWeatherForcingData();
 	}
 
-	int32 HourIndex = static_cast<int32>((Time - StartTimeRef).GetTotalHours());
-	HourIndex = FMath::Clamp(HourIndex, 0, TotalHours - 1);
+	const int32 HourIndex = GetHourIndex(Time);
 
 	// Wrap grid indices into [0, Resolution)
 	const int32 X = (Resolution > 0) ? (GridX % Resolution + Resolution) % Resolution : 0;
 	const int32 Y = (Resolution > 0) ? (GridY % Resolution + Resolution) % Resolution : 0;
 	const int32 StationIndex = X + Y * Resolution;
 
-	const FClimateData& C = ClimateData[HourIndex][StationIndex];
+	FClimateData C;
+	{
+		FScopeLock Lock(&CacheLock);
+		C = FindHour(HourIndex)[StationIndex];
+	}
 
 	// Convert to forcing units: Temp K, precip kg/m²/s
 	const float TempK = C.Temperature + 273.15f;
@@ -144,3 +307,86 @@ FWeatherForcingData UStochasticWeatherDataProvider::GetWeatherForcing(FDateTime
 	return FWeatherForcingData(Time, TempK, SWdown_Wm2, LWdown_Wm2, Wind_mps, RH_01, Precip_kgm2s, SnowFrac);
 }
 
+
+TSharedPtr<const UStochasticWeatherDataProvider::FForcingFieldHour> UStochasticWeatherDataProvider::ConvertHour(int32 Hour) const
+{
+	const int32 NumStations = Resolution * Resolution;
+	TSharedPtr<FForcingFieldHour> Converted = MakeShared<FForcingFieldHour>();
+	Converted->Hour = Hour;
+	Converted->TemperatureK.SetNumUninitialized(NumStations);
+	Converted->PrecipRate.SetNumUninitialized(NumStations);
+	Converted->SnowFrac.SetNumUninitialized(NumStations);
+
+	// Converted under the lock, the chunk may be evicted once it is released
+	FScopeLock Lock(&CacheLock);
+	const FClimateData* Stations = FindHour(Hour);
+	for (int32 Station = 0; Station < NumStations; ++Station)
+	{
+		Converted->TemperatureK[Station] = Stations[Station].Temperature + 273.15f;
+		Converted->PrecipRate[Station] = Stations[Station].Precipitation / 3600.0f; // mm/h ⇒ kg/m²/s
+		Converted->SnowFrac[Station] = (Stations[Station].Temperature <= 0.0f) ? 1.0f : 0.0f;
+	}
+	return Converted;
+}
+
+void UStochasticWeatherDataProvider::PrepareForcingField(FDateTime Time)
+{
+	if (TotalHours <= 0 || Resolution <= 0 || ChunkStartStates.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 Hour = GetHourIndex(Time);
+	if (!PreparedHour.IsValid() || PreparedHour->Hour != Hour)
+	{
+		PreparedHour = ConvertHour(Hour);
+	}
+}
+
+void UStochasticWeatherDataProvider::FillForcingField(FDateTime Time, const FIntRect& Rect, const FWeatherForcingField& OutField)
+{
+	const int32 Width = FMath::Max(0, Rect.Width());
+	const int32 Height = FMath::Max(0, Rect.Height());
+	if (Width == 0 || Height == 0)
+	{
+		return;
+	}
+	if (TotalHours <= 0 || Resolution <= 0 || ChunkStartStates.Num() == 0)
+	{
+		Super::FillForcingField(Time, Rect, OutField);
+		return;
+	}
+
+	// Tiles of a prepared hour share its conversion, callers that did not prepare it pay for their own
+	const int32 HourIndex = GetHourIndex(Time);
+	TSharedPtr<const FForcingFieldHour> Hour = PreparedHour;
+	if (!Hour.IsValid() || Hour->Hour != HourIndex)
+	{
+		Hour = ConvertHour(HourIndex);
+	}
+
+	// Rows of the rect wrap into the station grid, walk the station column without a modulo per cell
+	const int32 FirstX = (Rect.Min.X % Resolution + Resolution) % Resolution;
+	auto FillColumn = [&](float* Column, const float* StationValues)
+	{
+		if (!Column)
+		{
+			return;
+		}
+		for (int32 Row = 0; Row < Height; ++Row)
+		{
+			const int32 Y = ((Rect.Min.Y + Row) % Resolution + Resolution) % Resolution;
+			const float* StationRow = StationValues + Y * Resolution;
+			float* Out = Column + Row * Width;
+			int32 X = FirstX;
+			for (int32 i = 0; i < Width; ++i)
+			{
+				Out[i] = StationRow[X];
+				X = (X + 1 == Resolution) ? 0 : X + 1;
+			}
+		}
+	};
+	FillColumn(OutField.Temperature_K, Hour->TemperatureK.GetData());
+	FillColumn(OutField.PrecipRate_kgm2s, Hour->PrecipRate.GetData());
+	FillColumn(OutField.SnowFrac_01, Hour->SnowFrac.GetData());
+}
@@ -1,8 +1,9 @@
 #pragma once
 
 #include "SimulationWeatherDataProviderBase.h"
-#include <vector>
 #include "ClimateData.h"
+#include "HAL/CriticalSection.h"
+#include "Tasks/Task.h"
 #include "StochasticWeatherDataProvider.generated.h"
 
 /** State of the simulation. */
@@ -16,6 +17,15 @@ enum class WeatherState : int8
 * change transition probabilities during the day or during seasons. Temperature follows a simple sinusoidal pattern 
 * and precipitation amount follows an exponential distribution. To account for spatial variation noise is applied
 * to the precipitation. The temperature and the precipitation are not correlated.
+*
+* All random draws come from FSnowRandom generators keyed by Seed, the hour and the station, so the weather is
+* reproducible and independent of the global random state. Only the Markov chain is walked sequentially, the hours are
+* then generated in parallel with one precipitation noise field per wet hour.
+*
+* Initialize only walks the Markov chain. Hours are generated on first read in chunks of ChunkHours into flat arrays,
+* of which the MaxCachedChunks most recently read ones are kept, so memory does not grow with the season length. Once
+* the reads enter the last quarter of a chunk, the next chunk is generated on a worker task, so sequential readers do
+* not wait for it.
 */
 UCLASS(Blueprintable, BlueprintType)
 class SIMULATIONDATA_API UStochasticWeatherDataProvider : public USimulationWeatherDataProviderBase
@@ -25,8 +35,7 @@ class SIMULATIONDATA_API UStochasticWeatherDataProvider : public USimulationWeat
 private:
 	/** State of the simulation. */
 	WeatherState State;
-	
-	std::vector<std::vector<FClimateData>> ClimateData;
+
 public:
 	// @TODO fix probabilities
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input", DisplayName = "P_I_W")
@@ -45,16 +54,130 @@ public:
 	/** Number of measuring stations per dimension. */
 	int32 Resolution = 10;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input")
+	/** Seed of the weather, every run with the same seed and inputs generates the same weather. */
+	int32 Seed = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Performance", meta=(ClampMin="1"))
+	/** Number of hours generated together when one of them is first read. */
+	int32 ChunkHours = 168;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Performance", meta=(ClampMin="1"))
+	/** Number of generated chunks kept in memory, the least recently read one is dropped first. */
+	int32 MaxCachedChunks = 4;
+
 	UStochasticWeatherDataProvider();
 
 	virtual TResourceArray<FClimateData>* CreateRawClimateDataResourceArray(FDateTime StartTime, FDateTime EndTime) override final;
 
 	virtual void Initialize(FDateTime StartTime, FDateTime EndTime) override final;
 
+	/** One station per cell of the Resolution x Resolution grid. */
+	virtual int32 GetNumClimateStations() const override { return Resolution * Resolution; }
+
 	/** Return weather forcing for a given time and optional grid coord */
 	virtual FWeatherForcingData GetWeatherForcing(FDateTime Time, int32 GridX = 0, int32 GridY = 0) override;
 
+	/** Every station has its own weather. */
+	virtual bool HasSpatialForcing() const override { return true; }
+
+	/**
+	* Tiles the stations of the hour prepared by PrepareForcingField over Rect without locking, grid coordinates wrap
+	* like in GetWeatherForcing. Converts the hour itself if it was not prepared.
+	*/
+	virtual void FillForcingField(FDateTime Time, const FIntRect& Rect, const FWeatherForcingField& OutField) override;
+
+	/** Converts the stations of the hour of Time to forcing units once, shared by every FillForcingField of the hour. */
+	virtual void PrepareForcingField(FDateTime Time) override;
+
+	virtual void BeginDestroy() override;
+
+protected:
+	virtual FClimateData ReadClimateStep(int32 Step, int32 Station) const override;
+
 private:
+	/** Generated hours of one chunk, [Hour * NumStations + Station]. */
+	struct FChunk
+	{
+		int32 Chunk = INDEX_NONE;
+		uint64 LastUse = 0;
+		TArray<FClimateData> Data;
+	};
+
+	/** Stations of one hour in forcing units, immutable once built so workers read it without locking. */
+	struct FForcingFieldHour
+	{
+		int32 Hour = INDEX_NONE;
+
+		/** Temperature (K), precipitation (kg/m²/s) and snow fraction columns, NumStations values each. */
+		TArray<float> TemperatureK;
+		TArray<float> PrecipRate;
+		TArray<float> SnowFrac;
+	};
+
+	/** Converts the stations of Hour to forcing units, reading them under CacheLock. */
+	TSharedPtr<const FForcingFieldHour> ConvertHour(int32 Hour) const;
+
+	/** Generates the hours of Chunk into OutStations (ChunkSize * NumStations entries). */
+	void GenerateChunk(int32 Chunk, FClimateData* OutStations) const;
+
+	/**
+	* Returns the stations of Hour, generating its chunk if it is not cached. Callers hold CacheLock and copy what they
+	* need before releasing it, the chunk may be evicted afterwards.
+	*/
+	const FClimateData* FindHour(int32 Hour) const;
+
+	/** Returns the cache slot Chunk is stored in, evicting the least recently read chunk if the cache is full. Callers hold CacheLock. */
+	int32 AcquireChunkSlot(int32 Chunk) const;
+
+	/** Starts generating Chunk on a worker task unless it is cached or a prefetch is running. Callers hold CacheLock. */
+	void Prefetch(int32 Chunk) const;
+
+	/** Moves a finished (or, with bWait, the running) prefetch into the cache. Callers hold CacheLock. */
+	void AdoptPrefetch(bool bWait) const;
+
+	/** Waits for a running prefetch and drops it. */
+	void CancelPrefetch();
+
+	/** Hour of the timeline containing Time, clamped to the timeline. */
+	int32 GetHourIndex(const FDateTime& Time) const
+	{
+		return FMath::Clamp(static_cast<int32>((Time - StartTimeRef).GetTotalHours()), 0, TotalHours - 1);
+	}
+
+	/** Draws the state following Current at the end of Hour. */
+	WeatherState NextState(WeatherState Current, int32 Hour) const;
+
+	/**
+	* Generates all stations of Hour into OutStations (Resolution * Resolution entries). Depends only on the inputs and
+	* the seed, so hours can be generated on any thread in any order.
+	*/
+	void GenerateHour(int32 Hour, WeatherState HourState, const FDateTime& Time, FClimateData* OutStations) const;
+
+	/** Temperature offset of every station, constant over the run. */
+	TArray<float> TemperatureNoise;
+
+	/** Markov state at the first hour of every chunk. */
+	TArray<WeatherState> ChunkStartStates;
+	int32 ChunkSize = 1;
+
+	/** Cached chunks and the cache slot of every chunk (INDEX_NONE if not cached). */
+	mutable TArray<FChunk> Chunks;
+	mutable TArray<int32> ChunkSlots;
+	mutable uint64 UseClock = 0;
+	mutable FCriticalSection CacheLock;
+
+	/**
+	* Chunk generated by PrefetchTask into PrefetchData, INDEX_NONE if none is in flight. The task only reads the
+	* generator inputs and writes PrefetchData, it never takes CacheLock, so readers may wait for it under the lock.
+	*/
+	mutable int32 PrefetchChunk = INDEX_NONE;
+	mutable TArray<FClimateData> PrefetchData;
+	mutable UE::Tasks::FTask PrefetchTask;
+
+	/** Hour converted by the last PrepareForcingField, only replaced while no FillForcingField runs. */
+	TSharedPtr<const FForcingFieldHour> PreparedHour;
+
 	FDateTime StartTimeRef;
 	int32 TotalHours = 0;
 };
\ No newline at end of file
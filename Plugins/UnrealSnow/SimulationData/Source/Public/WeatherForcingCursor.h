@@ -0,0 +1,173 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ClimateData.h"
+
+/**
+* Position in a time sorted forcing series, for callers that query increasing times as the simulation does. A seek
+* walks forward from the records of the previous query, which is O(1) amortized over a run; seeks backwards or far
+* ahead fall back to a binary search. The interpolated record of the last query is kept, so asking again for the same
+* time costs a compare.
+*
+* Times are ticks, or step indices of a fixed step length set with SetSteps, so callers stepping through the series
+* need no FDateTime arithmetic. The series is accessed through callables, the cursor does not own it.
+*/
+struct FWeatherForcingCursor
+{
+	/** Forgets the position and the kept record, call when the series changes. */
+	void Reset()
+	{
+		Index = 0;
+		SampledTicks = MIN_int64;
+		SampledNum = 0;
+	}
+
+	/** Step Step is at Origin + Step * StepLength. Must be called before the step API (GetStepTicks, SampleStep) is used. */
+	void SetSteps(FDateTime Origin, FTimespan StepLength)
+	{
+		OriginTicks = Origin.GetTicks();
+		StepTicks = StepLength.GetTicks();
+		bHasSteps = true;
+	}
+
+	FORCEINLINE bool HasSteps() const { return bHasSteps; }
+
+	FORCEINLINE int64 GetStepTicks(int64 Step) const
+	{
+		checkf(bHasSteps, TEXT("FWeatherForcingCursor: SetSteps must be called before steps are used"));
+		return OriginTicks + Step * StepTicks;
+	}
+
+	/** Record at or before the last seek time, the first record for times before the series. */
+	FORCEINLINE int32 GetIndex() const { return Index; }
+
+	/**
+	* Moves to the records bracketing Ticks and returns the weight of the record after GetIndex(), 0 before the first
+	* and after the last record.
+	*
+	* @param TicksOf	returns the time of record i in ticks
+	*/
+	template <typename TicksOfType>
+	float Seek(int64 Ticks, int32 Num, TicksOfType&& TicksOf)
+	{
+		if (Num <= 0)
+		{
+			Index = 0;
+			return 0.0f;
+		}
+
+		Index = FMath::Clamp(Index, 0, Num - 1);
+		if (Ticks < TicksOf(Index))
+		{
+			Index = FMath::Max(0, LastAtOrBefore(0, Index, Ticks, TicksOf));
+		}
+		else
+		{
+			// Consecutive queries usually move by a record or two, walk a few before searching
+			int32 Walked = 0;
+			while (Index + 1 < Num && TicksOf(Index + 1) <= Ticks)
+			{
+				if (++Walked > MaxWalk)
+				{
+					Index = LastAtOrBefore(Index + 1, Num, Ticks, TicksOf);
+					break;
+				}
+				++Index;
+			}
+		}
+
+		const int64 Ticks0 = TicksOf(Index);
+		if (Ticks <= Ticks0 || Index + 1 >= Num)
+		{
+			return 0.0f;
+		}
+		const int64 Ticks1 = TicksOf(Index + 1);
+		return Ticks1 > Ticks0 ? static_cast<float>(static_cast<double>(Ticks - Ticks0) / static_cast<double>(Ticks1 - Ticks0)) : 0.0f;
+	}
+
+	/**
+	* The record at Ticks interpolated between its bracketing records.
+	*
+	* @param TicksOf	returns the time of record i in ticks
+	* @param RecordOf	returns record i
+	*/
+	template <typename TicksOfType, typename RecordOfType>
+	const FWeatherForcingData& Sample(int64 Ticks, int32 Num, TicksOfType&& TicksOf, RecordOfType&& RecordOf)
+	{
+		if (Ticks != SampledTicks || Num != SampledNum)
+		{
+			const float Alpha = Seek(Ticks, Num, TicksOf);
+			if (Num <= 0)
+			{
+				Sampled = FWeatherForcingData();
+			}
+			else if (Alpha > 0.0f)
+			{
+				Sampled = Interpolate(RecordOf(Index), RecordOf(Index + 1), Alpha);
+				Sampled.Timestamp = FDateTime(Ticks);
+			}
+			else
+			{
+				Sampled = RecordOf(Index);
+			}
+			SampledTicks = Ticks;
+			SampledNum = Num;
+		}
+		return Sampled;
+	}
+
+	/** Sample at a step index set by SetSteps. */
+	template <typename TicksOfType, typename RecordOfType>
+	FORCEINLINE const FWeatherForcingData& SampleStep(int64 Step, int32 Num, TicksOfType&& TicksOf, RecordOfType&& RecordOf)
+	{
+		return Sample(GetStepTicks(Step), Num, TicksOf, RecordOf);
+	}
+
+	static FWeatherForcingData Interpolate(const FWeatherForcingData& A, const FWeatherForcingData& B, float Alpha)
+	{
+		return FWeatherForcingData(
+			A.Timestamp + (B.Timestamp - A.Timestamp) * Alpha,
+			FMath::Lerp(A.Temperature_K, B.Temperature_K, Alpha),
+			FMath::Lerp(A.SWdown_Wm2, B.SWdown_Wm2, Alpha),
+			FMath::Lerp(A.LWdown_Wm2, B.LWdown_Wm2, Alpha),
+			FMath::Lerp(A.Wind_mps, B.Wind_mps, Alpha),
+			FMath::Lerp(A.RH_01, B.RH_01, Alpha),
+			FMath::Lerp(A.PrecipRate_kgm2s, B.PrecipRate_kgm2s, Alpha),
+			FMath::Lerp(A.SnowFrac_01, B.SnowFrac_01, Alpha)
+		);
+	}
+
+private:
+	/** Records walked forward before a seek switches to a binary search. */
+	static constexpr int32 MaxWalk = 8;
+
+	/** Last record in [Lo, Hi) at or before Ticks, Lo - 1 if there is none. */
+	template <typename TicksOfType>
+	static int32 LastAtOrBefore(int32 Lo, int32 Hi, int64 Ticks, TicksOfType& TicksOf)
+	{
+		while (Lo < Hi)
+		{
+			const int32 Mid = Lo + (Hi - Lo) / 2;
+			if (TicksOf(Mid) <= Ticks)
+			{
+				Lo = Mid + 1;
+			}
+			else
+			{
+				Hi = Mid;
+			}
+		}
+		return Lo - 1;
+	}
+
+	int32 Index = 0;
+
+	int64 OriginTicks = 0;
+	int64 StepTicks = ETimespan::TicksPerHour;
+	bool bHasSteps = false;
+
+	/** Interpolated record of the last Sample and what it was sampled for. */
+	FWeatherForcingData Sampled;
+	int64 SampledTicks = MIN_int64;
+	int32 SampledNum = 0;
+};
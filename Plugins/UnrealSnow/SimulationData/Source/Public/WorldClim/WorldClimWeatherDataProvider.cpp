@@ -1,7 +1,8 @@
 #include "WorldClimWeatherDataProvider.h"
 #include "SimulationData.h"
-#include "Misc/FileHelper.h"
+#include "WeatherCsvParser.h"
 #include "Misc/DateTime.h"
+#include "SnowStats.h"
 
 TResourceArray<FClimateData>* UWorldClimWeatherDataProvider::CreateRawClimateDataResourceArray(FDateTime StartTime, FDateTime EndTime)
 {
@@ -23,7 +24,10 @@ TResourceArray<FClimateData>* UWorldClimWeatherDataProvider::CreateRawClimateDat
 
 void UWorldClimWeatherDataProvider::Initialize(FDateTime StartTime, FDateTime EndTime)
 {
+	SNOW_SCOPE(ProviderInitialize);
+
 	HourlySeries.Reset();
+	SeriesCursor.Reset();
 	SeriesStart = StartTime;
 	SeriesHours = static_cast<int32>((EndTime - StartTime).GetTotalHours());
 	bUseCsv = false;
@@ -35,6 +39,7 @@ void UWorldClimWeatherDataProvider::Initialize(FDateTime StartTime, FDateTime En
 		{
 			bUseCsv = true;
 			UE_LOG(LogTemp, Display, TEXT("[Weather] WorldClim using CSV override: %s (%d records)"), *CsvFilePath.FilePath, HourlySeries.Num());
+			BuildClimateTimeline(StartTime, EndTime);
 			return;
 		}
 		UE_LOG(LogTemp, Warning, TEXT("[Weather] WorldClim CSV override failed to load: %s"), *CsvFilePath.FilePath);
@@ -44,47 +49,21 @@ void UWorldClimWeatherDataProvider::Initialize(FDateTime StartTime, FDateTime En
 	if (MonthlyData.Num() == 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("[Weather] WorldClim MonthlyData is empty; provider will return defaults."));
+		BuildClimateTimeline(StartTime, EndTime);
 		return;
 	}
 
 	UE_LOG(LogTemp, Display, TEXT("[Weather] WorldClim provider initialized with %d monthly assets"), MonthlyData.Num());
+	BuildClimateTimeline(StartTime, EndTime);
 }
 
 bool UWorldClimWeatherDataProvider::LoadCsvOverride()
 {
-	FString FileContent;
-	if (!FFileHelper::LoadFileToString(FileContent, *CsvFilePath.FilePath))
+	// Same format as UCsvWeatherProvider
+	if (!FWeatherCsvParser::ParseFile(CsvFilePath.FilePath, HourlySeries))
 	{
 		return false;
 	}
-	TArray<FString> Lines;
-	FileContent.ParseIntoArray(Lines, TEXT("\n"), true);
-	if (Lines.Num() < 2)
-	{
-		return false;
-	}
-	// Parse records (reuse CsvWeatherProvider format)
-	HourlySeries.Reset();
-	for (int32 i = 1; i < Lines.Num(); ++i)
-	{
-		TArray<FString> Columns;
-		Lines[i].ParseIntoArray(Columns, TEXT(","), true);
-		if (Columns.Num() < 8) { continue; }
-		FDateTime Timestamp;
-		if (!FDateTime::ParseIso8601(*Columns[0], Timestamp)) { continue; }
-		float TempC = FCString::Atof(*Columns[1]);
-		float RH_pct = FCString::Atof(*Columns[2]);
-		float Wind_mps = FCString::Atof(*Columns[3]);
-		float SWdown_Wm2 = FCString::Atof(*Columns[4]);
-		float LWdown_Wm2 = FCString::Atof(*Columns[5]);
-		float Precip_mmph = FCString::Atof(*Columns[6]);
-		float SnowFrac = FCString::Atof(*Columns[7]);
-		float TempK = TempC + 273.15f;
-		float RH_01 = FMath::Clamp(RH_pct / 100.0f, 0.0f, 1.0f);
-		float Precip_kgm2s = Precip_mmph / 3600.0f; // 1 mm == 1 kg/m²
-		HourlySeries.Add(FWeatherForcingData(Timestamp, TempK, SWdown_Wm2, LWdown_Wm2, Wind_mps, RH_01, Precip_kgm2s, SnowFrac));
-	}
-	HourlySeries.Sort([](const FWeatherForcingData& A, const FWeatherForcingData& B){ return A.Timestamp < B.Timestamp; });
 	SeriesStart = (HourlySeries.Num() > 0) ? HourlySeries[0].Timestamp : SeriesStart;
 	SeriesHours = HourlySeries.Num();
 	return HourlySeries.Num() > 0;
@@ -140,16 +119,11 @@ FWeatherForcingData UWorldClimWeatherDataProvider::GetWeatherForcing(FDateTime T
 {
 	if (bUseCsv && HourlySeries.Num() > 0)
 	{
-		// Use closest record
-		// Binary search
-		int32 L=0, R=HourlySeries.Num()-1, Best=0;
-		while (L<=R)
-		{
-			int32 M = (L+R)/2;
-			if (HourlySeries[M].Timestamp < Time) { Best=M; L=M+1; }
-			else { R=M-1; }
-		}
-		return HourlySeries[FMath::Clamp(Best, 0, HourlySeries.Num()-1)];
+		// Use the record at or before Time, worker threads seek with their own cursor
+		FWeatherForcingCursor LocalCursor;
+		FWeatherForcingCursor& Cursor = IsInGameThread() ? SeriesCursor : LocalCursor;
+		Cursor.Seek(Time.GetTicks(), HourlySeries.Num(), [this](int32 Index) { return HourlySeries[Index].Timestamp.GetTicks(); });
+		return HourlySeries[Cursor.GetIndex()];
 	}
 	return SampleMonthlyToHourly(Time);
 }
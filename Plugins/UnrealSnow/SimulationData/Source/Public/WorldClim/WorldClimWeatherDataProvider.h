@@ -2,6 +2,7 @@
 
 #include "WorldClimDataAssets.h"
 #include "SimulationWeatherDataProviderBase.h"
+#include "WeatherForcingCursor.h"
 #include "Engine/EngineTypes.h"
 #include "WorldClimWeatherDataProvider.generated.h"
 
@@ -50,6 +51,9 @@ private:
 	int32 SeriesHours = 0;
 	bool bUseCsv = false;
 
+	// Position in HourlySeries of GetWeatherForcing on the game thread
+	FWeatherForcingCursor SeriesCursor;
+
 	bool LoadCsvOverride();
 	FWeatherForcingData SampleMonthlyToHourly(FDateTime Time) const;
 };